@@ -5,121 +5,77 @@
 local Events = {}
 
 -- Private variables (not exposed outside this module)
-local eventHandlers = {}  -- Table to store event handlers
-local timers = {}         -- Table to store timer information
-local nextTimerID = 1     -- For generating unique timer IDs
+local handlerHandles = {}  -- eventName -> { [handlerFn] = { native handles } }
 
 -- ===============================================
 -- Core event system functions
 -- ===============================================
 
+-- Handlers live in the native event bus; dispatch, error isolation and removal all happen in C++
+
 -- Register an event handler
 function Events.register(eventName, handlerFn)
-    if not eventHandlers[eventName] then
-        eventHandlers[eventName] = {}
+    local handle = RegisterEvent(eventName, handlerFn)
+
+    local handles = handlerHandles[eventName]
+    if not handles then
+        handles = {}
+        handlerHandles[eventName] = handles
     end
-    
-    table.insert(eventHandlers[eventName], handlerFn)
+    local registrations = handles[handlerFn]
+    if not registrations then
+        registrations = {}
+        handles[handlerFn] = registrations
+    end
+    registrations[#registrations + 1] = handle
+
     Log("Registered handler for event: " .. eventName)
     return handlerFn  -- Return the handler to allow unregistering later
 end
 
 -- Unregister an event handler
 function Events.unregister(eventName, handlerFn)
-    if not eventHandlers[eventName] then
+    local handles = handlerHandles[eventName]
+    local registrations = handles and handles[handlerFn]
+    if not registrations then
         return false
     end
-    
-    for i, handler in ipairs(eventHandlers[eventName]) do
-        if handler == handlerFn then
-            table.remove(eventHandlers[eventName], i)
-            Log("Unregistered handler for event: " .. eventName)
-            return true
-        end
+
+    local handle = registrations[#registrations]
+    registrations[#registrations] = nil
+    if #registrations == 0 then
+        handles[handlerFn] = nil
     end
-    
-    return false
+
+    UnregisterEvent(handle)
+    Log("Unregistered handler for event: " .. eventName)
+    return true
 end
 
 -- Trigger an event
 function Events.trigger(eventName, ...)
-    if not eventHandlers[eventName] then
-        return false
-    end
-    
-    local handlers = eventHandlers[eventName]
-    for _, handler in ipairs(handlers) do
-        local success, error = pcall(handler, ...)
-        if not success then
-            Log("Error in event handler for " .. eventName .. ": " .. tostring(error))
-        end
-    end
-    
-    return true
+    return TriggerEvent(eventName, ...)
 end
 
 -- ===============================================
 -- Timer functionality
 -- ===============================================
 
+-- Timers live in a native timing wheel, so pending timers cost nothing until they are due
+
 -- Create a one-time timer (setTimeout equivalent)
 function Events.setTimeout(callback, seconds)
-    local id = nextTimerID
-    nextTimerID = nextTimerID + 1
-    
-    timers[id] = {
-        callback = callback,
-        timeLeft = seconds,
-        repeating = false
-    }
-    
-    return id
+    return SetTimeout(callback, seconds)
 end
 
 -- Create a repeating timer (setInterval equivalent)
 function Events.setInterval(callback, seconds)
-    local id = nextTimerID
-    nextTimerID = nextTimerID + 1
-    
-    timers[id] = {
-        callback = callback,
-        timeLeft = seconds,
-        repeating = true,
-        interval = seconds
-    }
-    
-    return id
+    return SetInterval(callback, seconds)
 end
 
 -- Clear a timer
 function Events.clearTimer(id)
-    if timers[id] then
-        timers[id] = nil
-        return true
-    end
-    return false
-end
-
--- Update timers (call this each frame)
-local function updateTimers(deltaTime)
-    for id, timer in pairs(timers) do
-        timer.timeLeft = timer.timeLeft - deltaTime
-        
-        if timer.timeLeft <= 0 then
-            -- Call the callback
-            local success, error = pcall(timer.callback)
-            if not success then
-                Log("Error in timer callback: " .. tostring(error))
-            end
-            
-            -- Handle repeating timers
-            if timer.repeating then
-                timer.timeLeft = timer.interval
-            else
-                timers[id] = nil
-            end
-        end
-    end
+    return ClearTimer(id)
 end
 
 -- ===============================================
@@ -128,9 +84,6 @@ end
 
 -- Native event handler for OnUpdate (frame update)
 local function onUpdateHandler(deltaTime)
-    -- Update timers
-    updateTimers(deltaTime)
-    
     -- Trigger onUpdate event for any scripts that want it
     Events.trigger("onUpdate", deltaTime)
 end
@@ -113,6 +113,11 @@ Events.register("onGameLoad", function()
         end
     end
     
+    -- Handles are cached per form, so the player's handle compares equal however it was obtained
+    if GetPlayer() ~= GetActor(0x14) then
+        Log("GetPlayer() does not match the player's handle; onEquip will not recognize the player")
+    end
+
     -- Track example NPC
     if config.exampleNPC then
         trackActor(config.exampleNPC)
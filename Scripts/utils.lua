@@ -10,6 +10,10 @@ local Utils = {}
 
 -- Format a form ID as a standard hex string (8 digits with leading zeros)
 function Utils.formatFormID(formID)
+    -- Accept Form handles as well as plain FormIDs
+    if type(formID) == "userdata" then
+        formID = formID:GetFormID()
+    end
     return string.format("%08X", formID or 0)
 end
 
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <RE/Skyrim.h>
+
+#include <span>
+#include <string_view>
+
+namespace Sample {
+    struct ActorValueName {
+        std::string_view name;
+        RE::ActorValue value;
+    };
+
+    /**
+     * Resolve an actor value name, ignoring case.
+     *
+     * <p>
+     * Common names and aliases are looked up in a hash table built at compile time. Anything else falls back to the
+     * game's <code>ActorValueList</code>, which scans every actor value.
+     * </p>
+     *
+     * @return The actor value, or <code>RE::ActorValue::kNone</code> if the name is unknown.
+     */
+    [[nodiscard]] RE::ActorValue LookupActorValue(std::string_view name) noexcept;
+
+    /**
+     * The names in the compile-time table, for exporting as constants.
+     */
+    [[nodiscard]] std::span<const ActorValueName> GetActorValueNames() noexcept;
+}
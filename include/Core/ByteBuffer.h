@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace Sample {
+    /**
+     * Appends fixed-size values and LEB128 varints to a growable byte buffer.
+     *
+     * <p>
+     * Cosave records are built in one of these and handed to <code>WriteRecordData</code> in a single call, instead
+     * of one call per field. Fixed-size values are stored in native (little-endian) order.
+     * </p>
+     */
+    class ByteWriter {
+    public:
+        void Reserve(std::size_t bytes) { _bytes.reserve(bytes); }
+
+        template <class T>
+        void Write(const T& value) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            const auto at = _bytes.size();
+            _bytes.resize(at + sizeof(T));
+            std::memcpy(_bytes.data() + at, &value, sizeof(T));
+        }
+
+        void WriteBytes(const void* data, std::size_t size) {
+            const auto at = _bytes.size();
+            _bytes.resize(at + size);
+            std::memcpy(_bytes.data() + at, data, size);
+        }
+
+        void WriteVarUInt(std::uint64_t value);
+
+        /**
+         * Write a signed value zigzag-encoded, so small negative numbers stay short.
+         */
+        void WriteVarInt(std::int64_t value);
+
+        [[nodiscard]] const std::byte* Data() const noexcept { return _bytes.data(); }
+        [[nodiscard]] std::size_t Size() const noexcept { return _bytes.size(); }
+
+        // Drops the contents but keeps the capacity
+        void Clear() noexcept { _bytes.clear(); }
+
+    private:
+        std::vector<std::byte> _bytes;
+    };
+
+    /**
+     * Reads values written by a <code>ByteWriter</code> from a byte span.
+     *
+     * <p>
+     * Every read checks the remaining length and returns false instead of running past the end, so a truncated or
+     * corrupt record fails to parse rather than reading garbage.
+     * </p>
+     */
+    class ByteReader {
+    public:
+        explicit ByteReader(std::span<const std::byte> bytes) noexcept : _bytes(bytes) {}
+
+        template <class T>
+        bool Read(T& value) noexcept {
+            static_assert(std::is_trivially_copyable_v<T>);
+            if (Remaining() < sizeof(T)) {
+                return false;
+            }
+            std::memcpy(&value, _bytes.data() + _offset, sizeof(T));
+            _offset += sizeof(T);
+            return true;
+        }
+
+        /**
+         * Point <code>bytes</code> at the next <code>size</code> bytes of the buffer, without copying them.
+         */
+        bool ReadBytes(std::size_t size, std::span<const std::byte>& bytes) noexcept {
+            if (Remaining() < size) {
+                return false;
+            }
+            bytes = _bytes.subspan(_offset, size);
+            _offset += size;
+            return true;
+        }
+
+        bool ReadVarUInt(std::uint64_t& value) noexcept;
+        bool ReadVarInt(std::int64_t& value) noexcept;
+
+        [[nodiscard]] std::size_t Remaining() const noexcept { return _bytes.size() - _offset; }
+
+    private:
+        std::span<const std::byte> _bytes;
+        std::size_t _offset = 0;
+    };
+}
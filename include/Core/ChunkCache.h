@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+struct lua_State;
+
+namespace Sample {
+    /**
+     * LRU cache of compiled Lua snippets, behind <code>ExecuteString</code>.
+     *
+     * <p>
+     * Each snippet is compiled once and its function kept in the Lua registry, keyed by its source and chunk name. A
+     * hit pushes the cached function instead of running the compiler again, which is what makes a snippet that
+     * <code>LuaManager::ExecuteString</code> runs over and over cheap. The same source under another chunk name is
+     * compiled separately, so error messages and tracebacks always name the chunk it was run as. Keys are compared in
+     * full on a hit, so a hash collision only costs a recompile. The least recently used snippet is dropped once the
+     * cache is full.
+     * </p>
+     */
+    class ChunkCache {
+    public:
+        struct Stats {
+            std::uint64_t hits = 0;
+            std::uint64_t misses = 0;
+            std::uint64_t evictions = 0;
+        };
+
+        /**
+         * Push the compiled function for a snippet onto the stack of <code>L</code>, compiling it on a miss.
+         *
+         * @return true on success; false if the snippet does not compile, with the error message pushed instead.
+         */
+        bool Push(lua_State* L, std::string_view source, const char* chunkName);
+
+        /**
+         * Change the number of snippets kept, evicting the oldest ones if needed. <code>L</code> may be null once the
+         * state is gone. A capacity of zero turns the cache off.
+         */
+        void SetCapacity(lua_State* L, std::size_t capacity);
+
+        /**
+         * Forget every snippet. Used when the Lua state is closed, which releases the references itself.
+         */
+        void Clear() noexcept;
+
+        [[nodiscard]] const Stats& GetStats() const noexcept { return _stats; }
+        [[nodiscard]] std::size_t Size() const noexcept { return _lru.size(); }
+        [[nodiscard]] std::size_t Capacity() const noexcept { return _capacity; }
+
+    private:
+        struct Entry {
+            std::uint64_t hash;
+            std::string source;
+            std::string chunkName;
+            int functionRef;
+        };
+
+        void EvictOldest(lua_State* L);
+
+        // Most recently used snippets at the front
+        std::list<Entry> _lru;
+        std::unordered_map<std::uint64_t, std::list<Entry>::iterator> _index;
+        std::size_t _capacity = 64;
+        Stats _stats;
+    };
+}
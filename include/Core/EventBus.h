@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct lua_State;
+
+namespace Sample {
+    /**
+     * Native event bus behind <code>RegisterEvent</code>, <code>TriggerEvent</code> and <code>HookGameEvent</code>.
+     *
+     * <p>
+     * Event names are interned to dense integer IDs once, at registration. Each event keeps its handlers in a dense
+     * array of Lua registry references, which dispatch walks in registration order, calling each handler in its own
+     * protected call so one failing handler does not stop the others. Unsubscribing is O(1) amortized: the entry is
+     * blanked, and the array is compacted at the end of the event's next dispatch, or sooner once blanked entries
+     * outnumber live ones and no dispatch of that event is in progress. Handlers may therefore unsubscribe themselves
+     * or each other while an event is being dispatched. Handlers added during a dispatch first run on the next one.
+     * </p>
+     */
+    class EventBus {
+    public:
+        using EventId = std::uint32_t;
+
+        struct Stats {
+            std::uint64_t dispatches = 0;
+            std::uint64_t handlerCalls = 0;
+            std::uint64_t handlerErrors = 0;
+        };
+
+        /**
+         * Get the ID of an event, creating it if needed.
+         */
+        EventId Intern(std::string_view name);
+
+        /**
+         * Get the ID of an event without creating it.
+         */
+        [[nodiscard]] std::optional<EventId> Find(std::string_view name) const;
+
+        /**
+         * Append the ID of every event whose name matches, ignoring ASCII case. For names that come from Papyrus:
+         * the engine's string pool is case-insensitive and keeps the casing of whoever interned a string first.
+         */
+        void FindIgnoringCase(std::string_view name, std::vector<EventId>& out) const;
+
+        [[nodiscard]] const std::string& GetName(EventId id) const { return _events[id].name; }
+
+        /**
+         * Add a handler already stored in the Lua registry.
+         *
+         * @return The handle used to unsubscribe.
+         */
+        std::uint32_t Subscribe(EventId id, int functionRef);
+
+        /**
+         * Remove a handler and release its registry reference.
+         *
+         * @return true if the handle referred to a live handler.
+         */
+        bool Unsubscribe(lua_State* L, std::uint32_t handle);
+
+        /**
+         * Call every handler of an event with the <code>nargs</code> values starting at stack index
+         * <code>firstArg</code> of <code>L</code>.
+         *
+         * @return The number of handlers called.
+         */
+        std::size_t Dispatch(lua_State* L, EventId id, int firstArg, int nargs);
+
+        [[nodiscard]] bool HasHandlers(EventId id) const noexcept { return _events[id].liveHandlers != 0; }
+
+        /**
+         * Forget every event and handler. Used when the Lua state is closed, which releases the references itself.
+         */
+        void Clear() noexcept;
+
+        [[nodiscard]] const Stats& GetStats() const noexcept { return _stats; }
+
+    private:
+        struct Handler {
+            std::uint32_t handle;
+            int functionRef;  // LUA_NOREF once unsubscribed, until the array is compacted
+        };
+
+        struct Event {
+            std::string name;
+            std::vector<Handler> handlers;
+            std::uint32_t liveHandlers = 0;
+            std::uint32_t dispatchDepth = 0;
+            bool needsCompaction = false;
+        };
+
+        struct HandlerLocation {
+            EventId event;
+            std::uint32_t index;
+        };
+
+        struct StringHash {
+            using is_transparent = void;
+            std::size_t operator()(std::string_view value) const noexcept {
+                return std::hash<std::string_view>{}(value);
+            }
+        };
+
+        void Compact(EventId id);
+
+        std::vector<Event> _events;
+        std::unordered_map<std::string, EventId, StringHash, std::equal_to<>> _ids;
+        std::unordered_map<std::string, std::vector<EventId>, StringHash, std::equal_to<>> _idsByLowercase;
+        std::unordered_map<std::uint32_t, HandlerLocation> _handlers;
+        std::uint32_t _nextHandle = 1;
+        Stats _stats;
+    };
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <RE/Skyrim.h>
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace Sample {
+    /**
+     * Read-only lookup tables from editor IDs and display names to FormIDs.
+     *
+     * <p>
+     * The index is built once at <code>kDataLoaded</code>. Collecting the strings is split across worker threads, one
+     * shard of the loaded forms each, and the shards are then merged into two compact tables that never change again:
+     * an open-addressing hash from lowercase editor ID to FormID, and a display-name table sorted by lowercase name
+     * for prefix search. All strings live in one arena, so the footprint is a handful of allocations regardless of the
+     * size of the load order.
+     * </p>
+     *
+     * <p>
+     * Lookups are case-insensitive (ASCII) and safe from any thread once <code>Build</code> has returned.
+     * </p>
+     */
+    class FormIndex {
+    public:
+        struct Stats {
+            std::size_t formsScanned = 0;
+            std::size_t editorIDs = 0;
+            std::size_t names = 0;
+            std::size_t bytes = 0;
+            std::size_t threads = 0;
+            double buildMillis = 0.0;
+        };
+
+        [[nodiscard]] static FormIndex* GetSingleton() noexcept;
+
+        /**
+         * Scan the loaded forms and build the tables, replacing any previous index. Logs the build time and size.
+         */
+        void Build();
+
+        /**
+         * Find a form by editor ID.
+         *
+         * @return The FormID, or 0 if no form has this editor ID.
+         */
+        [[nodiscard]] RE::FormID FindByEditorID(std::string_view editorID) const noexcept;
+
+        /**
+         * Append the FormIDs of up to <code>limit</code> forms whose display name starts with <code>prefix</code>,
+         * in name order.
+         *
+         * @return The number of FormIDs appended.
+         */
+        std::size_t FindByNamePrefix(std::string_view prefix, std::size_t limit, std::vector<RE::FormID>& out) const;
+
+        [[nodiscard]] bool IsBuilt() const noexcept { return _built; }
+        [[nodiscard]] const Stats& GetStats() const noexcept { return _stats; }
+
+    private:
+        // Where a string sits in the arena
+        struct StringRef {
+            std::uint32_t offset;
+            std::uint32_t length;
+        };
+
+        struct EditorSlot {
+            std::uint32_t hash;
+            StringRef key;  // Length 0 marks an empty slot
+            RE::FormID formID;
+        };
+
+        struct NameEntry {
+            StringRef name;
+            RE::FormID formID;
+        };
+
+        // One shard's share of the scan, merged after all shards finish
+        struct Shard {
+            std::vector<char> arena;
+            std::vector<NameEntry> editorIDs;
+            std::vector<NameEntry> names;
+        };
+
+        FormIndex() = default;
+
+        [[nodiscard]] std::string_view View(StringRef ref) const noexcept {
+            return {_arena.data() + ref.offset, ref.length};
+        }
+
+        void Merge(std::vector<Shard>& shards);
+
+        std::vector<char> _arena;
+        std::vector<EditorSlot> _editorSlots;  // Power-of-two sized, at most half full
+        std::vector<NameEntry> _names;         // Sorted by lowercase name
+        Stats _stats;
+        bool _built = false;
+    };
+}
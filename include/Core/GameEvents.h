@@ -0,0 +1,164 @@
+#pragma once
+
+#include <RE/Skyrim.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+struct lua_State;
+
+namespace Sample {
+    /**
+     * Native sinks for the game events scripts can subscribe to with <code>HookGameEvent</code>.
+     *
+     * <p>
+     * Sinks for equip, menu, combat, death and activate events copy each event into a small record. A subscription
+     * can carry a filter (a set of actor FormIDs, form types and menu names) that is checked in C++ as the event
+     * arrives, so an event only crosses into Lua when at least one subscription wants it. An event kind without any
+     * subscription costs one atomic load and a counter increment.
+     * </p>
+     *
+     * <p>
+     * Events may be sent from threads other than the main one, so accepted records are pushed onto the
+     * <code>LuaCommandQueue</code> and handed to the matching subscribers when the main thread drains it. Each kind
+     * counts the events it received, the events it delivered to Lua and the handler calls made, which shows how much
+     * the filters save.
+     * </p>
+     */
+    class GameEvents {
+    public:
+        enum class Kind : std::uint8_t {
+            kEquip,
+            kUnequip,
+            kMenuOpen,
+            kMenuClose,
+            kCombatStateChanged,
+            kDeath,
+            kActivate,
+            kTotal
+        };
+
+        // Set on every subscription handle so they never collide with event bus handles
+        static constexpr std::uint32_t HandleBit = 1u << 30;
+
+        struct Event {
+            Kind kind;
+            RE::FormID subject;  // The actor equipping, fighting, dying or activating
+            RE::FormID object;   // The item, combat target, killer or activated reference
+            RE::FormType objectType;  // The item's type, or the base object's type for a reference
+            std::int32_t value;  // The new combat state
+            RE::BSFixedString menu;
+        };
+
+        /**
+         * Every non-empty part of a filter must match: <code>actors</code> is checked against the event's subject,
+         * <code>formTypes</code> against its object (for a combat target, killer or activated reference, the type of
+         * its base object), and <code>menus</code> against the menu name of menu events.
+         */
+        struct Filter {
+            std::vector<RE::FormID> actors;  // Sorted
+            std::vector<RE::FormType> formTypes;
+            std::vector<RE::BSFixedString> menus;
+
+            [[nodiscard]] bool Matches(const Event& event) const noexcept;
+        };
+
+        struct Stats {
+            std::string_view name;
+            std::uint32_t subscriptions;
+            std::uint64_t received;
+            std::uint64_t delivered;  // Events that passed a filter and were handed to Lua
+            std::uint64_t dropped;    // Accepted events lost because the command queue was full
+            std::uint64_t handlerCalls;
+        };
+
+        [[nodiscard]] static GameEvents* GetSingleton() noexcept;
+
+        [[nodiscard]] static std::optional<Kind> FindKind(std::string_view name) noexcept;
+
+        /**
+         * Register the event sinks. Called once game data has loaded.
+         */
+        void Initialize();
+
+        /**
+         * Add a subscription whose function is already stored in the Lua registry.
+         *
+         * @return The handle used to unsubscribe.
+         */
+        std::uint32_t Subscribe(Kind kind, int functionRef, Filter filter);
+
+        /**
+         * Remove a subscription and release its registry reference.
+         *
+         * @return true if the handle referred to a live subscription.
+         */
+        bool Unsubscribe(lua_State* L, std::uint32_t handle);
+
+        /**
+         * Count an event arriving at a sink.
+         *
+         * @return false if nothing subscribes to the kind, so the sink can skip building the record.
+         */
+        bool Receive(Kind kind) noexcept {
+            auto& counters = _counters[static_cast<std::size_t>(kind)];
+            counters.received.fetch_add(1, std::memory_order_relaxed);
+            return counters.subscriptions.load(std::memory_order_relaxed) != 0;
+        }
+
+        /**
+         * Queue an event if a subscription accepts it. Called by the sinks, from any thread.
+         */
+        void Capture(const Event& event);
+
+        /**
+         * Call the subscribers matching a queued event. Called on the main thread as the command queue is drained.
+         */
+        void Dispatch(lua_State* L, const Event& event);
+
+        /**
+         * Forget every subscription without releasing its reference. Used when the Lua state is closed.
+         */
+        void Reset() noexcept;
+
+        void GetStats(std::vector<Stats>& out) const;
+
+    private:
+        static constexpr auto KindCount = static_cast<std::size_t>(Kind::kTotal);
+
+        struct Subscription {
+            std::uint32_t handle;
+            Kind kind;
+            int functionRef;  // LUA_NOREF once unsubscribed, until the list is compacted
+            Filter filter;
+        };
+
+        struct Counters {
+            std::atomic<std::uint32_t> subscriptions{0};
+            std::atomic<std::uint64_t> received{0};
+            std::atomic<std::uint64_t> dropped{0};
+            std::uint64_t delivered = 0;
+            std::uint64_t handlerCalls = 0;
+        };
+
+        GameEvents() = default;
+
+        // Push the handler arguments for an event and return how many there are
+        static int PushArguments(lua_State* L, const Event& event);
+
+        // Drop unsubscribed entries from the list
+        void Compact();
+
+        std::mutex _lock;  // Guards the subscription list against the sinks
+        std::vector<Subscription> _subscriptions;
+        std::array<Counters, KindCount> _counters;
+        std::uint32_t _nextHandle = 1;
+        bool _dispatching = false;
+        bool _compact = false;
+    };
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace Sample {
+    // 64-bit FNV-1a, used for cache file names and content keys. Passing a previous result as the seed continues it,
+    // which hashes several fields as one key.
+    [[nodiscard]] constexpr std::uint64_t HashBytes(std::string_view bytes,
+                                                    std::uint64_t hash = 0xcbf29ce484222325ull) noexcept {
+        for (const char c : bytes) {
+            hash ^= static_cast<std::uint8_t>(c);
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+}
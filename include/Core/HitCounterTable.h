@@ -0,0 +1,236 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace RE {
+    // Actors are only keys here and never dereferenced, so the table builds without the engine headers
+    class Actor;
+}
+
+namespace Sample {
+    /**
+     * Per-actor tracked flags and hit counts in one flat open-addressing table.
+     *
+     * <p>
+     * Each slot holds an actor pointer and a single 64-bit state word packing the hit count with the tracked and
+     * has-count flags, so an increment is one compare-and-swap on one word and never takes a lock. A bit filter in
+     * front of the table answers "definitely not tracked" for most actors without probing; that is the common case for
+     * a hit, since only a handful of actors are tracked.
+     * </p>
+     *
+     * <p>
+     * Reads are wait-free. Structural changes (tracking a new actor, growing, clearing) are serialized by a mutex
+     * that the hit path never touches. Growing copies the slots into a table twice the size, marking each old slot as
+     * moved so that a concurrent increment retries on the new table instead of being lost. Old tables are kept until
+     * the counter is destroyed, since a hit may still be reading one.
+     * </p>
+     *
+     * <p>
+     * Every actor in the table also gets a rolling window of per-second hit buckets covering the last minute, plus the
+     * time of its last hit, so rates and recent counts are answered without keeping any history. Windows live outside
+     * the slots, in fixed chunks that never move, and the slot's state word carries the window's index, so growing
+     * the table leaves them in place. A window is guarded by its own spinlock, held only for a few bucket updates.
+     * </p>
+     *
+     * <p>
+     * Running totals of tracked actors and of their counts are kept next to the table; tracking or untracking an actor
+     * moves its count in or out of the total. For ranking, actors with a count
+     * are also filed into buckets by the highest set bit of their count; an actor only changes bucket when its count
+     * crosses a power of two, so the hit path takes the ranking lock a few dozen times per actor rather than once per
+     * hit. A top-N query walks the buckets from the top and sorts only the candidates it collects.
+     * </p>
+     */
+    class HitCounterTable {
+    public:
+        static constexpr std::size_t InitialCapacity = 64;
+        static constexpr std::size_t FilterBits = 1 << 16;
+        static constexpr std::uint32_t WindowSeconds = 60;
+        static constexpr std::size_t WindowsPerChunk = 256;
+        static constexpr std::size_t MaxWindowChunks = 1024;
+        static constexpr std::size_t RankBuckets = 32;
+
+        struct Totals {
+            std::size_t tracked = 0;
+            std::int64_t hits = 0;  // Sum of the counts of tracked actors
+        };
+
+        /**
+         * One actor's hits per second over the last minute, and the time of its last hit.
+         *
+         * <p>
+         * Hits are timestamped before the spinlock is taken, so a thread may record into a second older than the
+         * newest one; such a hit still counts if its second is inside the window.
+         * </p>
+         */
+        struct Window {
+            std::atomic_flag lock;
+            std::uint32_t second = 0;  // The second the newest bucket belongs to
+            std::uint64_t lastHitMicros = 0;
+            std::array<std::uint16_t, WindowSeconds> buckets{};
+
+            void Reset() noexcept;
+            void Record(std::uint64_t nowMicros, std::int32_t hits) noexcept;
+            [[nodiscard]] std::uint32_t Sum(std::uint64_t nowMicros, std::uint32_t seconds) noexcept;
+        };
+
+        HitCounterTable();
+
+        HitCounterTable(const HitCounterTable&) = delete;
+        HitCounterTable& operator=(const HitCounterTable&) = delete;
+
+        /**
+         * @return true if the actor was not already tracked.
+         */
+        bool Track(RE::Actor* actor);
+
+        /**
+         * Track several actors under a single acquisition of the write lock. Null entries are skipped.
+         *
+         * @return The number of actors that were not already tracked.
+         */
+        std::size_t Track(std::span<RE::Actor* const> actors);
+
+        /**
+         * Stop counting hits for an actor. Its count, if any, is kept.
+         *
+         * @return true if the actor was tracked.
+         */
+        bool Untrack(RE::Actor* actor);
+
+        /**
+         * Add to the count of a tracked actor; does nothing for untracked actors. Lock-free unless the count crosses
+         * a power of two and the actor has to be re-ranked.
+         */
+        void Increment(RE::Actor* actor, std::int32_t by);
+
+        /**
+         * Set the count of an actor whether or not it is tracked, as when loading a save.
+         */
+        void SetCount(RE::Actor* actor, std::int32_t count);
+
+        /**
+         * Set the count of every listed actor that has one back to zero, under a single acquisition of the write lock.
+         * Actors without a count are left alone.
+         */
+        void ResetCounts(std::span<RE::Actor* const> actors);
+
+        /**
+         * @return The actor's count, or empty if it has never been hit while tracked. Wait-free.
+         */
+        [[nodiscard]] std::optional<std::int32_t> GetCount(const RE::Actor* actor) const noexcept;
+
+        [[nodiscard]] bool IsTracked(const RE::Actor* actor) const noexcept;
+
+        /**
+         * @return The hits counted for the actor in the last <code>seconds</code> seconds (1 to 60), including the
+         * current second so far.
+         */
+        [[nodiscard]] std::uint32_t GetHitsInLast(const RE::Actor* actor, std::uint32_t seconds) const noexcept;
+
+        /**
+         * @return Seconds since the actor's last counted hit, or empty if it has not been hit since it was added.
+         */
+        [[nodiscard]] std::optional<double> GetTimeSinceLastHit(const RE::Actor* actor) const noexcept;
+
+        [[nodiscard]] Totals GetTotals() const noexcept;
+
+        /**
+         * Append up to <code>count</code> tracked actors with the highest hit counts to <code>out</code>, highest
+         * first.
+         */
+        void GetTop(std::size_t count, std::vector<std::pair<RE::Actor*, std::int32_t>>& out) const;
+
+        /**
+         * Forget every actor. Meant for reverting game state, when no hits are being processed.
+         */
+        void Clear();
+
+        /**
+         * Call <code>visit(actor, tracked, count)</code> for every actor that is tracked or has a count.
+         * Structural changes wait until it returns.
+         */
+        template <class F>
+        void ForEach(F&& visit) const;
+
+    private:
+        static constexpr std::uint64_t CountMask = 0xFFFFFFFF;
+        static constexpr std::uint64_t Tracked = std::uint64_t{1} << 32;
+        static constexpr std::uint64_t HasCount = std::uint64_t{1} << 33;
+        static constexpr std::uint64_t Moved = std::uint64_t{1} << 34;
+        static constexpr unsigned WindowShift = 35;  // The remaining bits hold the window index plus one
+
+        struct Slot {
+            std::atomic<RE::Actor*> key{nullptr};
+            std::atomic<std::uint64_t> state{0};
+        };
+
+        struct Table {
+            explicit Table(std::size_t capacity) : mask(capacity - 1), slots(new Slot[capacity]) {}
+
+            std::size_t mask;
+            std::unique_ptr<Slot[]> slots;
+        };
+
+        [[nodiscard]] static std::uint32_t Hash(const RE::Actor* actor) noexcept;
+        [[nodiscard]] static Slot* Find(const Table& table, const RE::Actor* actor, std::uint32_t hash) noexcept;
+        [[nodiscard]] bool MayContain(std::uint32_t hash) const noexcept;
+        [[nodiscard]] const Slot* FindSlot(const RE::Actor* actor) const noexcept;
+        [[nodiscard]] Window* GetWindow(std::uint64_t state) const noexcept;
+        [[nodiscard]] static std::uint64_t NowMicros() noexcept;
+
+        // Find or add the actor's slot; the write lock must be held
+        Slot& Insert(RE::Actor* actor);
+        // The write lock must be held
+        bool TrackLocked(RE::Actor* actor);
+        // Store a count in the slot and, if the actor is tracked, adjust the running total
+        void StoreCount(Slot& slot, std::int32_t count) noexcept;
+        [[nodiscard]] std::uint64_t AllocateWindow();
+
+        [[nodiscard]] static std::uint8_t RankBucket(std::int32_t count) noexcept;
+        // File the actor under the bucket of its current count
+        void Rerank(RE::Actor* actor);
+        void Grow();
+
+        std::atomic<Table*> _current;
+        std::vector<std::unique_ptr<Table>> _tables;  // The current table and every table it replaced
+        std::size_t _used = 0;
+        std::array<std::atomic<std::uint64_t>, FilterBits / 64> _filter{};
+        std::array<std::atomic<Window*>, MaxWindowChunks> _windowChunks{};
+        std::vector<std::unique_ptr<Window[]>> _windowStorage;
+        std::size_t _windowsUsed = 0;
+        mutable std::mutex _writeLock;
+        std::atomic<std::size_t> _trackedCount{0};
+        std::atomic<std::int64_t> _totalHits{0};
+        std::array<std::unordered_set<RE::Actor*>, RankBuckets> _rankBuckets;
+        std::unordered_map<RE::Actor*, std::uint8_t> _rankOf;
+        mutable std::mutex _rankLock;
+    };
+
+    template <class F>
+    void HitCounterTable::ForEach(F&& visit) const {
+        std::unique_lock lock(_writeLock);
+        const auto* table = _current.load(std::memory_order_acquire);
+        for (std::size_t i = 0; i <= table->mask; ++i) {
+            auto* actor = table->slots[i].key.load(std::memory_order_acquire);
+            if (!actor) {
+                continue;
+            }
+            const auto state = table->slots[i].state.load(std::memory_order_acquire);
+            if (state & (Tracked | HasCount)) {
+                const auto count = (state & HasCount) ? std::optional{static_cast<std::int32_t>(state & CountMask)}
+                                                      : std::nullopt;
+                visit(actor, (state & Tracked) != 0, count);
+            }
+        }
+    }
+}
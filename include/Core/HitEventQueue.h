@@ -0,0 +1,83 @@
+#pragma once
+
+#include <RE/Skyrim.h>
+
+#include "Core/MpscRing.h"
+
+#include <atomic>
+#include <cstdint>
+
+namespace Sample {
+    /**
+     * A lock-free ring of hit records, filled by the hit hook and drained once per frame.
+     *
+     * <p>
+     * The producer is the <code>PopulateHitData</code> hook, which can run on more than one thread, so the records
+     * sit in an <code>MpscRing</code>; pushing a record is one compare-and-swap and a few stores and never blocks.
+     * When the ring is full the record is dropped and counted instead. The consumer peeks at everything published so
+     * far as a <code>Batch</code>, which reads the records in place, and releases them once it is done, so the records
+     * are never copied.
+     * </p>
+     *
+     * <p>
+     * The hooked call only receives the target, so a record holds the target, the time of the hit and the frame it
+     * happened in. Records from different threads are in the order their pushes claimed a cell.
+     * </p>
+     */
+    class HitEventQueue {
+    public:
+        static constexpr std::size_t Capacity = 4096;
+
+        struct Record {
+            RE::FormID target;
+            std::uint32_t frame;
+            std::uint64_t timeMicros;  // Since the plugin was loaded
+        };
+
+        /**
+         * A view over the records waiting in the ring. Valid until it is released.
+         */
+        struct Batch {
+            const MpscRing<Record, Capacity>* ring;
+            std::uint32_t count;
+            std::uint64_t dropped;  // Records lost to overflow since the previous batch
+
+            [[nodiscard]] const Record& operator[](std::size_t index) const noexcept { return *ring->Peek(index); }
+        };
+
+        struct Stats {
+            std::uint64_t pushed = 0;
+            std::uint64_t dropped = 0;
+            std::uint32_t highWater = 0;  // Largest batch seen
+        };
+
+        [[nodiscard]] static HitEventQueue* GetSingleton() noexcept;
+
+        /**
+         * Append a hit. Safe from any thread.
+         *
+         * @return false if the ring was full and the hit was dropped.
+         */
+        bool Push(const RE::Actor* target) noexcept;
+
+        /**
+         * Everything pushed since the last release. Consumer side only.
+         */
+        [[nodiscard]] Batch Peek() const noexcept;
+
+        /**
+         * Hand the records of a batch back to the producer and start a new frame. Consumer side only.
+         */
+        void Release(const Batch& batch) noexcept;
+
+        [[nodiscard]] Stats GetStats() const noexcept;
+
+    private:
+        HitEventQueue() = default;
+
+        MpscRing<Record, Capacity> _records;
+        std::atomic<std::uint32_t> _frame{0};
+        std::uint64_t _droppedReported = 0;
+        std::uint32_t _highWater = 0;
+    };
+}
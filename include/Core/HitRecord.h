@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Core/ByteBuffer.h"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace Sample {
+    /**
+     * One actor's entry in the saved hit data, keyed by the FormID as written to the cosave.
+     */
+    struct SavedActor {
+        std::uint32_t formID;
+        bool tracked;
+        std::optional<std::int32_t> count;
+    };
+
+    /**
+     * Encode the body of a <code>HITS</code> record.
+     *
+     * <p>
+     * The actors are sorted by FormID and stored as varint deltas, since most actors of one plugin are a byte or two
+     * apart, each followed by a flags byte and, if it has one, its zigzag-encoded count.
+     * </p>
+     */
+    void WriteHitsRecord(std::vector<SavedActor>& actors, ByteWriter& writer);
+
+    /**
+     * Decode the body of a <code>HITS</code> record into <code>actors</code>.
+     *
+     * @return false if the record is truncated or holds a value no writer produced; the entries read before the
+     * problem are kept.
+     */
+    bool ParseHitsRecord(ByteReader& reader, std::vector<SavedActor>& actors);
+
+    /**
+     * Decode a <code>HITC</code> record of older versions: a size_t count followed by raw FormID and count pairs.
+     */
+    bool ParseLegacyHitCounts(ByteReader& reader, std::vector<SavedActor>& actors);
+
+    /**
+     * Decode a <code>TACT</code> record of older versions: a size_t count followed by raw tracked FormIDs.
+     */
+    bool ParseLegacyTrackedActors(ByteReader& reader, std::vector<SavedActor>& actors);
+}
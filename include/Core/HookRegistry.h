@@ -0,0 +1,146 @@
+#pragma once
+
+#include <SKSE/SKSE.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct lua_State;
+
+namespace Sample {
+    /**
+     * Installs the plugin's engine hooks and lets Lua scripts observe them.
+     *
+     * <p>
+     * Each hook site is declared once, as a <code>Site</code>: its Address Library IDs and offsets, the function that
+     * writes its call patch, and a view that turns a captured call into Lua values. The registry sizes the
+     * trampoline from the declared sites and installs them all.
+     * </p>
+     *
+     * <p>
+     * A site's thunk asks <code>IsSubscribed</code> before doing anything for Lua; with no subscriber that is a single
+     * load and a well-predicted branch, and the thunk goes straight on to the original function. With subscribers,
+     * the thunk copies the call's arguments into a <code>Record</code> and queues it. Queued records are delivered once
+     * per frame from <code>LuaManager::Update</code>, as one array per site, so Lua never runs inside an engine
+     * call. A site queues at most <code>MaxPendingPerSite</code> records per frame and counts the rest as dropped.
+     * </p>
+     */
+    class HookRegistry {
+    public:
+        // write_call<5> routes each patched call through a 14-byte absolute jump in the trampoline
+        static constexpr std::size_t TrampolineBytesPerSite = 14;
+        static constexpr std::size_t MaxPendingPerSite = 4096;
+        static constexpr std::size_t RecordWords = 4;
+
+        // The raw arguments of one call; the site's view decides what the words mean
+        struct Record {
+            std::array<std::uint64_t, RecordWords> words;
+        };
+
+        struct Site {
+            std::string_view name;
+            std::uint64_t seID;
+            std::uint64_t aeID;
+            std::size_t seOffset;
+            std::size_t aeOffset;
+            // Write the call patch at the resolved address
+            void (*install)(SKSE::Trampoline& trampoline, std::uintptr_t address);
+            // Push one captured call as a single Lua value; null for sites scripts cannot subscribe to
+            void (*push)(lua_State* L, const Record& record);
+        };
+
+        struct SiteStats {
+            std::string_view name;
+            std::uint32_t subscribers;
+            std::uint64_t captured;
+            std::uint64_t dropped;
+            std::uint64_t deliveries;  // Batches handed to subscribers
+        };
+
+        [[nodiscard]] static HookRegistry* GetSingleton() noexcept;
+
+        /**
+         * Trampoline bytes needed to install <code>sites</code>.
+         */
+        [[nodiscard]] static std::size_t GetTrampolineSize(std::span<const Site> sites) noexcept {
+            return sites.size() * TrampolineBytesPerSite;
+        }
+
+        /**
+         * Install every site. The index of a site in <code>sites</code> is its ID. Must be called once.
+         */
+        void Install(SKSE::Trampoline& trampoline, std::span<const Site> sites);
+
+        [[nodiscard]] std::optional<std::uint32_t> FindSite(std::string_view name) const noexcept;
+
+        [[nodiscard]] bool IsSubscribed(std::uint32_t site) const noexcept {
+            return _states[site].subscribers.load(std::memory_order_relaxed) != 0;
+        }
+
+        /**
+         * Queue a call for the site's subscribers. Safe from any thread.
+         */
+        void Capture(std::uint32_t site, const Record& record);
+
+        /**
+         * Add a subscriber whose function is already stored in the Lua registry.
+         *
+         * @return The handle used to unsubscribe, or empty if scripts cannot subscribe to the site.
+         */
+        std::optional<std::uint32_t> Subscribe(std::uint32_t site, int functionRef);
+
+        /**
+         * Remove a subscriber and release its registry reference.
+         *
+         * @return true if the handle referred to a live subscriber.
+         */
+        bool Unsubscribe(lua_State* L, std::uint32_t handle);
+
+        /**
+         * Hand each site's queued calls to its subscribers. Called once per frame on the main thread.
+         */
+        void Deliver(lua_State* L);
+
+        /**
+         * Forget every subscriber without releasing its reference. Used when the Lua state is closed.
+         */
+        void Reset() noexcept;
+
+        void GetStats(std::vector<SiteStats>& out) const;
+
+    private:
+        struct Subscriber {
+            std::uint32_t handle;
+            int functionRef;  // LUA_NOREF once unsubscribed, until the list is compacted
+        };
+
+        struct SiteState {
+            std::atomic<std::uint32_t> subscribers{0};
+            std::mutex lock;  // Guards pending and the capture counters
+            std::vector<Record> pending;
+            std::uint64_t captured = 0;
+            std::uint64_t dropped = 0;
+            std::uint64_t deliveries = 0;
+            std::vector<Subscriber> list;
+        };
+
+        HookRegistry() = default;
+
+        void Compact(SiteState& state);
+
+        std::span<const Site> _sites;
+        std::unique_ptr<SiteState[]> _states;
+        std::unordered_map<std::uint32_t, std::uint32_t> _siteByHandle;
+        std::uint32_t _nextHandle = 1;
+        std::vector<Record> _delivering;
+        bool _dispatching = false;
+    };
+}
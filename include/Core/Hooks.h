@@ -0,0 +1,27 @@
+#pragma once
+
+#include <RE/Skyrim.h>
+#include <SKSE/SKSE.h>
+
+namespace Sample {
+    /**
+     * Trampoline space needed by <code>InitializeHooks</code>.
+     */
+    [[nodiscard]] std::size_t GetHookTrampolineSize() noexcept;
+
+    /**
+     * Install the plugin's engine hooks through the <code>HookRegistry</code>.
+     *
+     * <p>
+     * <code>MainUpdate</code> hooks the engine's main loop so the plugin gets a per-frame tick on the main thread:
+     * every frame it calls <code>LuaManager::Update</code> with the real time elapsed since the previous frame.
+     * </p>
+     *
+     * <p>
+     * <code>PopulateHitData</code> hooks the function that fills in hit data, counting the hit for the target and
+     * recording it for <code>OnHitBatch</code>. Scripts can subscribe to it with <code>SubscribeHook</code>; each
+     * captured call is delivered as <code>{ target = handle, formID = id }</code>.
+     * </p>
+     */
+    void InitializeHooks(SKSE::Trampoline& trampoline);
+}
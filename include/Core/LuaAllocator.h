@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Sample {
+    /**
+     * Allocator handed to <code>lua_newstate</code> for the plugin's Lua state.
+     *
+     * <p>
+     * Small blocks (tables, strings, closures) are served from per-size-class freelists carved out of 64 KiB slabs, so
+     * the VM stops hammering the CRT heap the game also uses. Anything above the largest size class falls back to
+     * <code>realloc</code>/<code>free</code>. Lua always tells the allocator the old size of a block, which is enough
+     * to find its size class without per-block headers.
+     * </p>
+     *
+     * <p>
+     * The allocator is owned by a single Lua state and is not thread-safe, just like the state itself.
+     * </p>
+     */
+    class LuaAllocator {
+    public:
+        static constexpr std::size_t ClassCount = 14;
+        static constexpr std::array<std::uint16_t, ClassCount> ClassSizes = {16,  32,  48,  64,  80,  96,  128,
+                                                                              160, 192, 256, 320, 384, 448, 512};
+        static constexpr std::size_t MaxSmallSize = 512;
+        static constexpr std::size_t SlabSize = 64 * 1024;
+
+        struct Stats {
+            std::size_t liveBytes = 0;
+            std::size_t peakBytes = 0;
+            std::size_t slabBytes = 0;
+            std::size_t largeLiveBytes = 0;
+            std::uint64_t largeAllocations = 0;
+            std::array<std::uint64_t, ClassCount> classAllocations{};  // Blocks ever handed out per size class
+            std::array<std::uint64_t, ClassCount> classLive{};         // Blocks currently in use per size class
+        };
+
+        LuaAllocator() = default;
+        ~LuaAllocator();
+
+        LuaAllocator(const LuaAllocator&) = delete;
+        LuaAllocator& operator=(const LuaAllocator&) = delete;
+
+        /**
+         * The <code>lua_Alloc</code> entry point. The user data must be the owning <code>LuaAllocator</code>.
+         */
+        static void* Allocate(void* userData, void* ptr, std::size_t oldSize, std::size_t newSize) noexcept;
+
+        [[nodiscard]] const Stats& GetStats() const noexcept { return _stats; }
+
+        /**
+         * Write the live/peak counters and the per-size-class histogram to the SKSE log.
+         */
+        void LogStats() const;
+
+    private:
+        struct FreeBlock {
+            FreeBlock* next;
+        };
+
+        [[nodiscard]] static std::size_t ClassIndex(std::size_t size) noexcept;
+
+        void* AllocateSmall(std::size_t classIndex) noexcept;
+        void FreeSmall(void* ptr, std::size_t classIndex) noexcept;
+        void* Reallocate(void* ptr, std::size_t oldSize, std::size_t newSize) noexcept;
+
+        std::array<FreeBlock*, ClassCount> _freeLists{};
+        std::array<std::byte*, ClassCount> _slabCursor{};
+        std::array<std::byte*, ClassCount> _slabEnd{};
+        std::vector<void*> _slabs;
+        Stats _stats;
+    };
+}
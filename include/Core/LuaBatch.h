@@ -0,0 +1,52 @@
+#pragma once
+
+extern "C" {
+#include <lua.h>
+#include <lauxlib.h>
+}
+
+#include <cstddef>
+#include <vector>
+
+namespace Sample {
+    /**
+     * Read the array at <code>index</code> into <code>out</code>, converting each element with
+     * <code>convert(L, -1)</code>, for the batch query bindings (<code>GetActorValues</code> and friends).
+     *
+     * <p>
+     * <code>out</code> is cleared first and keeps its capacity, so a buffer reused across calls stops allocating once
+     * it has grown to the largest batch.
+     * </p>
+     *
+     * @return The length of the array.
+     */
+    template <class T, class Convert>
+    std::size_t ReadBatchArray(lua_State* L, int index, std::vector<T>& out, Convert&& convert) {
+        luaL_checktype(L, index, LUA_TTABLE);
+        const auto count = static_cast<std::size_t>(lua_rawlen(L, index));
+        out.clear();
+        out.reserve(count);
+        for (std::size_t i = 1; i <= count; ++i) {
+            lua_rawgeti(L, index, static_cast<lua_Integer>(i));
+            out.push_back(convert(L, -1));
+            lua_pop(L, 1);
+        }
+        return count;
+    }
+
+    /**
+     * Push a new array of <code>count</code> results. <code>push(i)</code> pushes the result for element
+     * <code>i</code> (from zero) and returns true, or pushes nothing and returns false for an element that does not
+     * resolve, which is stored as <code>false</code> so the result stays a proper sequence.
+     */
+    template <class Push>
+    void PushBatchResults(lua_State* L, std::size_t count, Push&& push) {
+        lua_createtable(L, static_cast<int>(count), 0);
+        for (std::size_t i = 0; i < count; ++i) {
+            if (!push(i)) {
+                lua_pushboolean(L, false);
+            }
+            lua_rawseti(L, -2, static_cast<lua_Integer>(i + 1));
+        }
+    }
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <RE/Skyrim.h>
+
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+struct lua_State;
+
+namespace Sample {
+    /**
+     * Calls Lua functions on behalf of Papyrus natives.
+     *
+     * <p>
+     * A function is named by a dotted path from the globals, such as <code>"Quests.OnStage"</code>. The first call
+     * walks the path and keeps the function in a registry reference, keyed by the address of the interned
+     * <code>BSFixedString</code> Papyrus passes, so later calls with the same name skip both the string hashing and
+     * the table lookups. The cache holds a copy of each name, which keeps its pool entry (and so the key) alive.
+     * Assigning a new function to a cached path is only picked up after <code>Clear</code>.
+     * </p>
+     *
+     * <p>
+     * The string pool ignores case and keeps the casing of whichever script interned a name first, so the path may
+     * not arrive as the calling script spelled it. Each part is looked up as written first; if that finds nothing,
+     * the table's string keys are compared ignoring case, and the part resolves only if exactly one of them matches.
+     * Since every casing of a name shares one pool entry, they all share one cache entry too.
+     * </p>
+     *
+     * <p>
+     * Arguments go straight from the Papyrus arrays onto the Lua stack: the target form as a handle, then each float
+     * as a number. The function's first result is returned as a float (booleans become 1 or 0, anything else 0).
+     * Like the Lua state itself, the bridge must only be used from the main thread.
+     * </p>
+     */
+    class LuaCallBridge {
+    public:
+        struct Stats {
+            std::uint64_t calls = 0;
+            std::uint64_t errors = 0;     // Calls that raised an error or named no function
+            std::uint64_t resolves = 0;   // Names looked up from the globals
+            std::uint64_t cacheHits = 0;  // Names found in the cache
+            std::uint64_t totalMicros = 0;
+            std::uint32_t maxMicros = 0;
+        };
+
+        /**
+         * Call <code>function(target, args...)</code>.
+         *
+         * @return The first result as a float, or 0 if the call failed.
+         */
+        float Call(lua_State* L, const RE::BSFixedString& function, RE::TESForm* target, std::span<const float> args);
+
+        /**
+         * Call <code>function(target, args...)</code> once per target, resolving the function once.
+         *
+         * @param out Receives one result per target, 0 for calls that failed.
+         */
+        void CallBatch(lua_State* L, const RE::BSFixedString& function, std::span<RE::TESForm* const> targets,
+                       std::span<const float> args, std::vector<float>& out);
+
+        /**
+         * Drop every cached function, so the next call resolves its path again.
+         */
+        void Clear(lua_State* L);
+
+        /**
+         * Forget every cached function without releasing its reference. Used when the Lua state is closed.
+         */
+        void Reset() noexcept;
+
+        [[nodiscard]] std::size_t Size() const noexcept { return _functions.size(); }
+        [[nodiscard]] const Stats& GetStats() const noexcept { return _stats; }
+
+    private:
+        struct Entry {
+            RE::BSFixedString name;
+            int functionRef;
+        };
+
+        // Push the named function, resolving it on a cache miss
+        bool PushFunction(lua_State* L, const RE::BSFixedString& function);
+
+        // Call a copy of the function on top of the stack, leaving the function in place
+        float Invoke(lua_State* L, const RE::BSFixedString& function, RE::TESForm* target,
+                     std::span<const float> args);
+
+        std::unordered_map<const char*, Entry> _functions;
+        Stats _stats;
+    };
+}
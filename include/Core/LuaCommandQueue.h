@@ -0,0 +1,111 @@
+#pragma once
+
+#include "Core/GameEvents.h"
+#include "Core/MpscRing.h"
+
+#include <RE/Skyrim.h>
+
+#include <array>
+#include <cstdint>
+#include <span>
+
+namespace Sample {
+    /**
+     * A bounded, lock-free, multi-producer single-consumer queue of commands for the Lua state.
+     *
+     * <p>
+     * Event sinks, engine hooks and Papyrus natives run on many threads, but only the main thread may touch the Lua
+     * state. They hand work over by pushing a <code>Command</code> here; the main thread drains the queue once per
+     * frame from <code>LuaManager::Update</code>, within a time budget, and whatever is left carries over to the next
+     * frame.
+     * </p>
+     *
+     * <p>
+     * The commands live in an <code>MpscRing</code>: a push is one compare-and-swap plus the stores filling the cell
+     * and never blocks, and a push into a full queue fails and is counted as dropped. The consumer reads each command
+     * in place and releases its cell when done.
+     * </p>
+     */
+    class LuaCommandQueue {
+    public:
+        static constexpr std::size_t Capacity = 8192;
+        static constexpr std::size_t MaxArgs = 6;
+
+        enum class Type : std::uint8_t {
+            kGameEvent,  // A game event accepted by a subscription's filter
+            kEvent       // A named event for the event bus, with numeric arguments
+        };
+
+        struct Command {
+            Type type;
+            std::uint8_t argCount;
+            std::uint64_t enqueuedMicros;
+            GameEvents::Event gameEvent;
+            RE::BSFixedString name;
+            std::array<float, MaxArgs> args;
+        };
+
+        struct Stats {
+            std::uint64_t pushed = 0;
+            std::uint64_t drained = 0;
+            std::uint64_t dropped = 0;        // Pushes that found the queue full
+            std::uint32_t highWater = 0;      // Deepest the queue has been
+            std::uint64_t backlogFrames = 0;  // Drains that ran out of budget with commands left
+            std::uint64_t totalLatencyMicros = 0;
+            std::uint32_t maxLatencyMicros = 0;
+        };
+
+        [[nodiscard]] static LuaCommandQueue* GetSingleton() noexcept;
+
+        // The clock command timestamps are taken from
+        [[nodiscard]] static std::uint64_t NowMicros() noexcept;
+
+        /**
+         * Queue a game event. Safe from any thread.
+         *
+         * @return false if the queue was full and the event was dropped.
+         */
+        bool Push(const GameEvents::Event& event);
+
+        /**
+         * Queue a named event with up to <code>MaxArgs</code> numeric arguments. Safe from any thread.
+         *
+         * @return false if there were too many arguments, or the queue was full and the event was dropped.
+         */
+        bool Push(const RE::BSFixedString& name, std::span<const float> args);
+
+        /**
+         * The oldest published command, or null if there is none. Consumer side only.
+         */
+        [[nodiscard]] const Command* Front() const noexcept;
+
+        /**
+         * Release the command returned by <code>Front</code>. Consumer side only.
+         *
+         * @param startMicros When handling of the command began, for the latency counters.
+         */
+        void Pop(std::uint64_t startMicros) noexcept;
+
+        /**
+         * Count a drain that stopped at its budget with commands left over. Consumer side only.
+         */
+        void NoteBacklog() noexcept { ++_backlogFrames; }
+
+        /**
+         * Discard every queued command. Consumer side only.
+         */
+        void Clear() noexcept;
+
+        [[nodiscard]] std::size_t Size() const noexcept;
+        [[nodiscard]] Stats GetStats() const noexcept;
+
+    private:
+        LuaCommandQueue() = default;
+
+        MpscRing<Command, Capacity> _ring;
+        alignas(64) std::uint64_t _drained = 0;
+        std::uint64_t _backlogFrames = 0;
+        std::uint64_t _totalLatencyMicros = 0;
+        std::uint32_t _maxLatencyMicros = 0;
+    };
+}
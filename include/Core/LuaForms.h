@@ -0,0 +1,80 @@
+#pragma once
+
+#include <RE/Skyrim.h>
+
+struct lua_State;
+
+namespace Sample {
+    /**
+     * Create the <code>Form</code> handle metatable and the weak handle cache in a Lua state.
+     *
+     * <p>
+     * A handle is a small userdata holding a FormID together with the resolved form pointer and the form generation
+     * it was resolved in. Methods called on a handle (<code>actor:GetName()</code>) reuse the cached pointer instead
+     * of looking the FormID up again, until the generation changes on revert and load. A deleted form only marks its
+     * own handle stale. The cache maps each FormID to one handle, held weakly, so the same form always yields the same
+     * handle while scripts keep it alive.
+     * </p>
+     */
+    void RegisterFormHandles(lua_State* L);
+
+    /**
+     * Push the handle for a form, or <code>nil</code> if the form is null.
+     */
+    void PushFormHandle(lua_State* L, RE::TESForm* form);
+
+    /**
+     * Read a form argument, accepting either a handle or an integer FormID.
+     *
+     * @return The form, or nullptr if it cannot be resolved.
+     */
+    RE::TESForm* GetFormArg(lua_State* L, int index);
+
+    /**
+     * Read an actor argument, accepting either a handle or an integer FormID.
+     *
+     * @return The actor, or nullptr if the form cannot be resolved or is not an actor.
+     */
+    RE::Actor* GetActorArg(lua_State* L, int index);
+
+    /**
+     * Convert a stack value to a form without raising an error, for values read out of tables.
+     *
+     * @return The form, or nullptr if the value is neither a resolvable handle nor a FormID.
+     */
+    RE::TESForm* ToForm(lua_State* L, int index);
+
+    /**
+     * Convert a stack value to an actor without raising an error.
+     */
+    RE::Actor* ToActor(lua_State* L, int index);
+
+    /**
+     * Read a FormID argument, accepting either a handle or an integer FormID, without resolving it.
+     */
+    RE::FormID GetFormIDArg(lua_State* L, int index);
+
+    /**
+     * Read an actor value argument, accepting either an <code>AV</code> constant (an integer) or a name.
+     *
+     * @return The actor value, or <code>RE::ActorValue::kNone</code> if it is out of range or unknown.
+     */
+    RE::ActorValue GetActorValueArg(lua_State* L, int index);
+
+    /**
+     * Mark the handles of forms deleted since the last call stale. Called once per frame; handles also apply pending
+     * deletions before using their cached pointer, so one deleted earlier in the frame is never used.
+     */
+    void ApplyFormDeletions(lua_State* L);
+
+    /**
+     * Invalidate every cached form pointer. Called on revert and load; handles re-resolve lazily.
+     */
+    void InvalidateFormHandles() noexcept;
+
+    /**
+     * Listen for form deletions so that handles to deleted forms stop using their cached pointer. Deletions may be
+     * reported from any thread and are queued for <code>ApplyFormDeletions</code>.
+     */
+    void InitializeFormHandleEvents();
+}
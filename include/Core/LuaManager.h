@@ -1,13 +1,32 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
+#include "Core/ChunkCache.h"
+#include "Core/EventBus.h"
+#include "Core/LuaCallBridge.h"
+#include "Core/LuaPersistence.h"
+#include "Core/TaskScheduler.h"
+#include "Core/TimerWheel.h"
+#include "Core/UpdateDispatcher.h"
+#include "Core/WriteBatch.h"
+
 // Forward declare lua_State to avoid including lua.h in header
 struct lua_State;
 typedef int (*LuaCFunction)(lua_State* L);
 
 namespace Sample {
+    class LuaAllocator;
+
     class LuaManager {
     public:
         // Singleton access
@@ -21,19 +40,161 @@ namespace Sample {
         bool Initialize();
         void Close();
         bool ExecuteScript(const std::string& scriptPath);
-        bool ExecuteString(const std::string& luaCode);
+        bool ExecuteString(std::string_view luaCode, const char* chunkName = "=ExecuteString");
         bool RegisterFunction(const char* name, LuaCFunction func);
         void AddPackagePath(const std::string& path);
 
+        // Bytecode cache
+        struct BytecodeCacheStats {
+            uint32_t hits = 0;
+            uint32_t misses = 0;
+            uint64_t loadMicros = 0;   // Total time spent loading chunks (cache reads and compiles)
+            uint64_t parseMicros = 0;  // Time spent in the Lua compiler on cache misses
+        };
+
+        const BytecodeCacheStats& GetBytecodeCacheStats() const { return m_bytecodeStats; }
+        void LogBytecodeCacheStats() const;
+
+        // Loads a script file through the bytecode cache, leaving the chunk (or an error message) on the stack
+        int LoadScriptFile(lua_State* L, const std::string& fullPath);
+
+        // Compiled-chunk cache used by ExecuteString
+        const ChunkCache::Stats& GetChunkCacheStats() const { return m_chunkCache.GetStats(); }
+        void SetChunkCacheCapacity(size_t capacity);
+
+        // Memory statistics from the pooled allocator backing the Lua state
+        const LuaAllocator* GetAllocator() const { return m_allocator.get(); }
+
+        // Per-frame work, driven by the main loop hook
+        void Update(float deltaTime);
+
+        // Callbacks registered through RegisterForOnUpdate
+        UpdateDispatcher& GetUpdateDispatcher() { return m_updateDispatcher; }
+
+        // Timers behind SetTimeout/SetInterval, one tick per millisecond. The payload is the callback's registry ref.
+        TimerWheel& GetTimers() { return m_timers; }
+
+        // Coroutine tasks started with StartTask
+        TaskScheduler& GetTaskScheduler() { return m_tasks; }
+
+        // Native event bus behind RegisterEvent/TriggerEvent/HookGameEvent
+        EventBus& GetEventBus() { return m_eventBus; }
+
+        // Tables registered through Persist, saved in the cosave
+        LuaPersistence& GetPersistence() { return m_persistence; }
+
+        // Cosave hooks for the persisted tables; they do nothing while the Lua state is closed
+        void SavePersistentTables(ByteWriter& out);
+        bool LoadPersistentTables(std::span<const std::byte> data, const LuaPersistence::FormResolver& resolve);
+        void RevertPersistentTables();
+
+        // Lua functions called from Papyrus natives
+        LuaCallBridge& GetCallBridge() { return m_callBridge; }
+
+        // Entry points for the Papyrus bridge; they return 0 while the Lua state is closed
+        float CallFromPapyrus(const RE::BSFixedString& function, RE::TESForm* target, std::span<const float> args);
+        void CallBatchFromPapyrus(const RE::BSFixedString& function, std::span<RE::TESForm* const> targets,
+                                  std::span<const float> args, std::vector<float>& out);
+
+        // Game-changing writes from scripts, applied at once or batched until the end of the frame
+        WriteBatch& GetWriteBatch() { return m_writeBatch; }
+
+        // Buffers the batch query bindings fill on every call, kept so a query per frame does not allocate
+        struct BatchScratch {
+            std::vector<RE::Actor*> actors;
+            std::vector<RE::TESForm*> forms;
+            std::vector<std::optional<int32_t>> counts;
+        };
+
+        BatchScratch& GetBatchScratch() { return m_batchScratch; }
+
+        // Run an event's handlers and wake the tasks waiting for it, passing the nargs values starting at firstArg
+        bool DispatchEvent(lua_State* L, std::string_view eventName, int firstArg, int nargs);
+
+        // Dispatch an event without arguments from C++
+        bool DispatchEvent(std::string_view eventName);
+
+        // Dispatch to every event whose name matches ignoring case, for names that went through a BSFixedString
+        bool DispatchEventIgnoringCase(lua_State* L, std::string_view eventName, int firstArg, int nargs);
+
+        // Time the main thread may spend draining the command queue each frame, from the [Commands] section of
+        // HelloLua.ini
+        uint32_t GetCommandBudgetMicros() const { return m_commandBudgetMicros; }
+
+        // Garbage collector scheduling, read from the [GC] section of HelloLua.ini
+        enum class GCMode { kIncremental, kGenerational };
+
+        struct GCConfig {
+            GCMode mode = GCMode::kIncremental;
+            uint32_t budgetMicros = 1000;  // Collector time each frame's slices are sized to fit
+            uint32_t stepKB = 16;          // Largest slice requested from LUA_GCSTEP
+            uint32_t pause = 200;          // Start a cycle once memory reaches this percentage of the last cycle's result
+        };
+
+        // Histogram buckets are bounded by these limits in microseconds, with a final bucket for anything longer
+        static constexpr std::array<uint32_t, 7> GCHistogramLimits = {50, 100, 250, 500, 1000, 2000, 5000};
+
+        struct GCStats {
+            uint64_t frames = 0;  // Frames in which the collector ran
+            uint64_t steps = 0;
+            uint64_t cycles = 0;
+            uint64_t totalMicros = 0;
+            uint32_t maxFrameMicros = 0;
+            uint32_t maxStepMicros = 0;
+            std::array<uint64_t, GCHistogramLimits.size() + 1> frameHistogram{};  // GC time per frame
+            std::array<uint64_t, GCHistogramLimits.size() + 1> stepHistogram{};   // Length of individual pauses
+        };
+
+        void ConfigureGC(const GCConfig& config);
+        const GCConfig& GetGCConfig() const { return m_gcConfig; }
+        const GCStats& GetGCStats() const { return m_gcStats; }
+        void LogGCStats() const;
+
     private:
-        // The Lua state
+        // The Lua state and the allocator serving it
         lua_State* m_luaState;
+        std::unique_ptr<LuaAllocator> m_allocator;
         
         // Registered script paths
         std::vector<std::string> m_scriptPaths;
 
+        // Compiled chunks are kept here, keyed by script path, size, mtime and content hash
+        std::filesystem::path m_cacheDirectory;
+        BytecodeCacheStats m_bytecodeStats;
+
+        // ExecuteString snippets compiled once and kept alive through registry references
+        ChunkCache m_chunkCache;
+
+        UpdateDispatcher m_updateDispatcher;
+        TimerWheel m_timers;
+        double m_timerRemainderMs = 0.0;
+        TaskScheduler m_tasks;
+        EventBus m_eventBus;
+        LuaPersistence m_persistence;
+        LuaCallBridge m_callBridge;
+        WriteBatch m_writeBatch;
+        BatchScratch m_batchScratch;
+
+        // Collector state; automatic pacing is turned down and StepGC does the work in budgeted slices
+        GCConfig m_gcConfig;
+        GCStats m_gcStats;
+        bool m_gcCycleActive = false;
+        int m_gcBaselineKB = 0;
+        double m_gcMicrosPerKB = 0.0;  // Recent cost of collector work, for sizing the next slice
+
+        uint32_t m_commandBudgetMicros = 2000;
+
         // Function registration
         void RegisterStandardFunctions();
         void RegisterGameFunctions();
+        void RegisterActorValueConstants();
+        void InstallCachedSearcher();
+        void ClearChunkCache();
+        void LoadConfig();
+        void ApplyGCMode();
+        void StepGC();
+        void FireTimers(float deltaTime);
+        void DispatchHitBatch();
+        void DrainCommands();
     };
 }
\ No newline at end of file
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <RE/Skyrim.h>
+
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Core/ByteBuffer.h"
+
+struct lua_State;
+
+namespace Sample {
+    /**
+     * Saves Lua tables registered with <code>Persist</code> into the cosave and restores them on load.
+     *
+     * <p>
+     * Each registered table (a "root") is encoded by a native serializer into a compact, type-tagged byte string.
+     * Integers are zigzag varints, strings are written once and then referred to by index, and every table gets an ID
+     * the first time it is reached, so shared subtables and cycles come back as the same table. Form handles are
+     * stored as FormIDs and remapped through the cosave's load order on load. Functions, coroutines, other userdata
+     * and metatables are not saved; a table entry with such a key or value is left out.
+     * </p>
+     *
+     * <p>
+     * A root's encoding is kept between saves. Roots registered with dirty tracking are only re-encoded after
+     * <code>MarkDirty</code>, so large tables that rarely change cost nothing at save time; other roots are re-encoded
+     * on every save, since changes deep inside a table cannot be seen cheaply. Tables shared between two roots are
+     * saved once per root.
+     * </p>
+     *
+     * <p>
+     * Loading refills registered tables in place, so scripts holding a reference to them see the loaded contents.
+     * Roots in the save that no script has registered yet are kept in fresh tables and handed over when a script
+     * registers the name, and they are saved again unchanged in the meantime. Reverting empties every root.
+     * </p>
+     */
+    class LuaPersistence {
+    public:
+        static constexpr std::uint32_t MaxDepth = 200;
+
+        // Maps a FormID from the save to the current load order; returns false if its plugin is gone
+        using FormResolver = std::function<bool(RE::FormID, RE::FormID&)>;
+
+        struct Stats {
+            std::uint64_t saves = 0;
+            std::uint64_t encodes = 0;  // Roots encoded at save time
+            std::uint64_t reuses = 0;   // Roots whose previous encoding was written unchanged
+            std::uint64_t skipped = 0;  // Entries left out because of an unsupported key or value
+            std::size_t lastSaveBytes = 0;
+            std::uint64_t lastSaveMicros = 0;
+            std::uint64_t lastLoadMicros = 0;
+        };
+
+        /**
+         * Register the table at <code>index</code> under <code>name</code>, replacing any earlier registration. If
+         * the name was loaded from the save before any script registered it, the loaded entries are moved into the
+         * table.
+         *
+         * @param dirtyTracking Re-encode the table only after <code>MarkDirty</code> instead of on every save.
+         */
+        void Register(lua_State* L, std::string_view name, int index, bool dirtyTracking);
+
+        /**
+         * Push the table registered under <code>name</code>, or nil.
+         */
+        void Push(lua_State* L, std::string_view name) const;
+
+        /**
+         * Flag a root for re-encoding at the next save.
+         *
+         * @return false if nothing is registered under the name.
+         */
+        bool MarkDirty(std::string_view name);
+
+        /**
+         * Encode every root into <code>out</code>.
+         */
+        void Save(lua_State* L, ByteWriter& out);
+
+        /**
+         * Refill the roots from a record written by <code>Save</code>.
+         *
+         * @return false if the record is corrupt; roots decoded before the error keep their contents.
+         */
+        bool Load(lua_State* L, std::span<const std::byte> data, const FormResolver& resolve);
+
+        /**
+         * Empty every root and forget the roots that came from a save but were never registered.
+         */
+        void Revert(lua_State* L);
+
+        /**
+         * Forget every root without releasing its reference. Used when the Lua state is closed.
+         */
+        void Clear() noexcept;
+
+        [[nodiscard]] std::size_t Size() const noexcept { return _roots.size(); }
+        [[nodiscard]] const Stats& GetStats() const noexcept { return _stats; }
+
+    private:
+        struct Root {
+            std::string name;
+            int tableRef;
+            bool registered;  // False for roots that so far only came from a save
+            bool dirtyTracking;
+            bool dirty;
+            ByteWriter encoded;
+        };
+
+        struct StringHash {
+            using is_transparent = void;
+            std::size_t operator()(std::string_view value) const noexcept {
+                return std::hash<std::string_view>{}(value);
+            }
+        };
+
+        Root* Find(std::string_view name);
+        Root& Add(lua_State* L, std::string_view name);
+
+        std::vector<Root> _roots;
+        std::unordered_map<std::string, std::size_t, StringHash, std::equal_to<>> _index;
+        Stats _stats;
+    };
+}
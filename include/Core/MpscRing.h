@@ -0,0 +1,155 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace Sample {
+    /**
+     * A bounded, lock-free, multi-producer single-consumer ring of <code>T</code>.
+     *
+     * <p>
+     * This is Dmitry Vyukov's bounded array queue. Every cell carries a sequence number that tells producers whether
+     * it is free and the consumer whether it is published, so a push is one compare-and-swap on the enqueue position
+     * plus the stores filling the cell, and never blocks. Cells are allocated once, up front, and reused in place; a
+     * push into a full ring fails and is counted as dropped. The consumer reads values in place and releases each
+     * cell when done.
+     * </p>
+     *
+     * <p>
+     * Values pushed by one producer are read in the order it pushed them. The ring knows nothing about its payload,
+     * so it is tested on its own; <code>LuaCommandQueue</code> wraps it for the Lua state.
+     * </p>
+     */
+    template <class T, std::size_t N>
+    class MpscRing {
+    public:
+        static constexpr std::size_t Capacity = N;
+        static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "The capacity must be a power of two");
+
+        MpscRing() : _cells(std::make_unique<Cell[]>(Capacity)) {
+            // A cell is free for the producer claiming position p while its sequence is p
+            for (std::size_t i = 0; i < Capacity; ++i) {
+                _cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        MpscRing(const MpscRing&) = delete;
+        MpscRing& operator=(const MpscRing&) = delete;
+
+        /**
+         * Claim a cell, fill it with <code>fill(T&)</code> and publish it. Safe from any thread.
+         *
+         * <p>
+         * The cell still holds whatever value last passed through it, so <code>fill</code> must set every field the
+         * consumer reads.
+         * </p>
+         *
+         * @return false if the ring was full and nothing was pushed.
+         */
+        template <class F>
+        bool TryPush(F&& fill) noexcept(noexcept(fill(std::declval<T&>()))) {
+            auto position = _enqueuePosition.load(std::memory_order_relaxed);
+            Cell* cell;
+            for (;;) {
+                cell = &_cells[position & Mask];
+                const auto sequence = cell->sequence.load(std::memory_order_acquire);
+                const auto difference = static_cast<std::int64_t>(sequence - position);
+                if (difference == 0) {
+                    if (_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                } else if (difference < 0) {
+                    // The cell still holds the value from one lap ago
+                    _dropped.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                } else {
+                    // Another producer claimed this position first
+                    position = _enqueuePosition.load(std::memory_order_relaxed);
+                }
+            }
+
+            fill(cell->value);
+            cell->sequence.store(position + 1, std::memory_order_release);
+            _pushed.fetch_add(1, std::memory_order_relaxed);
+
+            // The dequeue position may be stale, or already past this cell
+            const auto dequeue = std::min(position + 1, _dequeuePosition.load(std::memory_order_relaxed));
+            const auto depth = static_cast<std::uint32_t>(std::min<std::uint64_t>(position + 1 - dequeue, Capacity));
+            auto highWater = _highWater.load(std::memory_order_relaxed);
+            while (depth > highWater &&
+                   !_highWater.compare_exchange_weak(highWater, depth, std::memory_order_relaxed)) {
+            }
+            return true;
+        }
+
+        /**
+         * The oldest published value, or null if there is none. Consumer side only.
+         */
+        [[nodiscard]] T* Front() noexcept { return Peek(0); }
+        [[nodiscard]] const T* Front() const noexcept { return Peek(0); }
+
+        /**
+         * The value <code>offset</code> places behind the front, or null if it is not published yet. Consumer side
+         * only; lets the consumer read several values in place before releasing them.
+         */
+        [[nodiscard]] T* Peek(std::size_t offset) noexcept {
+            if (offset >= Capacity) {
+                return nullptr;
+            }
+            const auto position = _dequeuePosition.load(std::memory_order_relaxed) + offset;
+            auto& cell = _cells[position & Mask];
+            if (cell.sequence.load(std::memory_order_acquire) != position + 1) {
+                // Not pushed yet, or a producer has claimed the cell but not finished filling it
+                return nullptr;
+            }
+            return &cell.value;
+        }
+
+        [[nodiscard]] const T* Peek(std::size_t offset) const noexcept {
+            return const_cast<MpscRing*>(this)->Peek(offset);
+        }
+
+        /**
+         * Release the value returned by <code>Front</code> to the producers. Consumer side only.
+         */
+        void Pop() noexcept {
+            const auto position = _dequeuePosition.load(std::memory_order_relaxed);
+            _cells[position & Mask].sequence.store(position + Capacity, std::memory_order_release);
+            _dequeuePosition.store(position + 1, std::memory_order_relaxed);
+        }
+
+        /**
+         * Claimed cells not yet released, including ones still being filled.
+         */
+        [[nodiscard]] std::size_t Size() const noexcept {
+            const auto dequeue = _dequeuePosition.load(std::memory_order_relaxed);
+            const auto enqueue = _enqueuePosition.load(std::memory_order_relaxed);
+            return static_cast<std::size_t>(enqueue - std::min(enqueue, dequeue));
+        }
+
+        [[nodiscard]] std::uint64_t Pushed() const noexcept { return _pushed.load(std::memory_order_relaxed); }
+        [[nodiscard]] std::uint64_t Dropped() const noexcept { return _dropped.load(std::memory_order_relaxed); }
+
+        // Deepest the ring has been
+        [[nodiscard]] std::uint32_t HighWater() const noexcept { return _highWater.load(std::memory_order_relaxed); }
+
+    private:
+        static constexpr std::uint64_t Mask = Capacity - 1;
+
+        struct Cell {
+            std::atomic<std::uint64_t> sequence;
+            T value;
+        };
+
+        std::unique_ptr<Cell[]> _cells;
+        alignas(64) std::atomic<std::uint64_t> _enqueuePosition{0};  // Claimed by producers
+        alignas(64) std::atomic<std::uint64_t> _dequeuePosition{0};  // Written by the consumer
+        alignas(64) std::atomic<std::uint64_t> _pushed{0};
+        std::atomic<std::uint64_t> _dropped{0};
+        std::atomic<std::uint32_t> _highWater{0};
+    };
+}
@@ -5,5 +5,5 @@
 namespace Sample {
     bool RegisterHitCounter(RE::BSScript::IVirtualMachine* vm);
 
-    void InitializeHook(SKSE::Trampoline& trampoline);
+    bool RegisterLuaBridge(RE::BSScript::IVirtualMachine* vm);
 }
@@ -3,6 +3,8 @@
 #include <RE/Skyrim.h>
 #include <SKSE/SKSE.h>
 
+#include "Core/HitCounterTable.h"
+
 namespace Sample {
 #pragma warning(push)
 #pragma warning(disable : 4251)
@@ -33,6 +35,21 @@ namespace Sample {
          */
         bool UntrackActor(RE::Actor* actor);
 
+        /**
+         * Start tracking several actors at once.
+         *
+         * @param actors The actors to track; null entries are skipped.
+         * @return The number of actors that were not already being tracked.
+         */
+        std::size_t TrackActors(std::span<RE::Actor* const> actors);
+
+        /**
+         * Reset the hit counts of several actors to zero. Actors that have never been counted are left alone.
+         *
+         * @param actors The actors to reset; null entries are skipped.
+         */
+        void ResetHitCounts(std::span<RE::Actor* const> actors);
+
         /**
          * Increment the hit count for a tracked actor.
          *
@@ -49,6 +66,57 @@ namespace Sample {
          */
         std::optional<int32_t> GetHitCount(RE::Actor* target) const noexcept;
 
+        /**
+         * Gets the current hit counts for several actors.
+         *
+         * @param targets The actors whose hit counts should be returned; null entries are allowed.
+         * @param out Receives one entry per target, empty if the actor is not tracked.
+         */
+        void GetHitCounts(std::span<RE::Actor* const> targets, std::vector<std::optional<int32_t>>& out) const;
+
+        /**
+         * Gets the number of hits an actor took in a recent window.
+         *
+         * @param target The actor to query.
+         * @param seconds The length of the window, from 1 to 60 seconds.
+         * @return The hits counted in the window, including the current second so far.
+         */
+        uint32_t GetHitsInLast(RE::Actor* target, uint32_t seconds) const noexcept;
+
+        /**
+         * Gets an actor's average hits per second over a recent window.
+         *
+         * @param target The actor to query.
+         * @param seconds The length of the window, from 1 to 60 seconds.
+         */
+        float GetHitRate(RE::Actor* target, uint32_t seconds) const noexcept;
+
+        /**
+         * Gets the time since an actor's last counted hit.
+         *
+         * @param target The actor to query.
+         * @return Empty if the actor has not been hit while tracked, otherwise the time in seconds.
+         */
+        std::optional<float> GetTimeSinceLastHit(RE::Actor* target) const noexcept;
+
+        /**
+         * Gets the number of actors whose hits are being tracked.
+         */
+        std::size_t GetTrackedActorCount() const noexcept;
+
+        /**
+         * Gets the sum of the hit counts of the tracked actors.
+         */
+        int64_t GetTotalHits() const noexcept;
+
+        /**
+         * Gets the tracked actors with the most hits.
+         *
+         * @param count The maximum number of actors to return.
+         * @param out Receives the actors and their hit counts, highest first.
+         */
+        void GetTopHitActors(std::size_t count, std::vector<std::pair<RE::Actor*, int32_t>>& out) const;
+
         /**
          * Print a message to the Skyrim console.
          * 
@@ -96,7 +164,16 @@ namespace Sample {
          * @param avName The name of the actor value (e.g., "health", "stamina").
          * @param value The value to set.
          */
-        void ForceActorValue(RE::Actor* actor, const std::string& avName, float value);
+        void ForceActorValue(RE::Actor* actor, std::string_view avName, float value);
+
+        /**
+         * Force an actor value that has already been resolved to a specific amount.
+         *
+         * @param actor The actor to modify.
+         * @param av The actor value.
+         * @param value The value to set.
+         */
+        void ForceActorValue(RE::Actor* actor, RE::ActorValue av, float value);
 
         /**
          * Get the current value of an actor value.
@@ -105,7 +182,16 @@ namespace Sample {
          * @param avName The name of the actor value.
          * @return The current value.
          */
-        float GetActorValue(RE::Actor* actor, const std::string& avName) const;
+        float GetActorValue(RE::Actor* actor, std::string_view avName) const;
+
+        /**
+         * Get the current value of an actor value that has already been resolved.
+         *
+         * @param actor The actor to query.
+         * @param av The actor value.
+         * @return The current value, or 0.0 if the actor is null.
+         */
+        float GetActorValue(RE::Actor* actor, RE::ActorValue av) const;
 
         // Equipment Functions
         /**
@@ -221,13 +307,6 @@ namespace Sample {
         RE::TESForm* GetFormFromEditorID(const std::string& editorId) const;
 
         // Utility Functions
-        /**
-         * Register a Lua function to be called during the game's update loop.
-         *
-         * @param functionRef The reference to the Lua function in the registry.
-         */
-        void RegisterLuaUpdateCallback(int functionRef);
-
         /**
          * Get the distance between two actors.
          *
@@ -263,10 +342,7 @@ namespace Sample {
     private:
         SKSEManager() = default;
         
-        mutable std::recursive_mutex _lock;
-        std::unordered_set<RE::Actor*> _trackedActors;
-        std::unordered_map<RE::Actor*, int32_t> _hitCounts;
-        std::vector<int> _luaUpdateCallbacks;  // Store Lua function references for update callbacks
+        HitCounterTable _hits;
     };
 #pragma warning(pop)
 }  // namespace Sample
\ No newline at end of file
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <RE/Skyrim.h>
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace Sample {
+    /**
+     * A uniform grid over the references in the loaded cells, for proximity queries.
+     *
+     * <p>
+     * The grid is keyed by the reference's worldspace (or its parent cell, for interiors) and a 4096-unit square, the
+     * size of an exterior cell. References are added and removed as their cells attach and detach and as their 3D
+     * loads, so the index is never rebuilt for a query. Actors move on their own, so their positions are refreshed a
+     * slice at a time from the frame tick; static references only move when the game reports it.
+     * </p>
+     *
+     * <p>
+     * Closest and k-nearest queries search outwards one ring of grid squares at a time and stop as soon as no
+     * unvisited square can hold anything closer, so their cost depends on how crowded the neighbourhood is rather than
+     * on the number of references loaded. The walk never goes past the occupied squares of the space, however large
+     * the radius. All methods are thread-safe.
+     * </p>
+     */
+    class SpatialIndex {
+    public:
+        static constexpr float CellSize = 4096.0f;
+        static constexpr std::size_t RefreshPerFrame = 128;
+
+        struct Hit {
+            RE::FormID formID;
+            float distance;
+        };
+
+        struct Query {
+            RE::FormID space = 0;  // Worldspace or interior cell to search
+            RE::NiPoint3 origin;
+            float radius = 0.0f;
+            RE::FormID baseID = 0;   // Only match references to this base object, if non-zero
+            RE::FormID exclude = 0;  // Skip this reference, typically the one the query is centred on
+        };
+
+        struct Stats {
+            std::size_t references = 0;
+            std::size_t mobile = 0;
+            std::size_t cells = 0;
+            std::uint64_t queries = 0;
+            std::uint64_t refreshed = 0;
+            std::uint64_t relocated = 0;
+        };
+
+        [[nodiscard]] static SpatialIndex* GetSingleton() noexcept;
+
+        /**
+         * The worldspace of a reference, or its parent cell if it is in an interior.
+         */
+        [[nodiscard]] static RE::FormID GetSpace(const RE::TESObjectREFR* ref) noexcept;
+
+        /**
+         * Build a query centred on a reference, excluding the reference itself.
+         */
+        [[nodiscard]] static Query QueryAround(const RE::TESObjectREFR* ref, float radius, RE::FormID baseID = 0);
+
+        /**
+         * Drop everything and index the references in the currently loaded cells.
+         */
+        void Rebuild();
+
+        /**
+         * Add a reference, or move it if it is already indexed.
+         */
+        void Add(RE::TESObjectREFR* ref);
+
+        void Remove(RE::FormID formID);
+        void Clear();
+
+        /**
+         * Re-read the positions of the next slice of actors. Called once per frame.
+         */
+        void Refresh();
+
+        [[nodiscard]] std::optional<Hit> FindClosest(const Query& query) const;
+
+        /**
+         * Append every match within the query radius, closest first.
+         */
+        void FindInRadius(const Query& query, std::vector<Hit>& out) const;
+
+        /**
+         * Append the <code>count</code> closest matches within the query radius, closest first.
+         */
+        void FindNearest(const Query& query, std::size_t count, std::vector<Hit>& out) const;
+
+        [[nodiscard]] Stats GetStats() const;
+
+        /**
+         * Listen for cell attach/detach, 3D load/unload, move and deletion events to keep the index current.
+         */
+        void InitializeEvents();
+
+    private:
+        static constexpr std::uint32_t None = 0xFFFFFFFF;
+
+        struct Entry {
+            RE::TESObjectREFR* ref;
+            RE::FormID formID;
+            RE::FormID baseID;
+            RE::NiPoint3 position;
+            std::uint64_t cell;
+            std::uint32_t slotInCell;
+            std::uint32_t slotInMobile;  // None for references that are not refreshed
+        };
+
+        // The bounding box of the occupied grid squares of one space
+        struct Bounds {
+            std::int32_t minX;
+            std::int32_t minY;
+            std::int32_t maxX;
+            std::int32_t maxY;
+        };
+
+        SpatialIndex() = default;
+
+        [[nodiscard]] static std::uint64_t CellKey(RE::FormID space, std::int32_t x, std::int32_t y) noexcept;
+        [[nodiscard]] static std::int32_t CellCoordinate(float value) noexcept;
+
+        [[nodiscard]] static std::int32_t KeyX(std::uint64_t key) noexcept;
+        [[nodiscard]] static std::int32_t KeyY(std::uint64_t key) noexcept;
+
+        void Place(std::uint32_t index, std::uint64_t key);
+        void Unplace(std::uint32_t index);
+        void RemoveIndex(std::uint32_t index);
+        // Shrink the bounds of a space after one of its squares was emptied
+        void UpdateBounds(std::uint64_t emptied);
+
+        // Calls visit(hit) for every match in one grid square
+        template <class F>
+        void VisitCell(const Query& query, std::uint64_t key, F&& visit) const;
+
+        // Walks the grid squares in rings around the origin, out to the radius or the edge of the occupied squares. For
+        // each ring, calls visitRing(nearest, scan), where nearest is a lower bound on the distance of anything in the
+        // ring and scan(visit) visits its matches; visitRing returns false to stop the search. If exhaustive, the
+        // caller visits every ring anyway, so a radius covering more squares than are occupied scans the occupied
+        // ones in a single call instead.
+        template <class F>
+        void Search(const Query& query, bool exhaustive, F&& visitRing) const;
+
+        mutable std::mutex _lock;
+        std::vector<Entry> _entries;
+        std::vector<std::uint32_t> _freeEntries;
+        std::unordered_map<RE::FormID, std::uint32_t> _byFormID;
+        std::unordered_map<std::uint64_t, std::vector<std::uint32_t>> _cells;
+        std::unordered_map<RE::FormID, Bounds> _bounds;
+        std::vector<std::uint32_t> _mobile;
+        std::size_t _refreshCursor = 0;
+        mutable Stats _stats;
+    };
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Core/TimerWheel.h"
+
+struct lua_State;
+
+namespace Sample {
+    /**
+     * Runs Lua functions as coroutine tasks that can suspend on native wait queues.
+     *
+     * <p>
+     * A task started with <code>StartTask</code> can call <code>Wait(seconds)</code>, <code>WaitFrames(n)</code> or
+     * <code>WaitForEvent(name)</code>. Each of these records the task in a native queue and yields; the per-frame tick
+     * resumes only the tasks whose wait is over, so thousands of sleeping tasks cost nothing until they wake. Time
+     * and frame waits sit in timing wheels, event waits in per-event lists.
+     * </p>
+     *
+     * <p>
+     * Coroutine threads of tasks that return normally go back to a pool and are reused by the next
+     * <code>StartTask</code>, so spawning does not allocate once the pool is warm. Threads of tasks that fail are
+     * dropped, since Lua cannot resume a thread after an error.
+     * </p>
+     */
+    class TaskScheduler {
+    public:
+        static constexpr std::size_t MaxPooledThreads = 1024;
+
+        struct Stats {
+            std::uint64_t spawned = 0;
+            std::uint64_t completed = 0;
+            std::uint64_t failed = 0;
+            std::uint64_t resumes = 0;
+            std::size_t pooled = 0;
+            std::size_t suspended = 0;
+        };
+
+        /**
+         * Start a task. The function and its <code>nargs</code> arguments must be on top of the stack of
+         * <code>L</code>; they are moved to the task's thread, which runs until its first wait.
+         */
+        void Spawn(lua_State* L, int nargs);
+
+        /**
+         * Record a wait for the task running on <code>thread</code>. The caller must yield right after.
+         *
+         * @return false if <code>thread</code> is not a task that can yield.
+         */
+        bool WaitSeconds(lua_State* thread, double seconds);
+        bool WaitFrames(lua_State* thread, std::uint32_t frames);
+        bool WaitForEvent(lua_State* thread, std::string_view eventName);
+
+        /**
+         * Resume every task waiting for an event, passing it the <code>nargs</code> values starting at stack index
+         * <code>firstArg</code> of <code>L</code>.
+         *
+         * @return The number of tasks resumed.
+         */
+        std::size_t SignalEvent(lua_State* L, std::string_view eventName, int firstArg, int nargs);
+
+        /**
+         * Whether any task is waiting for an event.
+         */
+        [[nodiscard]] bool HasWaiters(std::string_view eventName) const;
+
+        /**
+         * Resume the tasks whose time or frame wait has elapsed.
+         */
+        void Tick(lua_State* L, float deltaTime);
+
+        /**
+         * Forget every task. Used when the Lua state is closed, which releases the threads itself.
+         */
+        void Clear() noexcept;
+
+        [[nodiscard]] Stats GetStats() const noexcept;
+
+    private:
+        struct Task {
+            lua_State* thread;
+            int threadRef;
+            bool waiting;  // Set by the Wait functions, cleared when the task resumes
+        };
+
+        struct StringHash {
+            using is_transparent = void;
+            std::size_t operator()(std::string_view value) const noexcept {
+                return std::hash<std::string_view>{}(value);
+            }
+        };
+
+        std::uint32_t Acquire(lua_State* L);
+        void Resume(lua_State* L, std::uint32_t index, int nargs);
+        void Retire(lua_State* L, std::uint32_t index);
+        [[nodiscard]] std::optional<std::uint32_t> FindYieldableTask(lua_State* thread) const;
+
+        std::vector<Task> _tasks;
+        std::vector<std::uint32_t> _pooled;     // Finished tasks whose threads can be reused
+        std::vector<std::uint32_t> _freeSlots;  // Task slots whose threads were dropped
+        std::unordered_map<lua_State*, std::uint32_t> _taskByThread;
+
+        TimerWheel _sleeping;       // One tick per millisecond
+        TimerWheel _waitingFrames;  // One tick per frame
+        double _remainderMs = 0.0;
+        std::unordered_map<std::string, std::vector<std::uint32_t>, StringHash, std::equal_to<>> _waitingEvents;
+
+        std::vector<std::uint32_t> _ready;
+        std::vector<std::uint32_t> _resuming;
+        Stats _stats;
+    };
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace Sample {
+    /**
+     * A hierarchical timing wheel.
+     *
+     * <p>
+     * Four levels of 256 slots cover delays of up to 2^32 ticks. A timer sits in the level whose span matches its
+     * remaining delay and is moved one level down each time the level below wraps around, so inserting and cancelling
+     * are O(1) and advancing only touches the slot for the current tick (plus an occasional cascade). Pending timers
+     * that are not due cost nothing per tick.
+     * </p>
+     *
+     * <p>
+     * Timer IDs pack a node index with a generation counter, so a stale ID of a timer that already fired or was
+     * cancelled is rejected even after its node has been reused. Each timer carries an opaque 32-bit payload.
+     * </p>
+     */
+    class TimerWheel {
+    public:
+        using TimerId = std::uint64_t;
+
+        static constexpr unsigned LevelBits = 8;
+        static constexpr unsigned Levels = 4;
+        static constexpr unsigned SlotsPerLevel = 1u << LevelBits;
+        static constexpr std::uint64_t MaxDelay = (std::uint64_t{1} << (LevelBits * Levels)) - 1;
+
+        /**
+         * Schedule a timer.
+         *
+         * @param delay Ticks until the timer first fires; zero is rounded up to the next tick.
+         * @param interval Ticks between repeats, or zero for a one-shot timer.
+         * @param payload Value handed back when the timer fires.
+         * @return The ID used to cancel the timer.
+         */
+        TimerId Schedule(std::uint64_t delay, std::uint64_t interval, std::uint32_t payload);
+
+        /**
+         * Cancel a pending timer.
+         *
+         * @param id The timer to cancel.
+         * @param payload Receives the timer's payload if it was cancelled.
+         * @return true if the ID referred to a pending timer.
+         */
+        bool Cancel(TimerId id, std::uint32_t* payload = nullptr);
+
+        /**
+         * Advance the wheel, calling <code>onExpired(id, payload, repeating)</code> for every timer that comes due.
+         *
+         * <p>
+         * One-shot timers are released before their callback runs; repeating timers are already re-armed. The
+         * callback may schedule and cancel timers, including the one that is firing.
+         * </p>
+         */
+        template <class F>
+        void Advance(std::uint64_t ticks, F&& onExpired);
+
+        /**
+         * Drop every timer without firing it.
+         */
+        void Clear() noexcept;
+
+        [[nodiscard]] std::size_t Size() const noexcept { return _count; }
+        [[nodiscard]] std::uint64_t Now() const noexcept { return _now; }
+
+    private:
+        static constexpr std::uint32_t Nil = std::numeric_limits<std::uint32_t>::max();
+
+        struct Node {
+            std::uint64_t expiry;
+            std::uint64_t interval;
+            std::uint32_t payload;
+            std::uint32_t generation;
+            std::uint32_t prev;
+            std::uint32_t next;
+            std::uint32_t slot;
+            bool active;
+        };
+
+        [[nodiscard]] static TimerId MakeId(std::uint32_t index, std::uint32_t generation) noexcept {
+            return (static_cast<TimerId>(generation) << 32) | index;
+        }
+
+        void Link(std::uint32_t index) noexcept;
+        void Unlink(std::uint32_t index) noexcept;
+        void Release(std::uint32_t index);
+        void Cascade(unsigned level, unsigned slot) noexcept;
+
+        std::vector<Node> _nodes;
+        std::vector<std::uint32_t> _freeNodes;
+        std::array<std::uint32_t, Levels * SlotsPerLevel> _slots = MakeEmptySlots();
+        std::uint64_t _now = 0;
+        std::size_t _count = 0;
+
+        static constexpr std::array<std::uint32_t, Levels * SlotsPerLevel> MakeEmptySlots() {
+            std::array<std::uint32_t, Levels * SlotsPerLevel> slots{};
+            slots.fill(Nil);
+            return slots;
+        }
+    };
+
+    template <class F>
+    void TimerWheel::Advance(std::uint64_t ticks, F&& onExpired) {
+        for (std::uint64_t tick = 0; tick < ticks; ++tick) {
+            ++_now;
+            const auto slot = static_cast<unsigned>(_now & (SlotsPerLevel - 1));
+
+            // Each time a level wraps, pull the matching slot of the next level down
+            if (slot == 0) {
+                for (unsigned level = 1; level < Levels; ++level) {
+                    const auto upper = static_cast<unsigned>((_now >> (LevelBits * level)) & (SlotsPerLevel - 1));
+                    Cascade(level, upper);
+                    if (upper != 0) {
+                        break;
+                    }
+                }
+            }
+
+            // Everything left in this level-0 slot expires now; re-read the head since callbacks may change the list
+            while (_slots[slot] != Nil) {
+                const std::uint32_t index = _slots[slot];
+                Unlink(index);
+
+                auto& node = _nodes[index];
+                const TimerId id = MakeId(index, node.generation);
+                const std::uint32_t payload = node.payload;
+                const bool repeating = node.interval != 0;
+                if (repeating) {
+                    node.expiry = _now + node.interval;
+                    Link(index);
+                } else {
+                    Release(index);
+                }
+
+                onExpired(id, payload, repeating);
+            }
+        }
+    }
+}
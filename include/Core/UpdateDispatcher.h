@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+struct lua_State;
+
+namespace Sample {
+    /**
+     * Calls the Lua functions registered through <code>RegisterForOnUpdate</code> from the per-frame tick.
+     *
+     * <p>
+     * Each callback runs on an update-rate tier: every frame, every Nth frame, or at most once every N milliseconds.
+     * Callbacks on the every-Nth-frame tier are phase-shifted by their handle so that a group registered together is
+     * spread across frames instead of all landing on the same one. Callbacks receive the time elapsed since they last
+     * ran, are timed individually, and are dropped (and their registry reference released) the first time they raise
+     * an error.
+     * </p>
+     */
+    class UpdateDispatcher {
+    public:
+        enum class Tier : std::uint8_t { kEveryFrame, kEveryNFrames, kInterval };
+
+        struct Callback {
+            std::uint32_t handle;
+            int functionRef;
+            Tier tier;
+            std::uint32_t period;  // Frames for kEveryNFrames, milliseconds for kInterval
+            std::uint32_t phase;
+            float elapsed = 0.0f;  // Time accumulated since the callback last ran
+            std::uint64_t calls = 0;
+            std::uint64_t totalMicros = 0;
+            std::uint32_t maxMicros = 0;
+            bool removed = false;
+        };
+
+        /**
+         * Register a function already stored in the Lua registry.
+         *
+         * @return The handle used to unregister the callback.
+         */
+        std::uint32_t Register(int functionRef, Tier tier, std::uint32_t period);
+
+        /**
+         * Unregister a callback and release its registry reference. Safe to call from inside a callback.
+         *
+         * @return true if the handle referred to a live callback.
+         */
+        bool Unregister(lua_State* L, std::uint32_t handle);
+
+        /**
+         * Run every callback that is due this frame.
+         */
+        void Dispatch(lua_State* L, float deltaTime);
+
+        /**
+         * Forget every callback. Used when the Lua state is closed, which releases the references itself.
+         */
+        void Clear() noexcept;
+
+        [[nodiscard]] const std::vector<Callback>& GetCallbacks() const noexcept { return _callbacks; }
+
+    private:
+        std::vector<Callback> _callbacks;
+        std::uint64_t _frame = 0;
+        std::uint32_t _nextHandle = 1;
+        bool _dispatching = false;
+    };
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <RE/Skyrim.h>
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Sample {
+    /**
+     * Routes the Lua bindings that change the game (actor values, equipment, weather) to the engine, either at once or
+     * batched until the end of the frame.
+     *
+     * <p>
+     * In the default immediate mode each write is applied as it is issued. In deferred mode, which scripts turn on
+     * with <code>SetDeferredWrites(true)</code>, writes are recorded instead, keyed by target, kind and key: the actor
+     * and actor value, the actor and item, or the sky. A later write to the same key replaces the pending one (last
+     * writer wins), and an equip and an unequip of the same item on the same actor cancel each other, so a script
+     * toggling gear in a loop costs nothing. The surviving writes are applied in one pass, in the order their keys
+     * were first written (a key written again after its pair cancelled counts as new), when
+     * <code>LuaManager::Update</code> ends its frame.
+     * </p>
+     *
+     * <p>
+     * Deferred writes only check their arguments when recorded; whether the engine accepts them is only known at the
+     * flush, so the bindings return true for any write they record. Cancelling assumes the first write of a pair
+     * would have changed the item's state: a script that unequips an item that is not worn and then equips it in the
+     * same frame should use immediate mode. Main thread only.
+     * </p>
+     *
+     * <p>
+     * Writes reach the engine through the applier the batch is constructed with; <code>LuaManager</code> passes one
+     * that resolves the FormIDs and calls <code>SKSEManager</code>.
+     * </p>
+     */
+    class WriteBatch {
+    public:
+        enum class Op : std::uint8_t { kNone, kActorValue, kEquip, kUnequip, kWeather };
+
+        struct Write {
+            Op op;  // kNone once cancelled
+            bool preventRemoval;
+            bool silent;
+            RE::FormID target;  // The actor, or the weather for kWeather
+            std::uint32_t key;  // The actor value or the item
+            float value;
+        };
+
+        // Applies one write to the engine; returns false if the engine rejected it
+        using Applier = std::function<bool(const Write&)>;
+
+        struct Stats {
+            std::uint64_t issued = 0;     // Writes made by scripts, in either mode
+            std::uint64_t applied = 0;    // Writes that reached the engine
+            std::uint64_t coalesced = 0;  // Pending writes replaced by a later write to the same key
+            std::uint64_t cancelled = 0;  // Equip and unequip pairs dropped
+            std::uint64_t flushes = 0;    // Flushes that found writes pending
+        };
+
+        explicit WriteBatch(Applier apply) : _apply(std::move(apply)) {}
+
+        [[nodiscard]] bool IsDeferred() const noexcept { return _deferred; }
+
+        /**
+         * Switch between immediate and deferred mode. Leaving deferred mode applies everything pending.
+         */
+        void SetDeferred(bool deferred);
+
+        bool SetActorValue(RE::Actor* actor, RE::ActorValue av, float value);
+        bool EquipItem(RE::Actor* actor, RE::TESForm* item, bool preventRemoval, bool silent);
+        bool UnequipItem(RE::Actor* actor, RE::TESForm* item, bool silent);
+        bool ForceWeather(RE::TESWeather* weather);
+
+        /**
+         * Apply every pending write, in the order their keys were first written.
+         */
+        void Flush();
+
+        /**
+         * Drop every pending write without applying it. Used when the Lua state is closed.
+         */
+        void Clear() noexcept;
+
+        [[nodiscard]] std::size_t Size() const noexcept { return _slots.size(); }
+        [[nodiscard]] const Stats& GetStats() const noexcept { return _stats; }
+
+    private:
+        // Equip and unequip share a slot, and there is a single weather slot
+        struct Slot {
+            std::uint8_t kind;
+            RE::FormID target;
+            std::uint32_t key;
+
+            bool operator==(const Slot&) const noexcept = default;
+        };
+
+        struct SlotHash {
+            std::size_t operator()(const Slot& slot) const noexcept {
+                return std::hash<std::uint64_t>{}((static_cast<std::uint64_t>(slot.target) << 32 | slot.key) ^
+                                                  (static_cast<std::uint64_t>(slot.kind) << 61));
+            }
+        };
+
+        [[nodiscard]] static Slot GetSlot(const Write& write) noexcept;
+
+        bool Issue(const Write& write);
+        bool Apply(const Write& write);
+
+        Applier _apply;
+        std::vector<Write> _writes;
+        std::unordered_map<Slot, std::size_t, SlotHash> _slots;  // Index of each live write in _writes
+        Stats _stats;
+        bool _deferred = false;
+    };
+}
@@ -0,0 +1,149 @@
+#include "Core/ActorValues.h"
+
+#include <array>
+#include <cstdint>
+
+using namespace RE;
+using namespace Sample;
+
+namespace {
+    constexpr ActorValueName Names[] = {
+        {"Aggression", ActorValue::kAggression},
+        {"Confidence", ActorValue::kConfidence},
+        {"Energy", ActorValue::kEnergy},
+        {"Morality", ActorValue::kMorality},
+        {"Mood", ActorValue::kMood},
+        {"Assistance", ActorValue::kAssistance},
+        {"OneHanded", ActorValue::kOneHanded},
+        {"TwoHanded", ActorValue::kTwoHanded},
+        {"Marksman", ActorValue::kArchery},
+        {"Block", ActorValue::kBlock},
+        {"Smithing", ActorValue::kSmithing},
+        {"HeavyArmor", ActorValue::kHeavyArmor},
+        {"LightArmor", ActorValue::kLightArmor},
+        {"Pickpocket", ActorValue::kPickpocket},
+        {"Lockpicking", ActorValue::kLockpicking},
+        {"Sneak", ActorValue::kSneak},
+        {"Alchemy", ActorValue::kAlchemy},
+        {"Speechcraft", ActorValue::kSpeech},
+        {"Alteration", ActorValue::kAlteration},
+        {"Conjuration", ActorValue::kConjuration},
+        {"Destruction", ActorValue::kDestruction},
+        {"Illusion", ActorValue::kIllusion},
+        {"Restoration", ActorValue::kRestoration},
+        {"Enchanting", ActorValue::kEnchanting},
+        {"Health", ActorValue::kHealth},
+        {"Magicka", ActorValue::kMagicka},
+        {"Stamina", ActorValue::kStamina},
+        {"HealRate", ActorValue::kHealRate},
+        {"MagickaRate", ActorValue::kMagickaRate},
+        {"StaminaRate", ActorValue::kStaminaRate},
+        {"SpeedMult", ActorValue::kSpeedMult},
+        {"InventoryWeight", ActorValue::kInventoryWeight},
+        {"CarryWeight", ActorValue::kCarryWeight},
+        {"CritChance", ActorValue::kCriticalChance},
+        {"MeleeDamage", ActorValue::kMeleeDamage},
+        {"UnarmedDamage", ActorValue::kUnarmedDamage},
+        {"Mass", ActorValue::kMass},
+        {"VoicePoints", ActorValue::kVoicePoints},
+        {"VoiceRate", ActorValue::kVoiceRate},
+        {"DamageResist", ActorValue::kDamageResist},
+        {"PoisonResist", ActorValue::kPoisonResist},
+        {"FireResist", ActorValue::kResistFire},
+        {"ElectricResist", ActorValue::kResistShock},
+        {"FrostResist", ActorValue::kResistFrost},
+        {"MagicResist", ActorValue::kResistMagic},
+        {"DiseaseResist", ActorValue::kResistDisease},
+
+        // Names used by the Creation Kit UI, SKSE and other script extenders
+        {"Archery", ActorValue::kArchery},
+        {"Speech", ActorValue::kSpeech},
+        {"Lockpick", ActorValue::kLockpicking},
+        {"CriticalChance", ActorValue::kCriticalChance},
+        {"ShockResist", ActorValue::kResistShock},
+        {"ResistFire", ActorValue::kResistFire},
+        {"ResistShock", ActorValue::kResistShock},
+        {"ResistFrost", ActorValue::kResistFrost},
+        {"ResistMagic", ActorValue::kResistMagic},
+        {"ResistDisease", ActorValue::kResistDisease},
+        {"ResistPoison", ActorValue::kPoisonResist},
+        {"Armor", ActorValue::kDamageResist},
+        {"HealthRate", ActorValue::kHealRate},
+    };
+
+    constexpr std::size_t TableSize = 256;  // Power of two, kept under a quarter full so probes stay short
+    static_assert(std::size(Names) * 4 <= TableSize);
+
+    constexpr char ToLower(char c) noexcept {
+        return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    constexpr std::uint32_t HashLower(std::string_view value) noexcept {
+        std::uint32_t hash = 2166136261u;
+        for (const char c : value) {
+            hash ^= static_cast<std::uint8_t>(ToLower(c));
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    constexpr bool EqualsIgnoreCase(std::string_view left, std::string_view right) noexcept {
+        if (left.size() != right.size()) {
+            return false;
+        }
+        for (std::size_t i = 0; i < left.size(); ++i) {
+            if (ToLower(left[i]) != ToLower(right[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Slot -> index into Names, or -1 for an empty slot
+    constexpr auto BuildTable() {
+        std::array<std::int16_t, TableSize> table{};
+        table.fill(-1);
+        for (std::size_t i = 0; i < std::size(Names); ++i) {
+            auto slot = HashLower(Names[i].name) & (TableSize - 1);
+            while (table[slot] != -1) {
+                slot = (slot + 1) & (TableSize - 1);
+            }
+            table[slot] = static_cast<std::int16_t>(i);
+        }
+        return table;
+    }
+
+    constexpr bool HasUniqueNames() {
+        for (std::size_t i = 0; i < std::size(Names); ++i) {
+            for (std::size_t j = i + 1; j < std::size(Names); ++j) {
+                if (EqualsIgnoreCase(Names[i].name, Names[j].name)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    static_assert(HasUniqueNames(), "actor value names must be unique ignoring case");
+
+    constexpr auto Table = BuildTable();
+}
+
+ActorValue Sample::LookupActorValue(std::string_view name) noexcept {
+    for (auto slot = HashLower(name) & (TableSize - 1);; slot = (slot + 1) & (TableSize - 1)) {
+        const auto index = Table[slot];
+        if (index < 0) {
+            break;
+        }
+        if (EqualsIgnoreCase(Names[index].name, name)) {
+            return Names[index].value;
+        }
+    }
+
+    auto* avList = ActorValueList::GetSingleton();
+    return avList ? avList->LookupActorValueByName(name) : ActorValue::kNone;
+}
+
+std::span<const ActorValueName> Sample::GetActorValueNames() noexcept {
+    return Names;
+}
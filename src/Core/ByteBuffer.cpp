@@ -0,0 +1,39 @@
+#include "Core/ByteBuffer.h"
+
+using namespace Sample;
+
+void ByteWriter::WriteVarUInt(std::uint64_t value) {
+    while (value >= 0x80) {
+        _bytes.push_back(static_cast<std::byte>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    _bytes.push_back(static_cast<std::byte>(value));
+}
+
+void ByteWriter::WriteVarInt(std::int64_t value) {
+    WriteVarUInt((static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+}
+
+bool ByteReader::ReadVarUInt(std::uint64_t& value) noexcept {
+    value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        if (_offset >= _bytes.size()) {
+            return false;
+        }
+        const auto byte = static_cast<std::uint8_t>(_bytes[_offset++]);
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;  // More than ten bytes: not a varint this writer produced
+}
+
+bool ByteReader::ReadVarInt(std::int64_t& value) noexcept {
+    std::uint64_t encoded;
+    if (!ReadVarUInt(encoded)) {
+        return false;
+    }
+    value = static_cast<std::int64_t>(encoded >> 1) ^ -static_cast<std::int64_t>(encoded & 1);
+    return true;
+}
@@ -0,0 +1,67 @@
+#include "Core/ChunkCache.h"
+#include "Core/Hash.h"
+
+extern "C" {
+#include <lua.h>
+#include <lauxlib.h>
+}
+
+namespace Sample {
+
+    bool ChunkCache::Push(lua_State* L, std::string_view source, const char* chunkName) {
+        const std::string_view name = chunkName ? chunkName : "";
+        const std::uint64_t hash = HashBytes(name, HashBytes(source));
+        auto found = _index.find(hash);
+        if (found != _index.end() && found->second->source == source && found->second->chunkName == name) {
+            _lru.splice(_lru.begin(), _lru, found->second);
+            ++_stats.hits;
+            lua_rawgeti(L, LUA_REGISTRYINDEX, found->second->functionRef);
+            return true;
+        }
+
+        ++_stats.misses;
+        if (luaL_loadbuffer(L, source.data(), source.size(), chunkName) != LUA_OK) {
+            return false;
+        }
+
+        // A different snippet with the same hash gives up its slot
+        if (found != _index.end()) {
+            luaL_unref(L, LUA_REGISTRYINDEX, found->second->functionRef);
+            _lru.erase(found->second);
+            _index.erase(found);
+        }
+        if (_capacity == 0) {
+            return true;
+        }
+        while (_lru.size() >= _capacity) {
+            EvictOldest(L);
+        }
+
+        lua_pushvalue(L, -1);
+        const int functionRef = luaL_ref(L, LUA_REGISTRYINDEX);
+        _lru.push_front({hash, std::string(source), std::string(name), functionRef});
+        _index.emplace(hash, _lru.begin());
+        return true;
+    }
+
+    void ChunkCache::SetCapacity(lua_State* L, std::size_t capacity) {
+        _capacity = capacity;
+        while (_lru.size() > _capacity) {
+            EvictOldest(L);
+        }
+    }
+
+    void ChunkCache::Clear() noexcept {
+        _lru.clear();
+        _index.clear();
+    }
+
+    void ChunkCache::EvictOldest(lua_State* L) {
+        if (L) {
+            luaL_unref(L, LUA_REGISTRYINDEX, _lru.back().functionRef);
+        }
+        _index.erase(_lru.back().hash);
+        _lru.pop_back();
+        ++_stats.evictions;
+    }
+}
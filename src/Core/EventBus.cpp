@@ -0,0 +1,134 @@
+#include "Core/EventBus.h"
+
+extern "C" {
+#include <lua.h>
+#include <lauxlib.h>
+}
+
+#include <SKSE/SKSE.h>
+
+#include <algorithm>
+#include <cctype>
+
+namespace Sample {
+
+    static std::string ToLowercase(std::string_view name) {
+        std::string lowercase(name);
+        std::transform(lowercase.begin(), lowercase.end(), lowercase.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return lowercase;
+    }
+
+    EventBus::EventId EventBus::Intern(std::string_view name) {
+        if (const auto id = Find(name)) {
+            return *id;
+        }
+        const auto id = static_cast<EventId>(_events.size());
+        _events.emplace_back().name = name;
+        _ids.emplace(std::string(name), id);
+        _idsByLowercase[ToLowercase(name)].push_back(id);
+        return id;
+    }
+
+    std::optional<EventBus::EventId> EventBus::Find(std::string_view name) const {
+        const auto found = _ids.find(name);
+        if (found == _ids.end()) {
+            return std::nullopt;
+        }
+        return found->second;
+    }
+
+    void EventBus::FindIgnoringCase(std::string_view name, std::vector<EventId>& out) const {
+        const auto found = _idsByLowercase.find(ToLowercase(name));
+        if (found != _idsByLowercase.end()) {
+            out.insert(out.end(), found->second.begin(), found->second.end());
+        }
+    }
+
+    std::uint32_t EventBus::Subscribe(EventId id, int functionRef) {
+        auto& event = _events[id];
+        const std::uint32_t handle = _nextHandle++;
+        _handlers.emplace(handle, HandlerLocation{id, static_cast<std::uint32_t>(event.handlers.size())});
+        event.handlers.push_back({handle, functionRef});
+        ++event.liveHandlers;
+        return handle;
+    }
+
+    bool EventBus::Unsubscribe(lua_State* L, std::uint32_t handle) {
+        const auto found = _handlers.find(handle);
+        if (found == _handlers.end()) {
+            return false;
+        }
+
+        const auto [id, index] = found->second;
+        _handlers.erase(found);
+
+        auto& event = _events[id];
+        luaL_unref(L, LUA_REGISTRYINDEX, event.handlers[index].functionRef);
+        event.handlers[index].functionRef = LUA_NOREF;
+        --event.liveHandlers;
+        event.needsCompaction = true;
+
+        // Blanked entries wait for the next dispatch, which walks the array anyway, unless they start to outnumber
+        // the live ones. Either way each removal costs O(1) amortized.
+        const auto blanked = event.handlers.size() - event.liveHandlers;
+        if (event.dispatchDepth == 0 && blanked > event.liveHandlers) {
+            Compact(id);
+        }
+        return true;
+    }
+
+    std::size_t EventBus::Dispatch(lua_State* L, EventId id, int firstArg, int nargs) {
+        ++_stats.dispatches;
+        ++_events[id].dispatchDepth;
+
+        // Index rather than hold references: handlers may intern new events or subscribe, reallocating either array
+        std::size_t called = 0;
+        const std::size_t count = _events[id].handlers.size();
+        for (std::size_t i = 0; i < count; ++i) {
+            const int functionRef = _events[id].handlers[i].functionRef;
+            if (functionRef == LUA_NOREF) {
+                continue;
+            }
+
+            lua_rawgeti(L, LUA_REGISTRYINDEX, functionRef);
+            for (int arg = 0; arg < nargs; ++arg) {
+                lua_pushvalue(L, firstArg + arg);
+            }
+            ++called;
+            if (lua_pcall(L, nargs, 0, 0) != LUA_OK) {
+                ++_stats.handlerErrors;
+                SKSE::log::error("Error in event handler for {}: {}", _events[id].name, lua_tostring(L, -1));
+                lua_pop(L, 1);  // pop error message
+            }
+        }
+        _stats.handlerCalls += called;
+
+        auto& event = _events[id];
+        if (--event.dispatchDepth == 0 && event.needsCompaction) {
+            Compact(id);
+        }
+        return called;
+    }
+
+    void EventBus::Clear() noexcept {
+        _events.clear();
+        _ids.clear();
+        _idsByLowercase.clear();
+        _handlers.clear();
+    }
+
+    void EventBus::Compact(EventId id) {
+        auto& event = _events[id];
+        std::uint32_t kept = 0;
+        for (const auto& handler : event.handlers) {
+            if (handler.functionRef == LUA_NOREF) {
+                continue;
+            }
+            _handlers[handler.handle].index = kept;
+            event.handlers[kept++] = handler;
+        }
+        event.handlers.resize(kept);
+        event.needsCompaction = false;
+    }
+}
@@ -0,0 +1,251 @@
+#include "Core/FormIndex.h"
+
+#include <SKSE/SKSE.h>
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <thread>
+
+using namespace RE;
+using namespace Sample;
+
+namespace {
+    constexpr std::size_t MaxThreads = 8;
+    constexpr std::size_t MinFormsPerThread = 4096;
+
+    struct EditorSource {
+        const char* editorID;
+        FormID formID;
+    };
+
+    constexpr char ToLower(char c) noexcept {
+        return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    // FNV-1a over the lowercase form of the string, so queries need not be copied to be hashed
+    std::uint32_t HashLower(std::string_view value) noexcept {
+        std::uint32_t hash = 2166136261u;
+        for (const char c : value) {
+            hash ^= static_cast<std::uint8_t>(ToLower(c));
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    // Compares a lowercase key from the arena with a query in any case
+    bool EqualsLower(std::string_view lowered, std::string_view query) noexcept {
+        if (lowered.size() != query.size()) {
+            return false;
+        }
+        for (std::size_t i = 0; i < query.size(); ++i) {
+            if (lowered[i] != ToLower(query[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::uint32_t AppendLower(std::vector<char>& arena, std::string_view value) {
+        const auto offset = static_cast<std::uint32_t>(arena.size());
+        for (const char c : value) {
+            arena.push_back(ToLower(c));
+        }
+        return offset;
+    }
+}
+
+FormIndex* FormIndex::GetSingleton() noexcept {
+    static FormIndex instance;
+    return &instance;
+}
+
+void FormIndex::Build() {
+    const auto start = std::chrono::steady_clock::now();
+
+    // Snapshot the game's maps under their locks; the expensive per-form work happens afterwards, off the lock
+    std::vector<EditorSource> editorSources;
+    std::vector<TESForm*> forms;
+    {
+        const auto [map, lock] = TESForm::GetAllFormsByEditorID();
+        BSReadLockGuard locker{lock};
+        if (map) {
+            editorSources.reserve(map->size());
+            for (auto& [editorID, form] : *map) {
+                if (form && !editorID.empty()) {
+                    editorSources.push_back({editorID.c_str(), form->GetFormID()});
+                }
+            }
+        }
+    }
+    {
+        const auto [map, lock] = TESForm::GetAllForms();
+        BSReadLockGuard locker{lock};
+        if (map) {
+            forms.reserve(map->size());
+            for (auto& [formID, form] : *map) {
+                // References share their base object's name, so only base forms go into the name table
+                if (form && !form->IsReference()) {
+                    forms.push_back(form);
+                }
+            }
+        }
+    }
+
+    const std::size_t total = std::max(editorSources.size(), forms.size());
+    const std::size_t threadCount = std::clamp<std::size_t>(
+        std::min<std::size_t>(std::thread::hardware_concurrency(), total / MinFormsPerThread + 1), 1, MaxThreads);
+
+    std::vector<Shard> shards(threadCount);
+    auto scan = [&](std::size_t shardIndex) {
+        auto& shard = shards[shardIndex];
+        const auto range = [&](std::size_t count) {
+            return std::pair{count * shardIndex / threadCount, count * (shardIndex + 1) / threadCount};
+        };
+
+        const auto [editorBegin, editorEnd] = range(editorSources.size());
+        shard.editorIDs.reserve(editorEnd - editorBegin);
+        for (auto i = editorBegin; i < editorEnd; ++i) {
+            const std::string_view editorID = editorSources[i].editorID;
+            const auto offset = AppendLower(shard.arena, editorID);
+            shard.editorIDs.push_back({{offset, static_cast<std::uint32_t>(editorID.size())}, editorSources[i].formID});
+        }
+
+        const auto [formBegin, formEnd] = range(forms.size());
+        for (auto i = formBegin; i < formEnd; ++i) {
+            const char* name = forms[i]->GetName();
+            if (!name || !*name) {
+                continue;
+            }
+            const std::string_view view = name;
+            const auto offset = AppendLower(shard.arena, view);
+            shard.names.push_back({{offset, static_cast<std::uint32_t>(view.size())}, forms[i]->GetFormID()});
+        }
+
+        // Sorting per shard lets the merge combine already sorted runs
+        const auto* arena = shard.arena.data();
+        std::ranges::sort(shard.names, {}, [arena](const NameEntry& entry) {
+            return std::string_view{arena + entry.name.offset, entry.name.length};
+        });
+    };
+
+    {
+        std::vector<std::jthread> workers;
+        workers.reserve(threadCount - 1);
+        for (std::size_t i = 1; i < threadCount; ++i) {
+            workers.emplace_back(scan, i);
+        }
+        scan(0);
+    }
+
+    Merge(shards);
+
+    _stats.formsScanned = forms.size();
+    _stats.editorIDs = editorSources.size();
+    _stats.names = _names.size();
+    _stats.bytes = _arena.capacity() + _editorSlots.capacity() * sizeof(EditorSlot) +
+                   _names.capacity() * sizeof(NameEntry);
+    _stats.threads = threadCount;
+    _stats.buildMillis =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    _built = true;
+
+    SKSE::log::info("Form index: {} editor IDs and {} names from {} forms in {:.1f} ms on {} threads ({} KiB)",
+                    _stats.editorIDs, _stats.names, _stats.formsScanned, _stats.buildMillis, _stats.threads,
+                    _stats.bytes / 1024);
+}
+
+void FormIndex::Merge(std::vector<Shard>& shards) {
+    std::size_t arenaSize = 0;
+    std::size_t editorCount = 0;
+    std::size_t nameCount = 0;
+    for (const auto& shard : shards) {
+        arenaSize += shard.arena.size();
+        editorCount += shard.editorIDs.size();
+        nameCount += shard.names.size();
+    }
+
+    _arena.clear();
+    _arena.shrink_to_fit();
+    _arena.reserve(arenaSize);
+    _names.clear();
+    _names.shrink_to_fit();
+    _names.reserve(nameCount);
+    _editorSlots.assign(editorCount ? std::bit_ceil(editorCount * 2) : 0, EditorSlot{});
+
+    const std::size_t mask = _editorSlots.size() - 1;
+    std::vector<std::size_t> runEnds;
+    for (auto& shard : shards) {
+        const auto base = static_cast<std::uint32_t>(_arena.size());
+        _arena.insert(_arena.end(), shard.arena.begin(), shard.arena.end());
+
+        for (auto entry : shard.editorIDs) {
+            entry.name.offset += base;
+            const auto hash = HashLower(View(entry.name));
+            auto index = hash & mask;
+            while (_editorSlots[index].key.length != 0) {
+                index = (index + 1) & mask;
+            }
+            _editorSlots[index] = {hash, entry.name, entry.formID};
+        }
+
+        for (auto entry : shard.names) {
+            entry.name.offset += base;
+            _names.push_back(entry);
+        }
+        runEnds.push_back(_names.size());
+
+        shard = {};
+    }
+
+    // Combine the sorted runs pairwise until one remains
+    const auto byName = [this](const NameEntry& left, const NameEntry& right) {
+        return View(left.name) < View(right.name);
+    };
+    while (runEnds.size() > 1) {
+        std::vector<std::size_t> merged;
+        std::size_t begin = 0;
+        for (std::size_t i = 0; i < runEnds.size(); i += 2) {
+            if (i + 1 < runEnds.size()) {
+                std::inplace_merge(_names.begin() + begin, _names.begin() + runEnds[i],
+                                   _names.begin() + runEnds[i + 1], byName);
+                begin = runEnds[i + 1];
+            } else {
+                begin = runEnds[i];
+            }
+            merged.push_back(begin);
+        }
+        runEnds = std::move(merged);
+    }
+}
+
+FormID FormIndex::FindByEditorID(std::string_view editorID) const noexcept {
+    if (_editorSlots.empty() || editorID.empty()) {
+        return 0;
+    }
+
+    const auto hash = HashLower(editorID);
+    const std::size_t mask = _editorSlots.size() - 1;
+    for (auto index = hash & mask;; index = (index + 1) & mask) {
+        const auto& slot = _editorSlots[index];
+        if (slot.key.length == 0) {
+            return 0;
+        }
+        if (slot.hash == hash && EqualsLower(View(slot.key), editorID)) {
+            return slot.formID;
+        }
+    }
+}
+
+std::size_t FormIndex::FindByNamePrefix(std::string_view prefix, std::size_t limit, std::vector<FormID>& out) const {
+    std::string lowered(prefix.size(), '\0');
+    std::ranges::transform(prefix, lowered.begin(), ToLower);
+
+    auto it = std::ranges::lower_bound(_names, std::string_view{lowered}, {},
+                                       [this](const NameEntry& entry) { return View(entry.name); });
+    std::size_t found = 0;
+    for (; it != _names.end() && found < limit && View(it->name).starts_with(lowered); ++it, ++found) {
+        out.push_back(it->formID);
+    }
+    return found;
+}
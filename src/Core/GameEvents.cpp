@@ -0,0 +1,268 @@
+#include "Core/GameEvents.h"
+
+#include <Core/LuaCommandQueue.h>
+#include <Core/LuaForms.h>
+
+extern "C" {
+#include <lua.h>
+#include <lauxlib.h>
+}
+
+#include <SKSE/SKSE.h>
+
+#include <algorithm>
+
+using namespace RE;
+using namespace Sample;
+
+namespace {
+    using Kind = GameEvents::Kind;
+
+    constexpr std::array<std::string_view, static_cast<std::size_t>(Kind::kTotal)> KindNames{
+        "OnEquip", "OnUnequip", "OnMenuOpen", "OnMenuClose", "OnCombatStateChanged", "OnDeath", "OnActivate"};
+
+    FormID GetFormID(const TESObjectREFR* reference) noexcept {
+        return reference ? reference->GetFormID() : 0;
+    }
+
+    // Filters match a reference by its base object; the reference itself is always an ActorCharacter or ObjectReference
+    FormType GetBaseFormType(const TESObjectREFR* reference) noexcept {
+        const auto* base = reference ? reference->GetBaseObject() : nullptr;
+        return base ? base->GetFormType() : FormType::None;
+    }
+
+    class GameEventSink : public BSTEventSink<TESEquipEvent>,
+                          public BSTEventSink<MenuOpenCloseEvent>,
+                          public BSTEventSink<TESCombatEvent>,
+                          public BSTEventSink<TESDeathEvent>,
+                          public BSTEventSink<TESActivateEvent> {
+    public:
+        BSEventNotifyControl ProcessEvent(const TESEquipEvent* event, BSTEventSource<TESEquipEvent>*) override {
+            if (!event || !event->actor) {
+                return BSEventNotifyControl::kContinue;
+            }
+            auto* events = GameEvents::GetSingleton();
+            const auto kind = event->equipped ? Kind::kEquip : Kind::kUnequip;
+            if (events->Receive(kind)) {
+                const auto* item = TESForm::LookupByID(event->baseObject);
+                events->Capture({kind, event->actor->GetFormID(), event->baseObject,
+                                 item ? item->GetFormType() : FormType::None, 0, {}});
+            }
+            return BSEventNotifyControl::kContinue;
+        }
+
+        BSEventNotifyControl ProcessEvent(const MenuOpenCloseEvent* event,
+                                          BSTEventSource<MenuOpenCloseEvent>*) override {
+            if (!event) {
+                return BSEventNotifyControl::kContinue;
+            }
+            auto* events = GameEvents::GetSingleton();
+            const auto kind = event->opening ? Kind::kMenuOpen : Kind::kMenuClose;
+            if (events->Receive(kind)) {
+                events->Capture({kind, 0, 0, FormType::None, 0, event->menuName});
+            }
+            return BSEventNotifyControl::kContinue;
+        }
+
+        BSEventNotifyControl ProcessEvent(const TESCombatEvent* event, BSTEventSource<TESCombatEvent>*) override {
+            auto* events = GameEvents::GetSingleton();
+            if (event && event->actor && events->Receive(Kind::kCombatStateChanged)) {
+                const auto* target = event->targetActor.get();
+                events->Capture({Kind::kCombatStateChanged, event->actor->GetFormID(), GetFormID(target),
+                                 GetBaseFormType(target),
+                                 static_cast<std::int32_t>(event->newState.get()), {}});
+            }
+            return BSEventNotifyControl::kContinue;
+        }
+
+        BSEventNotifyControl ProcessEvent(const TESDeathEvent* event, BSTEventSource<TESDeathEvent>*) override {
+            // Sent once as the actor starts dying and again, with dead set, once it is dead
+            auto* events = GameEvents::GetSingleton();
+            if (event && event->dead && event->actorDying && events->Receive(Kind::kDeath)) {
+                const auto* killer = event->actorKiller.get();
+                events->Capture({Kind::kDeath, event->actorDying->GetFormID(), GetFormID(killer),
+                                 GetBaseFormType(killer), 0, {}});
+            }
+            return BSEventNotifyControl::kContinue;
+        }
+
+        BSEventNotifyControl ProcessEvent(const TESActivateEvent* event, BSTEventSource<TESActivateEvent>*) override {
+            auto* events = GameEvents::GetSingleton();
+            if (event && event->objectActivated && events->Receive(Kind::kActivate)) {
+                events->Capture({Kind::kActivate, GetFormID(event->actionRef.get()),
+                                 event->objectActivated->GetFormID(), GetBaseFormType(event->objectActivated.get()),
+                                 0, {}});
+            }
+            return BSEventNotifyControl::kContinue;
+        }
+    };
+}
+
+bool GameEvents::Filter::Matches(const Event& event) const noexcept {
+    if (!actors.empty() && !std::binary_search(actors.begin(), actors.end(), event.subject)) {
+        return false;
+    }
+    if (!formTypes.empty() && std::find(formTypes.begin(), formTypes.end(), event.objectType) == formTypes.end()) {
+        return false;
+    }
+    if (!menus.empty() && std::find(menus.begin(), menus.end(), event.menu) == menus.end()) {
+        return false;
+    }
+    return true;
+}
+
+GameEvents* GameEvents::GetSingleton() noexcept {
+    static GameEvents instance;
+    return &instance;
+}
+
+std::optional<GameEvents::Kind> GameEvents::FindKind(std::string_view name) noexcept {
+    for (std::size_t i = 0; i < KindNames.size(); ++i) {
+        if (KindNames[i] == name) {
+            return static_cast<Kind>(i);
+        }
+    }
+    return std::nullopt;
+}
+
+void GameEvents::Initialize() {
+    static GameEventSink sink;
+    if (auto* events = ScriptEventSourceHolder::GetSingleton()) {
+        events->AddEventSink<TESEquipEvent>(&sink);
+        events->AddEventSink<TESCombatEvent>(&sink);
+        events->AddEventSink<TESDeathEvent>(&sink);
+        events->AddEventSink<TESActivateEvent>(&sink);
+    }
+    if (auto* ui = UI::GetSingleton()) {
+        ui->AddEventSink<MenuOpenCloseEvent>(&sink);
+    }
+}
+
+std::uint32_t GameEvents::Subscribe(Kind kind, int functionRef, Filter filter) {
+    std::sort(filter.actors.begin(), filter.actors.end());
+    const auto handle = HandleBit | _nextHandle++;
+    std::unique_lock lock(_lock);
+    _subscriptions.push_back({handle, kind, functionRef, std::move(filter)});
+    _counters[static_cast<std::size_t>(kind)].subscriptions.fetch_add(1, std::memory_order_relaxed);
+    return handle;
+}
+
+bool GameEvents::Unsubscribe(lua_State* L, std::uint32_t handle) {
+    // Only the main thread changes the list, so it can be searched without the lock
+    const auto subscription =
+        std::find_if(_subscriptions.begin(), _subscriptions.end(), [handle](const Subscription& entry) {
+            return entry.handle == handle && entry.functionRef != LUA_NOREF;
+        });
+    if (subscription == _subscriptions.end()) {
+        return false;
+    }
+    luaL_unref(L, LUA_REGISTRYINDEX, subscription->functionRef);
+
+    {
+        std::unique_lock lock(_lock);
+        subscription->functionRef = LUA_NOREF;
+    }
+    _counters[static_cast<std::size_t>(subscription->kind)].subscriptions.fetch_sub(1, std::memory_order_relaxed);
+    if (_dispatching) {
+        _compact = true;
+    } else {
+        Compact();
+    }
+    return true;
+}
+
+void GameEvents::Compact() {
+    std::unique_lock lock(_lock);
+    std::erase_if(_subscriptions, [](const Subscription& entry) { return entry.functionRef == LUA_NOREF; });
+    _compact = false;
+}
+
+void GameEvents::Capture(const Event& event) {
+    {
+        std::unique_lock lock(_lock);
+        const auto wanted =
+            std::any_of(_subscriptions.begin(), _subscriptions.end(), [&event](const Subscription& entry) {
+                return entry.kind == event.kind && entry.functionRef != LUA_NOREF && entry.filter.Matches(event);
+            });
+        if (!wanted) {
+            return;
+        }
+    }
+    if (!LuaCommandQueue::GetSingleton()->Push(event)) {
+        _counters[static_cast<std::size_t>(event.kind)].dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+int GameEvents::PushArguments(lua_State* L, const Event& event) {
+    switch (event.kind) {
+        case Kind::kMenuOpen:
+        case Kind::kMenuClose:
+            lua_pushstring(L, event.menu.c_str());
+            return 1;
+        case Kind::kCombatStateChanged:
+            PushFormHandle(L, TESForm::LookupByID(event.subject));
+            PushFormHandle(L, TESForm::LookupByID(event.object));
+            lua_pushinteger(L, event.value);
+            return 3;
+        case Kind::kActivate:
+            // The activated reference first, as in Papyrus
+            PushFormHandle(L, TESForm::LookupByID(event.object));
+            PushFormHandle(L, TESForm::LookupByID(event.subject));
+            return 2;
+        default:
+            PushFormHandle(L, TESForm::LookupByID(event.subject));
+            PushFormHandle(L, TESForm::LookupByID(event.object));
+            return 2;
+    }
+}
+
+void GameEvents::Dispatch(lua_State* L, const Event& event) {
+    // Filters are checked again: a subscription that accepted the event may be gone, and one that did not may share
+    // the kind with one that did. Subscriptions added by a handler first run on the next event.
+    auto& counters = _counters[static_cast<std::size_t>(event.kind)];
+    bool delivered = false;
+    _dispatching = true;
+    const auto count = _subscriptions.size();
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto& subscription = _subscriptions[i];
+        if (subscription.kind != event.kind || subscription.functionRef == LUA_NOREF ||
+            !subscription.filter.Matches(event)) {
+            continue;
+        }
+        lua_rawgeti(L, LUA_REGISTRYINDEX, subscription.functionRef);
+        const auto arguments = PushArguments(L, event);
+        delivered = true;
+        ++counters.handlerCalls;
+        if (lua_pcall(L, arguments, 0, 0) != LUA_OK) {
+            SKSE::log::error("Error in '{}' handler: {}", KindNames[static_cast<std::size_t>(event.kind)],
+                             lua_tostring(L, -1));
+            lua_pop(L, 1);
+        }
+    }
+    _dispatching = false;
+    if (delivered) {
+        ++counters.delivered;
+    }
+    if (_compact) {
+        Compact();
+    }
+}
+
+void GameEvents::Reset() noexcept {
+    std::unique_lock lock(_lock);
+    _subscriptions.clear();
+    _compact = false;
+    for (auto& counters : _counters) {
+        counters.subscriptions.store(0, std::memory_order_relaxed);
+    }
+}
+
+void GameEvents::GetStats(std::vector<Stats>& out) const {
+    out.clear();
+    for (std::size_t i = 0; i < KindCount; ++i) {
+        const auto& counters = _counters[i];
+        out.push_back({KindNames[i], counters.subscriptions.load(std::memory_order_relaxed),
+                       counters.received.load(std::memory_order_relaxed), counters.delivered,
+                       counters.dropped.load(std::memory_order_relaxed), counters.handlerCalls});
+    }
+}
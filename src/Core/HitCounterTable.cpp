@@ -0,0 +1,433 @@
+#include "Core/HitCounterTable.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+
+using namespace RE;
+using namespace Sample;
+
+HitCounterTable::HitCounterTable() {
+    _tables.push_back(std::make_unique<Table>(InitialCapacity));
+    _current.store(_tables.back().get(), std::memory_order_release);
+}
+
+std::uint32_t HitCounterTable::Hash(const Actor* actor) noexcept {
+    const auto bits = reinterpret_cast<std::uintptr_t>(actor) >> 4;
+    return static_cast<std::uint32_t>((static_cast<std::uint64_t>(bits) * 0x9E3779B97F4A7C15ull) >> 32);
+}
+
+HitCounterTable::Slot* HitCounterTable::Find(const Table& table, const Actor* actor, std::uint32_t hash) noexcept {
+    for (auto index = hash & table.mask;; index = (index + 1) & table.mask) {
+        auto& slot = table.slots[index];
+        const auto* key = slot.key.load(std::memory_order_acquire);
+        if (key == actor) {
+            return &slot;
+        }
+        if (!key) {
+            return nullptr;
+        }
+    }
+}
+
+std::uint64_t HitCounterTable::NowMicros() noexcept {
+    const auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(now).count());
+}
+
+const HitCounterTable::Slot* HitCounterTable::FindSlot(const Actor* actor) const noexcept {
+    const auto hash = Hash(actor);
+    if (!actor || !MayContain(hash)) {
+        return nullptr;
+    }
+    return Find(*_current.load(std::memory_order_acquire), actor, hash);
+}
+
+HitCounterTable::Window* HitCounterTable::GetWindow(std::uint64_t state) const noexcept {
+    const auto index = state >> WindowShift;
+    if (index == 0) {
+        return nullptr;
+    }
+    auto* chunk = _windowChunks[(index - 1) / WindowsPerChunk].load(std::memory_order_acquire);
+    return chunk + (index - 1) % WindowsPerChunk;
+}
+
+void HitCounterTable::Window::Reset() noexcept {
+    while (lock.test_and_set(std::memory_order_acquire)) {
+    }
+    second = 0;
+    lastHitMicros = 0;
+    buckets.fill(0);
+    lock.clear(std::memory_order_release);
+}
+
+void HitCounterTable::Window::Record(std::uint64_t nowMicros, std::int32_t hits) noexcept {
+    const auto now = static_cast<std::uint32_t>(nowMicros / 1000000);
+    while (lock.test_and_set(std::memory_order_acquire)) {
+    }
+
+    if (lastHitMicros != 0 && now < second) {
+        // Another thread read a later clock but took the lock first; count the hit in its own second if that is
+        // still inside the window, rather than treating the negative gap as a minute of silence
+        if (second - now >= WindowSeconds) {
+            lock.clear(std::memory_order_release);
+            return;
+        }
+    } else {
+        // Zero the buckets of the seconds that passed without hits, then count into the current one
+        if (lastHitMicros == 0 || now - second >= WindowSeconds) {
+            buckets.fill(0);
+        } else {
+            for (auto skipped = second + 1; skipped <= now; ++skipped) {
+                buckets[skipped % WindowSeconds] = 0;
+            }
+        }
+        second = now;
+    }
+    auto& bucket = buckets[now % WindowSeconds];
+    bucket = static_cast<std::uint16_t>(std::min<std::int32_t>(bucket + hits, 0xFFFF));
+    lastHitMicros = std::max(lastHitMicros, nowMicros);
+
+    lock.clear(std::memory_order_release);
+}
+
+std::uint32_t HitCounterTable::Window::Sum(std::uint64_t nowMicros, std::uint32_t seconds) noexcept {
+    const auto now = static_cast<std::uint32_t>(nowMicros / 1000000);
+    while (lock.test_and_set(std::memory_order_acquire)) {
+    }
+
+    std::uint32_t total = 0;
+    if (lastHitMicros != 0) {
+        for (std::uint32_t back = 0; back < seconds; ++back) {
+            const auto at = now - back;
+            if (at > second) {
+                continue;  // Nothing recorded since
+            }
+            if (second - at >= WindowSeconds) {
+                break;  // Older than the window
+            }
+            total += buckets[at % WindowSeconds];
+        }
+    }
+
+    lock.clear(std::memory_order_release);
+    return total;
+}
+
+bool HitCounterTable::MayContain(std::uint32_t hash) const noexcept {
+    const auto bit = (hash >> 16) & (FilterBits - 1);
+    return (_filter[bit / 64].load(std::memory_order_relaxed) >> (bit % 64)) & 1;
+}
+
+void HitCounterTable::Increment(Actor* actor, std::int32_t by) {
+    const auto hash = Hash(actor);
+    if (!actor || !MayContain(hash)) {
+        return;
+    }
+
+    for (;;) {
+        auto* slot = Find(*_current.load(std::memory_order_acquire), actor, hash);
+        if (!slot) {
+            return;
+        }
+
+        auto state = slot->state.load(std::memory_order_relaxed);
+        while (!(state & Moved)) {
+            if (!(state & Tracked)) {
+                return;
+            }
+            const auto count = static_cast<std::uint32_t>(static_cast<std::int32_t>(state & CountMask) + by);
+            const auto next = (state & ~CountMask) | HasCount | count;
+            if (slot->state.compare_exchange_weak(state, next, std::memory_order_acq_rel,
+                                                  std::memory_order_relaxed)) {
+                if (auto* window = GetWindow(next); window && by > 0) {
+                    window->Record(NowMicros(), by);
+                }
+                _totalHits.fetch_add(by, std::memory_order_relaxed);
+                const auto previous = static_cast<std::int32_t>(state & CountMask);
+                if (!(state & HasCount) || RankBucket(previous) != RankBucket(static_cast<std::int32_t>(count))) {
+                    Rerank(actor);
+                }
+                return;
+            }
+        }
+        // The table is being grown; retry once the new one is published
+    }
+}
+
+std::optional<std::int32_t> HitCounterTable::GetCount(const Actor* actor) const noexcept {
+    const auto* slot = FindSlot(actor);
+    if (!slot) {
+        return std::nullopt;
+    }
+    const auto state = slot->state.load(std::memory_order_acquire);
+    if (!(state & HasCount)) {
+        return std::nullopt;
+    }
+    return static_cast<std::int32_t>(state & CountMask);
+}
+
+bool HitCounterTable::IsTracked(const Actor* actor) const noexcept {
+    const auto* slot = FindSlot(actor);
+    return slot && (slot->state.load(std::memory_order_acquire) & Tracked);
+}
+
+std::uint32_t HitCounterTable::GetHitsInLast(const Actor* actor, std::uint32_t seconds) const noexcept {
+    const auto* slot = FindSlot(actor);
+    auto* window = slot ? GetWindow(slot->state.load(std::memory_order_acquire)) : nullptr;
+    if (!window) {
+        return 0;
+    }
+    return window->Sum(NowMicros(), std::clamp<std::uint32_t>(seconds, 1, WindowSeconds));
+}
+
+std::optional<double> HitCounterTable::GetTimeSinceLastHit(const Actor* actor) const noexcept {
+    const auto* slot = FindSlot(actor);
+    auto* window = slot ? GetWindow(slot->state.load(std::memory_order_acquire)) : nullptr;
+    if (!window) {
+        return std::nullopt;
+    }
+
+    while (window->lock.test_and_set(std::memory_order_acquire)) {
+    }
+    const auto lastHit = window->lastHitMicros;
+    window->lock.clear(std::memory_order_release);
+
+    if (lastHit == 0) {
+        return std::nullopt;
+    }
+    return static_cast<double>(NowMicros() - lastHit) / 1e6;
+}
+
+bool HitCounterTable::Track(Actor* actor) {
+    if (!actor) {
+        return false;
+    }
+    std::unique_lock lock(_writeLock);
+    return TrackLocked(actor);
+}
+
+std::size_t HitCounterTable::Track(std::span<Actor* const> actors) {
+    std::size_t added = 0;
+    std::unique_lock lock(_writeLock);
+    for (auto* actor : actors) {
+        if (actor && TrackLocked(actor)) {
+            ++added;
+        }
+    }
+    return added;
+}
+
+bool HitCounterTable::TrackLocked(Actor* actor) {
+    const auto previous = Insert(actor).state.fetch_or(Tracked, std::memory_order_acq_rel);
+    if (previous & Tracked) {
+        return false;
+    }
+    // Hits only land on tracked actors, so the count read here is the one that joins the total
+    _trackedCount.fetch_add(1, std::memory_order_relaxed);
+    if (previous & HasCount) {
+        _totalHits.fetch_add(static_cast<std::int32_t>(previous & CountMask), std::memory_order_relaxed);
+    }
+    return true;
+}
+
+bool HitCounterTable::Untrack(Actor* actor) {
+    if (!actor) {
+        return false;
+    }
+    std::unique_lock lock(_writeLock);
+    auto* slot = Find(*_current.load(std::memory_order_acquire), actor, Hash(actor));
+    if (!slot) {
+        return false;
+    }
+    const auto previous = slot->state.fetch_and(~Tracked, std::memory_order_acq_rel);
+    if (!(previous & Tracked)) {
+        return false;
+    }
+    // No hit can land after the flag is cleared, so this is the count that was added to the total
+    _trackedCount.fetch_sub(1, std::memory_order_relaxed);
+    if (previous & HasCount) {
+        _totalHits.fetch_sub(static_cast<std::int32_t>(previous & CountMask), std::memory_order_relaxed);
+    }
+    return true;
+}
+
+void HitCounterTable::SetCount(Actor* actor, std::int32_t count) {
+    if (!actor) {
+        return;
+    }
+    std::unique_lock lock(_writeLock);
+    StoreCount(Insert(actor), count);
+    Rerank(actor);
+}
+
+void HitCounterTable::ResetCounts(std::span<Actor* const> actors) {
+    std::unique_lock lock(_writeLock);
+    const auto* table = _current.load(std::memory_order_acquire);
+    for (auto* actor : actors) {
+        auto* slot = actor ? Find(*table, actor, Hash(actor)) : nullptr;
+        if (slot && (slot->state.load(std::memory_order_acquire) & HasCount)) {
+            StoreCount(*slot, 0);
+            Rerank(actor);
+        }
+    }
+}
+
+void HitCounterTable::StoreCount(Slot& slot, std::int32_t count) noexcept {
+    // Hits may land concurrently, so swap the count in rather than storing the whole word
+    auto state = slot.state.load(std::memory_order_relaxed);
+    while (!slot.state.compare_exchange_weak(state, (state & ~CountMask) | HasCount | static_cast<std::uint32_t>(count),
+                                             std::memory_order_acq_rel, std::memory_order_relaxed)) {
+    }
+    if (state & Tracked) {
+        const auto previous = (state & HasCount) ? static_cast<std::int32_t>(state & CountMask) : 0;
+        _totalHits.fetch_add(static_cast<std::int64_t>(count) - previous, std::memory_order_relaxed);
+    }
+}
+
+void HitCounterTable::Clear() {
+    std::unique_lock lock(_writeLock);
+    auto* table = _current.load(std::memory_order_acquire);
+    for (std::size_t i = 0; i <= table->mask; ++i) {
+        table->slots[i].state.store(0, std::memory_order_release);
+        table->slots[i].key.store(nullptr, std::memory_order_release);
+    }
+    for (auto& word : _filter) {
+        word.store(0, std::memory_order_relaxed);
+    }
+    _used = 0;
+    _windowsUsed = 0;
+    _trackedCount.store(0, std::memory_order_relaxed);
+    _totalHits.store(0, std::memory_order_relaxed);
+
+    std::unique_lock rankLock(_rankLock);
+    for (auto& bucket : _rankBuckets) {
+        bucket.clear();
+    }
+    _rankOf.clear();
+}
+
+HitCounterTable::Totals HitCounterTable::GetTotals() const noexcept {
+    return {_trackedCount.load(std::memory_order_relaxed), _totalHits.load(std::memory_order_relaxed)};
+}
+
+std::uint8_t HitCounterTable::RankBucket(std::int32_t count) noexcept {
+    return count <= 1 ? 0 : static_cast<std::uint8_t>(std::bit_width(static_cast<std::uint32_t>(count)) - 1);
+}
+
+void HitCounterTable::Rerank(Actor* actor) {
+    std::unique_lock lock(_rankLock);
+
+    // Read the count under the lock, so whichever thread re-files last uses the latest value
+    const auto count = GetCount(actor);
+    const auto filed = _rankOf.find(actor);
+    if (filed != _rankOf.end()) {
+        if (count && RankBucket(*count) == filed->second) {
+            return;
+        }
+        _rankBuckets[filed->second].erase(actor);
+        _rankOf.erase(filed);
+    }
+    if (count) {
+        const auto bucket = RankBucket(*count);
+        _rankBuckets[bucket].insert(actor);
+        _rankOf.emplace(actor, bucket);
+    }
+}
+
+void HitCounterTable::GetTop(std::size_t count, std::vector<std::pair<Actor*, std::int32_t>>& out) const {
+    if (count == 0) {
+        return;
+    }
+
+    // Every count in a bucket is above every count in the buckets below it, so once enough candidates are collected
+    // the remaining buckets cannot contribute
+    const auto from = out.size();
+    {
+        std::unique_lock lock(_rankLock);
+        for (auto bucket = RankBuckets; bucket-- > 0 && out.size() - from < count;) {
+            for (auto* actor : _rankBuckets[bucket]) {
+                const auto* slot = FindSlot(actor);
+                const auto state = slot ? slot->state.load(std::memory_order_acquire) : 0;
+                if ((state & Tracked) && (state & HasCount)) {
+                    out.emplace_back(actor, static_cast<std::int32_t>(state & CountMask));
+                }
+            }
+        }
+    }
+
+    const auto first = out.begin() + static_cast<std::ptrdiff_t>(from);
+    const auto kept = std::min(count, out.size() - from);
+    std::partial_sort(first, first + static_cast<std::ptrdiff_t>(kept), out.end(),
+                      [](const auto& left, const auto& right) { return left.second > right.second; });
+    out.resize(from + kept);
+}
+
+HitCounterTable::Slot& HitCounterTable::Insert(Actor* actor) {
+    const auto hash = Hash(actor);
+    if (auto* slot = Find(*_current.load(std::memory_order_acquire), actor, hash)) {
+        return *slot;
+    }
+
+    // Keep the table at most half full so probes stay short and always reach an empty slot
+    if ((_used + 1) * 2 > _current.load(std::memory_order_relaxed)->mask + 1) {
+        Grow();
+    }
+
+    auto* table = _current.load(std::memory_order_relaxed);
+    auto index = hash & table->mask;
+    while (table->slots[index].key.load(std::memory_order_relaxed)) {
+        index = (index + 1) & table->mask;
+    }
+    auto& slot = table->slots[index];
+    slot.state.store(AllocateWindow(), std::memory_order_relaxed);
+    slot.key.store(actor, std::memory_order_release);
+    ++_used;
+
+    const auto bit = (hash >> 16) & (FilterBits - 1);
+    _filter[bit / 64].fetch_or(std::uint64_t{1} << (bit % 64), std::memory_order_release);
+    return slot;
+}
+
+std::uint64_t HitCounterTable::AllocateWindow() {
+    const auto index = _windowsUsed;
+    const auto chunk = index / WindowsPerChunk;
+    if (chunk >= MaxWindowChunks) {
+        return 0;  // Out of windows; the actor is still counted, just without rates
+    }
+
+    auto* windows = _windowChunks[chunk].load(std::memory_order_relaxed);
+    if (!windows) {
+        _windowStorage.push_back(std::make_unique<Window[]>(WindowsPerChunk));
+        windows = _windowStorage.back().get();
+        _windowChunks[chunk].store(windows, std::memory_order_release);
+    }
+    windows[index % WindowsPerChunk].Reset();
+    ++_windowsUsed;
+    return static_cast<std::uint64_t>(index + 1) << WindowShift;
+}
+
+void HitCounterTable::Grow() {
+    const auto* old = _current.load(std::memory_order_relaxed);
+    auto grown = std::make_unique<Table>((old->mask + 1) * 2);
+
+    for (std::size_t i = 0; i <= old->mask; ++i) {
+        auto& slot = old->slots[i];
+        auto* actor = slot.key.load(std::memory_order_relaxed);
+        if (!actor) {
+            continue;
+        }
+        // Freezes the slot: increments that see Moved retry on the new table
+        const auto state = slot.state.fetch_or(Moved, std::memory_order_acq_rel);
+
+        auto index = Hash(actor) & grown->mask;
+        while (grown->slots[index].key.load(std::memory_order_relaxed)) {
+            index = (index + 1) & grown->mask;
+        }
+        grown->slots[index].state.store(state, std::memory_order_relaxed);
+        grown->slots[index].key.store(actor, std::memory_order_relaxed);
+    }
+
+    _current.store(grown.get(), std::memory_order_release);
+    _tables.push_back(std::move(grown));
+}
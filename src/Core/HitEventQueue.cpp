@@ -0,0 +1,50 @@
+#include "Core/HitEventQueue.h"
+
+#include <algorithm>
+#include <chrono>
+
+using namespace RE;
+using namespace Sample;
+
+namespace {
+    const auto LoadTime = std::chrono::steady_clock::now();
+}
+
+HitEventQueue* HitEventQueue::GetSingleton() noexcept {
+    static HitEventQueue instance;
+    return &instance;
+}
+
+bool HitEventQueue::Push(const Actor* target) noexcept {
+    if (!target) {
+        return false;
+    }
+
+    const auto elapsed = std::chrono::steady_clock::now() - LoadTime;
+    return _records.TryPush([&](Record& record) {
+        record = {target->GetFormID(), _frame.load(std::memory_order_relaxed),
+                  static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count())};
+    });
+}
+
+HitEventQueue::Batch HitEventQueue::Peek() const noexcept {
+    // Stop at the first record still being filled; it and everything after it wait for the next frame
+    std::uint32_t count = 0;
+    while (_records.Peek(count)) {
+        ++count;
+    }
+    return {&_records, count, _records.Dropped() - _droppedReported};
+}
+
+void HitEventQueue::Release(const Batch& batch) noexcept {
+    for (std::uint32_t i = 0; i < batch.count; ++i) {
+        _records.Pop();
+    }
+    _droppedReported += batch.dropped;
+    _highWater = std::max(_highWater, batch.count);
+    _frame.fetch_add(1, std::memory_order_relaxed);
+}
+
+HitEventQueue::Stats HitEventQueue::GetStats() const noexcept {
+    return {_records.Pushed(), _records.Dropped(), _highWater};
+}
@@ -0,0 +1,101 @@
+#include "Core/HitRecord.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace Sample;
+
+namespace {
+    constexpr std::uint8_t SavedTracked = 1;
+    constexpr std::uint8_t SavedHasCount = 2;
+
+    // Clamp the claimed entry count by the bytes left, so a corrupt count cannot reserve gigabytes
+    void ReserveEntries(std::vector<SavedActor>& actors, std::uint64_t count, std::size_t minEntrySize,
+                        const ByteReader& reader) {
+        actors.reserve(actors.size() +
+                       static_cast<std::size_t>(std::min<std::uint64_t>(count, reader.Remaining() / minEntrySize)));
+    }
+}
+
+void Sample::WriteHitsRecord(std::vector<SavedActor>& actors, ByteWriter& writer) {
+    std::sort(actors.begin(), actors.end(),
+              [](const SavedActor& left, const SavedActor& right) { return left.formID < right.formID; });
+
+    writer.Reserve(writer.Size() + 8 + actors.size() * 4);
+    writer.WriteVarUInt(actors.size());
+    std::uint32_t previous = 0;
+    for (const auto& actor : actors) {
+        writer.WriteVarUInt(actor.formID - previous);
+        writer.Write<std::uint8_t>((actor.tracked ? SavedTracked : 0) | (actor.count ? SavedHasCount : 0));
+        if (actor.count) {
+            writer.WriteVarInt(*actor.count);
+        }
+        previous = actor.formID;
+    }
+}
+
+bool Sample::ParseHitsRecord(ByteReader& reader, std::vector<SavedActor>& actors) {
+    std::uint64_t count;
+    if (!reader.ReadVarUInt(count)) {
+        return false;
+    }
+    ReserveEntries(actors, count, 2, reader);
+
+    std::uint64_t formID = 0;
+    for (; count > 0; --count) {
+        std::uint64_t delta;
+        std::uint8_t flags;
+        if (!reader.ReadVarUInt(delta) || !reader.Read(flags)) {
+            return false;
+        }
+        formID += delta;
+        if (formID > std::numeric_limits<std::uint32_t>::max()) {
+            return false;
+        }
+
+        std::optional<std::int32_t> hitCount;
+        if (flags & SavedHasCount) {
+            std::int64_t value;
+            if (!reader.ReadVarInt(value) || value < std::numeric_limits<std::int32_t>::min() ||
+                value > std::numeric_limits<std::int32_t>::max()) {
+                return false;
+            }
+            hitCount = static_cast<std::int32_t>(value);
+        }
+        actors.push_back({static_cast<std::uint32_t>(formID), (flags & SavedTracked) != 0, hitCount});
+    }
+    return true;
+}
+
+bool Sample::ParseLegacyHitCounts(ByteReader& reader, std::vector<SavedActor>& actors) {
+    std::uint64_t count;
+    if (!reader.Read(count)) {
+        return false;
+    }
+    ReserveEntries(actors, count, sizeof(std::uint32_t) + sizeof(std::int32_t), reader);
+    for (; count > 0; --count) {
+        std::uint32_t formID;
+        std::int32_t hitCount;
+        if (!reader.Read(formID) || !reader.Read(hitCount)) {
+            return false;
+        }
+        actors.push_back({formID, false, hitCount});
+    }
+    return true;
+}
+
+bool Sample::ParseLegacyTrackedActors(ByteReader& reader, std::vector<SavedActor>& actors) {
+    std::uint64_t count;
+    if (!reader.Read(count)) {
+        return false;
+    }
+    ReserveEntries(actors, count, sizeof(std::uint32_t), reader);
+    for (; count > 0; --count) {
+        std::uint32_t formID;
+        if (!reader.Read(formID)) {
+            return false;
+        }
+        actors.push_back({formID, true, std::nullopt});
+    }
+    return true;
+}
@@ -0,0 +1,149 @@
+#include "Core/HookRegistry.h"
+
+extern "C" {
+#include <lua.h>
+#include <lauxlib.h>
+}
+
+#include <algorithm>
+
+using namespace Sample;
+using namespace SKSE;
+
+HookRegistry* HookRegistry::GetSingleton() noexcept {
+    static HookRegistry instance;
+    return &instance;
+}
+
+void HookRegistry::Install(Trampoline& trampoline, std::span<const Site> sites) {
+    _sites = sites;
+    _states = std::make_unique<SiteState[]>(sites.size());
+    for (const auto& site : sites) {
+        REL::Relocation<std::uintptr_t> target{REL::RelocationID(site.seID, site.aeID),
+                                               REL::Relocate(site.seOffset, site.aeOffset)};
+        site.install(trampoline, target.address());
+        log::debug("Hook '{}' written.", site.name);
+    }
+}
+
+std::optional<std::uint32_t> HookRegistry::FindSite(std::string_view name) const noexcept {
+    for (std::size_t i = 0; i < _sites.size(); ++i) {
+        if (_sites[i].name == name) {
+            return static_cast<std::uint32_t>(i);
+        }
+    }
+    return std::nullopt;
+}
+
+void HookRegistry::Capture(std::uint32_t site, const Record& record) {
+    auto& state = _states[site];
+    std::unique_lock lock(state.lock);
+    ++state.captured;
+    if (state.pending.size() >= MaxPendingPerSite) {
+        ++state.dropped;
+        return;
+    }
+    state.pending.push_back(record);
+}
+
+std::optional<std::uint32_t> HookRegistry::Subscribe(std::uint32_t site, int functionRef) {
+    if (site >= _sites.size() || !_sites[site].push) {
+        return std::nullopt;
+    }
+    auto& state = _states[site];
+    const auto handle = _nextHandle++;
+    state.list.push_back({handle, functionRef});
+    _siteByHandle.emplace(handle, site);
+    state.subscribers.fetch_add(1, std::memory_order_relaxed);
+    return handle;
+}
+
+bool HookRegistry::Unsubscribe(lua_State* L, std::uint32_t handle) {
+    const auto found = _siteByHandle.find(handle);
+    if (found == _siteByHandle.end()) {
+        return false;
+    }
+    auto& state = _states[found->second];
+    _siteByHandle.erase(found);
+
+    const auto subscriber = std::find_if(state.list.begin(), state.list.end(),
+                                         [handle](const Subscriber& entry) { return entry.handle == handle; });
+    luaL_unref(L, LUA_REGISTRYINDEX, subscriber->functionRef);
+    subscriber->functionRef = LUA_NOREF;
+    state.subscribers.fetch_sub(1, std::memory_order_relaxed);
+    if (!_dispatching) {
+        Compact(state);
+    }
+    return true;
+}
+
+void HookRegistry::Compact(SiteState& state) {
+    std::erase_if(state.list, [](const Subscriber& entry) { return entry.functionRef == LUA_NOREF; });
+}
+
+void HookRegistry::Deliver(lua_State* L) {
+    for (std::size_t site = 0; site < _sites.size(); ++site) {
+        auto& state = _states[site];
+        _delivering.clear();
+        {
+            std::unique_lock lock(state.lock);
+            if (state.pending.empty()) {
+                continue;
+            }
+            std::swap(_delivering, state.pending);
+        }
+        // Everyone may have unsubscribed since these were captured
+        if (state.list.empty()) {
+            continue;
+        }
+
+        lua_createtable(L, static_cast<int>(_delivering.size()), 0);
+        for (std::size_t i = 0; i < _delivering.size(); ++i) {
+            _sites[site].push(L, _delivering[i]);
+            lua_rawseti(L, -2, static_cast<lua_Integer>(i + 1));
+        }
+
+        // Subscribers added by a handler first run on the next delivery
+        _dispatching = true;
+        const auto count = state.list.size();
+        for (std::size_t i = 0; i < count; ++i) {
+            if (state.list[i].functionRef == LUA_NOREF) {
+                continue;
+            }
+            lua_rawgeti(L, LUA_REGISTRYINDEX, state.list[i].functionRef);
+            lua_pushvalue(L, -2);
+            if (lua_pcall(L, 1, 0, 0) != LUA_OK) {
+                log::error("Error in '{}' hook subscriber: {}", _sites[site].name, lua_tostring(L, -1));
+                lua_pop(L, 1);
+            }
+        }
+        _dispatching = false;
+        ++state.deliveries;
+        lua_pop(L, 1);
+    }
+
+    for (std::size_t site = 0; site < _sites.size(); ++site) {
+        Compact(_states[site]);
+    }
+}
+
+void HookRegistry::Reset() noexcept {
+    for (std::size_t site = 0; site < _sites.size(); ++site) {
+        auto& state = _states[site];
+        state.list.clear();
+        state.subscribers.store(0, std::memory_order_relaxed);
+        std::unique_lock lock(state.lock);
+        state.pending.clear();
+    }
+    _siteByHandle.clear();
+}
+
+void HookRegistry::GetStats(std::vector<SiteStats>& out) const {
+    out.clear();
+    for (std::size_t site = 0; site < _sites.size(); ++site) {
+        auto& state = _states[site];
+        std::unique_lock lock(state.lock);
+        out.push_back({_sites[site].name, state.subscribers.load(std::memory_order_relaxed), state.captured,
+                       state.dropped, state.deliveries});
+    }
+}
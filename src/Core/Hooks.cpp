@@ -0,0 +1,112 @@
+#include "Core/Hooks.h"
+
+#include <Core/HitEventQueue.h>
+#include <Core/HookRegistry.h>
+#include <Core/LuaForms.h>
+#include <Core/LuaManager.h>
+#include <Core/SKSEManager.h>
+#include <Core/SpatialIndex.h>
+
+extern "C" {
+#include <lua.h>
+}
+
+using namespace Sample;
+using namespace RE;
+using namespace REL;
+using namespace SKSE;
+
+namespace {
+    enum HookSite : std::uint32_t { kMainUpdate, kPopulateHitData };
+
+    HookRegistry* Registry = HookRegistry::GetSingleton();
+
+    // Each hooked call site keeps a Relocation to the function it originally called. The <code>Relocation</code>
+    // class references something in the Skyrim engine (e.g. static data, a function, etc.) that can be relocated in
+    // memory at runtime. Windows will rebase the memory of the Skyrim process to a random one, so we cannot hard-code
+    // the memory address. Relocation will rebase your memory offset to the base memory address of the Skyrim process,
+    // so that it adjusts on every run. However, it is recommended not to provide a memory offset, but rather a
+    // <code>REL::ID</code> to lookup the offset dynamically with Address Library.
+    //
+    // The IDs in the site table below are IDs of functions in Address Library. We use them to not be tied to the
+    // specific Skyrim executable version. However, there are still three incompatible databases of addresses, for
+    // Skyrim 1.5.x (pre-AE), Skyrim 1.6.x (post-AE), and Skyrim VR. The SE ID is used for Skyrim VR as well, since the
+    // VR address library uses SE ID's but maps them to a VR offset. <code>RelocationID</code> chooses between the SE
+    // and AE ID at runtime, depending on which version of Skyrim is in use, which allows for a single DLL that works
+    // across both versions of Skyrim.
+
+    // A call inside Main::Update that runs once per frame on the main thread, after the game has processed its own
+    // per-frame work.
+    void MainUpdate(Main* main, float unk0);
+    Relocation<decltype(MainUpdate)> OriginalMainUpdate;
+
+    std::chrono::steady_clock::time_point LastFrame;
+
+    void MainUpdate(Main* main, float unk0) {
+        OriginalMainUpdate(main, unk0);
+
+        const auto now = std::chrono::steady_clock::now();
+        float deltaTime = 0.0f;
+        if (LastFrame.time_since_epoch().count() != 0) {
+            // Clamp long stalls (loading screens, breakpoints) so timers don't fire in a burst afterwards
+            deltaTime = std::min(std::chrono::duration<float>(now - LastFrame).count(), 1.0f);
+        }
+        LastFrame = now;
+
+        SpatialIndex::GetSingleton()->Refresh();
+        LuaManager::GetSingleton()->Update(deltaTime);
+    }
+
+    // The call to HitData::Populate made whenever an actor is hit.
+    int32_t* PopulateHitData(Actor* target, char* unk0);
+    Relocation<decltype(PopulateHitData)> OriginalPopulateHitData;
+
+    int32_t* PopulateHitData(Actor* target, char* unk0) {
+        SKSEManager::GetSingleton()->IncrementHitCount(target, 1);
+        HitEventQueue::GetSingleton()->Push(target);
+        if (Registry->IsSubscribed(kPopulateHitData) && target) [[unlikely]] {
+            Registry->Capture(kPopulateHitData, {target->GetFormID()});
+        }
+        return OriginalPopulateHitData(target, unk0);
+    }
+
+    // Captured calls are delivered a frame later, so the target is looked up again by FormID
+    void PushHitData(lua_State* L, const HookRegistry::Record& record) {
+        const auto formID = static_cast<FormID>(record.words[0]);
+        lua_createtable(L, 0, 2);
+        if (auto* form = TESForm::LookupByID(formID)) {
+            PushFormHandle(L, form);
+            lua_setfield(L, -2, "target");
+        }
+        lua_pushinteger(L, formID);
+        lua_setfield(L, -2, "formID");
+    }
+
+    // The trampoline can be used to write a new call instruction at a given address. We use write_call<5> to indicate
+    // this is a 5-byte call instruction (rather than the much rarer 6-byte call). We pass in the address of our
+    // function that will be called, and a pointer to the trampoline function is returned.
+    //
+    // The trampoline pointed to contains any instructions from the original function we overwrote and a call to the
+    // instruction that comes after, so that if we call that address as a function, we are in effect calling the
+    // original code.
+    template <auto& Original, auto Thunk>
+    void WriteCall(Trampoline& trampoline, std::uintptr_t address) {
+        Original = trampoline.write_call<5>(address, reinterpret_cast<std::uintptr_t>(Thunk));
+    }
+
+    // Indexed by HookSite
+    constexpr std::array Sites = {
+        HookRegistry::Site{"MainUpdate", 35551, 36544, 0x11F, 0x160, WriteCall<OriginalMainUpdate, MainUpdate>,
+                           nullptr},
+        HookRegistry::Site{"PopulateHitData", 42832, 44001, 0x42, 0x42,
+                           WriteCall<OriginalPopulateHitData, PopulateHitData>, PushHitData},
+    };
+}
+
+std::size_t Sample::GetHookTrampolineSize() noexcept {
+    return HookRegistry::GetTrampolineSize(Sites);
+}
+
+void Sample::InitializeHooks(Trampoline& trampoline) {
+    Registry->Install(trampoline, Sites);
+}
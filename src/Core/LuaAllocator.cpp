@@ -0,0 +1,155 @@
+#include "Core/LuaAllocator.h"
+
+#include <SKSE/SKSE.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace Sample {
+
+    namespace {
+        // Maps (size + 15) / 16 to the smallest size class that fits, for every size up to MaxSmallSize
+        constexpr auto BuildClassLookup() {
+            std::array<std::uint8_t, LuaAllocator::MaxSmallSize / 16 + 1> lookup{};
+            std::size_t classIndex = 0;
+            for (std::size_t granule = 0; granule < lookup.size(); ++granule) {
+                while (LuaAllocator::ClassSizes[classIndex] < granule * 16) {
+                    ++classIndex;
+                }
+                lookup[granule] = static_cast<std::uint8_t>(classIndex);
+            }
+            return lookup;
+        }
+
+        constexpr auto ClassLookup = BuildClassLookup();
+    }
+
+    LuaAllocator::~LuaAllocator() {
+        for (void* slab : _slabs) {
+            std::free(slab);
+        }
+    }
+
+    std::size_t LuaAllocator::ClassIndex(std::size_t size) noexcept {
+        return ClassLookup[(size + 15) / 16];
+    }
+
+    void* LuaAllocator::Allocate(void* userData, void* ptr, std::size_t oldSize, std::size_t newSize) noexcept {
+        auto* allocator = static_cast<LuaAllocator*>(userData);
+
+        // When ptr is null, oldSize encodes the type of object being created rather than a size
+        const std::size_t previous = ptr ? oldSize : 0;
+        void* result = allocator->Reallocate(ptr, previous, newSize);
+        if (result || newSize == 0) {
+            auto& stats = allocator->_stats;
+            stats.liveBytes = stats.liveBytes - previous + newSize;
+            stats.peakBytes = std::max(stats.peakBytes, stats.liveBytes);
+        }
+        return result;
+    }
+
+    void* LuaAllocator::Reallocate(void* ptr, std::size_t oldSize, std::size_t newSize) noexcept {
+        const bool oldSmall = ptr && oldSize <= MaxSmallSize;
+        const bool newSmall = newSize <= MaxSmallSize;
+
+        if (newSize == 0) {
+            if (oldSmall) {
+                FreeSmall(ptr, ClassIndex(oldSize));
+            } else if (ptr) {
+                _stats.largeLiveBytes -= oldSize;
+                std::free(ptr);
+            }
+            return nullptr;
+        }
+
+        if (!ptr) {
+            if (newSmall) {
+                return AllocateSmall(ClassIndex(newSize));
+            }
+            void* block = std::malloc(newSize);
+            if (block) {
+                ++_stats.largeAllocations;
+                _stats.largeLiveBytes += newSize;
+            }
+            return block;
+        }
+
+        // Same size class: the block already has room
+        if (oldSmall && newSmall && ClassIndex(oldSize) == ClassIndex(newSize)) {
+            return ptr;
+        }
+
+        // Both large: let the system heap grow or shrink in place when it can
+        if (!oldSmall && !newSmall) {
+            void* block = std::realloc(ptr, newSize);
+            if (block) {
+                _stats.largeLiveBytes = _stats.largeLiveBytes - oldSize + newSize;
+            }
+            return block;
+        }
+
+        // Crossing between classes or between pooled and system memory: move the contents
+        void* block = Reallocate(nullptr, 0, newSize);
+        if (!block) {
+            return nullptr;
+        }
+        std::memcpy(block, ptr, std::min(oldSize, newSize));
+        Reallocate(ptr, oldSize, 0);
+        return block;
+    }
+
+    void* LuaAllocator::AllocateSmall(std::size_t classIndex) noexcept {
+        ++_stats.classAllocations[classIndex];
+
+        if (auto* block = _freeLists[classIndex]) {
+            _freeLists[classIndex] = block->next;
+            ++_stats.classLive[classIndex];
+            return block;
+        }
+
+        const std::size_t blockSize = ClassSizes[classIndex];
+        if (_slabCursor[classIndex] + blockSize > _slabEnd[classIndex]) {
+            auto* slab = static_cast<std::byte*>(std::malloc(SlabSize));
+            if (!slab) {
+                --_stats.classAllocations[classIndex];
+                return nullptr;
+            }
+            try {
+                _slabs.push_back(slab);
+            } catch (...) {
+                std::free(slab);
+                --_stats.classAllocations[classIndex];
+                return nullptr;
+            }
+            _stats.slabBytes += SlabSize;
+            _slabCursor[classIndex] = slab;
+            _slabEnd[classIndex] = slab + SlabSize;
+        }
+
+        void* block = _slabCursor[classIndex];
+        _slabCursor[classIndex] += blockSize;
+        ++_stats.classLive[classIndex];
+        return block;
+    }
+
+    void LuaAllocator::FreeSmall(void* ptr, std::size_t classIndex) noexcept {
+        auto* block = static_cast<FreeBlock*>(ptr);
+        block->next = _freeLists[classIndex];
+        _freeLists[classIndex] = block;
+        --_stats.classLive[classIndex];
+    }
+
+    void LuaAllocator::LogStats() const {
+        SKSE::log::info("Lua allocator: {} bytes live, {} bytes peak, {} bytes in {} slabs, {} bytes in large blocks",
+                        _stats.liveBytes, _stats.peakBytes, _stats.slabBytes, _slabs.size(), _stats.largeLiveBytes);
+        for (std::size_t i = 0; i < ClassCount; ++i) {
+            if (_stats.classAllocations[i] == 0) {
+                continue;
+            }
+            SKSE::log::info("  {:>3}-byte class: {} live, {} allocated", ClassSizes[i], _stats.classLive[i],
+                            _stats.classAllocations[i]);
+        }
+        SKSE::log::info("  large blocks: {} allocated", _stats.largeAllocations);
+    }
+}
@@ -0,0 +1,189 @@
+#include "Core/LuaCallBridge.h"
+
+#include <Core/LuaForms.h>
+
+extern "C" {
+#include <lua.h>
+#include <lauxlib.h>
+}
+
+#include <SKSE/SKSE.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <string_view>
+
+using namespace RE;
+using namespace Sample;
+
+namespace {
+    std::uint64_t NowMicros() noexcept {
+        const auto now = std::chrono::steady_clock::now().time_since_epoch();
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(now).count());
+    }
+
+    bool EqualsIgnoreCase(std::string_view left, std::string_view right) noexcept {
+        return std::ranges::equal(left, right, [](unsigned char l, unsigned char r) {
+            return std::tolower(l) == std::tolower(r);
+        });
+    }
+
+    // Replace the table on top of the stack with its value for the only string key that matches ignoring case, or
+    // nil if no key or more than one does
+    void ReplaceWithKeyIgnoringCase(lua_State* L, std::string_view part) {
+        lua_pushnil(L);  // Result
+        int matches = 0;
+        lua_pushnil(L);
+        while (lua_next(L, -3)) {
+            std::size_t length;
+            const char* key = lua_type(L, -2) == LUA_TSTRING ? lua_tolstring(L, -2, &length) : nullptr;
+            if (key && EqualsIgnoreCase({key, length}, part) && ++matches == 1) {
+                lua_replace(L, -3);
+            } else {
+                lua_pop(L, 1);
+            }
+        }
+        if (matches > 1) {
+            lua_pop(L, 1);
+            lua_pushnil(L);
+        }
+        lua_remove(L, -2);
+    }
+
+    // Walk a dotted path from the globals, leaving the value it names (or nil) on the stack. Raw lookups, so no
+    // metamethod can raise an error outside a protected call. A part that is not found as written is matched
+    // ignoring case, since the path comes through the game's case-insensitive string pool.
+    void PushPath(lua_State* L, std::string_view path) {
+        lua_pushglobaltable(L);
+        for (;;) {
+            if (!lua_istable(L, -1)) {
+                lua_pop(L, 1);
+                lua_pushnil(L);
+                return;
+            }
+            const auto dot = path.find('.');
+            const auto part = path.substr(0, dot);
+            lua_pushlstring(L, part.data(), part.size());
+            lua_rawget(L, -2);
+            if (lua_isnil(L, -1)) {
+                lua_pop(L, 1);
+                ReplaceWithKeyIgnoringCase(L, part);
+            } else {
+                lua_remove(L, -2);
+            }
+            if (dot == std::string_view::npos) {
+                return;
+            }
+            path.remove_prefix(dot + 1);
+        }
+    }
+
+    float ToResult(lua_State* L, int index) {
+        switch (lua_type(L, index)) {
+            case LUA_TNUMBER:
+                return static_cast<float>(lua_tonumber(L, index));
+            case LUA_TBOOLEAN:
+                return lua_toboolean(L, index) ? 1.0f : 0.0f;
+            default:
+                return 0.0f;
+        }
+    }
+}
+
+bool LuaCallBridge::PushFunction(lua_State* L, const BSFixedString& function) {
+    const auto found = _functions.find(function.data());
+    if (found != _functions.end()) {
+        ++_stats.cacheHits;
+        lua_rawgeti(L, LUA_REGISTRYINDEX, found->second.functionRef);
+        return true;
+    }
+
+    ++_stats.resolves;
+    PushPath(L, function.c_str());
+    if (!lua_isfunction(L, -1)) {
+        // Not cached, so a script that defines the function later is picked up
+        lua_pop(L, 1);
+        SKSE::log::warn("Papyrus called Lua function '{}', which does not exist or is ambiguous ignoring case.",
+                        function.c_str());
+        return false;
+    }
+    lua_pushvalue(L, -1);
+    _functions.emplace(function.data(), Entry{function, luaL_ref(L, LUA_REGISTRYINDEX)});
+    return true;
+}
+
+float LuaCallBridge::Invoke(lua_State* L, const BSFixedString& function, TESForm* target,
+                            std::span<const float> args) {
+    const auto start = NowMicros();
+    ++_stats.calls;
+
+    float result = 0.0f;
+    if (!lua_checkstack(L, static_cast<int>(args.size()) + 2)) {
+        ++_stats.errors;
+        SKSE::log::error("Too many arguments ({}) for Lua function '{}'.", args.size(), function.c_str());
+        return result;
+    }
+
+    lua_pushvalue(L, -1);
+    if (target) {
+        PushFormHandle(L, target);
+    } else {
+        lua_pushnil(L);
+    }
+    for (const auto arg : args) {
+        lua_pushnumber(L, static_cast<lua_Number>(arg));
+    }
+    if (lua_pcall(L, static_cast<int>(args.size()) + 1, 1, 0) != LUA_OK) {
+        ++_stats.errors;
+        SKSE::log::error("Lua function '{}' called from Papyrus failed: {}", function.c_str(), lua_tostring(L, -1));
+    } else {
+        result = ToResult(L, -1);
+    }
+    lua_pop(L, 1);
+
+    const auto elapsed = NowMicros() - start;
+    _stats.totalMicros += elapsed;
+    _stats.maxMicros = std::max(_stats.maxMicros, static_cast<std::uint32_t>(elapsed));
+    return result;
+}
+
+float LuaCallBridge::Call(lua_State* L, const BSFixedString& function, TESForm* target,
+                          std::span<const float> args) {
+    if (!PushFunction(L, function)) {
+        ++_stats.calls;
+        ++_stats.errors;
+        return 0.0f;
+    }
+    const auto result = Invoke(L, function, target, args);
+    lua_pop(L, 1);
+    return result;
+}
+
+void LuaCallBridge::CallBatch(lua_State* L, const BSFixedString& function, std::span<TESForm* const> targets,
+                              std::span<const float> args, std::vector<float>& out) {
+    out.assign(targets.size(), 0.0f);
+    if (targets.empty()) {
+        return;
+    }
+    if (!PushFunction(L, function)) {
+        _stats.calls += targets.size();
+        _stats.errors += targets.size();
+        return;
+    }
+    for (std::size_t i = 0; i < targets.size(); ++i) {
+        out[i] = Invoke(L, function, targets[i], args);
+    }
+    lua_pop(L, 1);
+}
+
+void LuaCallBridge::Clear(lua_State* L) {
+    for (const auto& [key, entry] : _functions) {
+        luaL_unref(L, LUA_REGISTRYINDEX, entry.functionRef);
+    }
+    _functions.clear();
+}
+
+void LuaCallBridge::Reset() noexcept {
+    _functions.clear();
+}
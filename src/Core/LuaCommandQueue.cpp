@@ -0,0 +1,75 @@
+#include "Core/LuaCommandQueue.h"
+
+#include <algorithm>
+#include <chrono>
+
+using namespace RE;
+using namespace Sample;
+
+namespace {
+    const auto LoadTime = std::chrono::steady_clock::now();
+}
+
+LuaCommandQueue* LuaCommandQueue::GetSingleton() noexcept {
+    static LuaCommandQueue instance;
+    return &instance;
+}
+
+std::uint64_t LuaCommandQueue::NowMicros() noexcept {
+    const auto elapsed = std::chrono::steady_clock::now() - LoadTime;
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+}
+
+bool LuaCommandQueue::Push(const GameEvents::Event& event) {
+    return _ring.TryPush([&event](Command& command) {
+        command.type = Type::kGameEvent;
+        command.gameEvent = event;
+        command.enqueuedMicros = NowMicros();
+    });
+}
+
+bool LuaCommandQueue::Push(const BSFixedString& name, std::span<const float> args) {
+    if (args.size() > MaxArgs) {
+        return false;
+    }
+    return _ring.TryPush([&name, args](Command& command) {
+        command.type = Type::kEvent;
+        command.name = name;
+        command.argCount = static_cast<std::uint8_t>(args.size());
+        std::copy(args.begin(), args.end(), command.args.begin());
+        command.enqueuedMicros = NowMicros();
+    });
+}
+
+const LuaCommandQueue::Command* LuaCommandQueue::Front() const noexcept {
+    return _ring.Front();
+}
+
+void LuaCommandQueue::Pop(std::uint64_t startMicros) noexcept {
+    auto* command = _ring.Front();
+    const auto latency = startMicros - std::min(startMicros, command->enqueuedMicros);
+    _totalLatencyMicros += latency;
+    _maxLatencyMicros = std::max(_maxLatencyMicros, static_cast<std::uint32_t>(latency));
+    ++_drained;
+
+    // Let go of the strings now rather than when the cell is next written
+    command->name = {};
+    command->gameEvent.menu = {};
+    _ring.Pop();
+}
+
+void LuaCommandQueue::Clear() noexcept {
+    const auto now = NowMicros();
+    while (Front()) {
+        Pop(now);
+    }
+}
+
+std::size_t LuaCommandQueue::Size() const noexcept {
+    return _ring.Size();
+}
+
+LuaCommandQueue::Stats LuaCommandQueue::GetStats() const noexcept {
+    return {_ring.Pushed(), _drained,           _ring.Dropped(),   _ring.HighWater(),
+            _backlogFrames, _totalLatencyMicros, _maxLatencyMicros};
+}
@@ -0,0 +1,293 @@
+#include "Core/LuaForms.h"
+
+#include <Core/ActorValues.h>
+#include <Core/MpscRing.h>
+#include <Core/SKSEManager.h>
+
+extern "C" {
+#include <lua.h>
+#include <lauxlib.h>
+}
+
+using namespace RE;
+using namespace Sample;
+
+namespace {
+    constexpr auto MetatableName = "HelloLua.Form";
+    constexpr auto CacheKey = "HelloLua.FormCache";
+
+    // Bumped whenever every cached form pointer may have gone stale
+    std::atomic<uint32_t> FormGeneration{1};
+
+    // Forms deleted since the main thread last looked, from whichever thread deleted them
+    MpscRing<FormID, 4096> DeletedForms;
+
+    struct FormHandle {
+        FormID formID;
+        TESForm* form;
+        uint32_t generation;
+    };
+
+    // Mark the handles of deleted forms stale, so only those look their FormID up again
+    void ApplyDeletions(lua_State* L) {
+        if (!DeletedForms.Front()) {
+            return;
+        }
+        const bool hasCache = lua_getfield(L, LUA_REGISTRYINDEX, CacheKey) == LUA_TTABLE;
+        while (const auto* formID = DeletedForms.Front()) {
+            if (hasCache) {
+                if (lua_rawgeti(L, -1, *formID) == LUA_TUSERDATA) {
+                    auto* handle = static_cast<FormHandle*>(lua_touserdata(L, -1));
+                    handle->form = nullptr;
+                    handle->generation = 0;  // Never current
+                }
+                lua_pop(L, 1);
+            }
+            DeletedForms.Pop();
+        }
+        lua_pop(L, 1);
+    }
+
+    TESForm* Resolve(lua_State* L, FormHandle* handle) {
+        ApplyDeletions(L);
+        const auto generation = FormGeneration.load(std::memory_order_relaxed);
+        if (handle->generation != generation) {
+            handle->form = TESForm::LookupByID(handle->formID);
+            handle->generation = generation;
+        }
+        return handle->form;
+    }
+
+    FormHandle* CheckHandle(lua_State* L, int index) {
+        return static_cast<FormHandle*>(luaL_checkudata(L, index, MetatableName));
+    }
+
+    Actor* CheckActor(lua_State* L) {
+        auto* form = Resolve(L, CheckHandle(L, 1));
+        return form ? form->As<Actor>() : nullptr;
+    }
+
+    class FormDeleteSink : public BSTEventSink<TESFormDeleteEvent> {
+    public:
+        BSEventNotifyControl ProcessEvent(const TESFormDeleteEvent* event,
+                                          BSTEventSource<TESFormDeleteEvent>*) override {
+            // Only the main thread may touch the handle cache, so the deletion is queued for it. If the queue is
+            // full, every handle re-resolves instead.
+            if (event && !DeletedForms.TryPush([event](FormID& formID) { formID = event->formID; })) {
+                InvalidateFormHandles();
+            }
+            return BSEventNotifyControl::kContinue;
+        }
+    };
+
+    // Methods available on every handle
+
+    int FormGetFormID(lua_State* L) {
+        lua_pushinteger(L, CheckHandle(L, 1)->formID);
+        return 1;
+    }
+
+    int FormIsValid(lua_State* L) {
+        lua_pushboolean(L, Resolve(L, CheckHandle(L, 1)) != nullptr);
+        return 1;
+    }
+
+    int FormGetName(lua_State* L) {
+        auto* form = Resolve(L, CheckHandle(L, 1));
+        const auto name = SKSEManager::GetSingleton()->GetFormName(form);
+        lua_pushlstring(L, name.data(), name.size());
+        return 1;
+    }
+
+    int FormGetFormType(lua_State* L) {
+        auto* form = Resolve(L, CheckHandle(L, 1));
+        if (!form) {
+            lua_pushnil(L);
+            return 1;
+        }
+        lua_pushinteger(L, static_cast<lua_Integer>(form->GetFormType()));
+        return 1;
+    }
+
+    int FormIsActor(lua_State* L) {
+        lua_pushboolean(L, CheckActor(L) != nullptr);
+        return 1;
+    }
+
+    // Actor methods; they return nil (or false) when the handle is not a live actor
+
+    int ActorGetHitCount(lua_State* L) {
+        auto* actor = CheckActor(L);
+        const auto count = actor ? SKSEManager::GetSingleton()->GetHitCount(actor) : std::nullopt;
+        if (count) {
+            lua_pushinteger(L, *count);
+        } else {
+            lua_pushnil(L);
+        }
+        return 1;
+    }
+
+    int ActorGetActorValue(lua_State* L) {
+        auto* actor = CheckActor(L);
+        const auto av = GetActorValueArg(L, 2);
+        lua_pushnumber(L, actor ? SKSEManager::GetSingleton()->GetActorValue(actor, av) : 0.0f);
+        return 1;
+    }
+
+    int ActorGetPosition(lua_State* L) {
+        auto* actor = CheckActor(L);
+        if (!actor) {
+            lua_pushnil(L);
+            return 1;
+        }
+        const auto position = actor->GetPosition();
+        lua_pushnumber(L, position.x);
+        lua_pushnumber(L, position.y);
+        lua_pushnumber(L, position.z);
+        return 3;
+    }
+
+    int ActorGetDistance(lua_State* L) {
+        auto* actor = CheckActor(L);
+        auto* other = GetActorArg(L, 2);
+        lua_pushnumber(L, SKSEManager::GetSingleton()->GetActorDistance(actor, other));
+        return 1;
+    }
+
+    int ActorIsTracked(lua_State* L) {
+        auto* actor = CheckActor(L);
+        lua_pushboolean(L, actor && SKSEManager::GetSingleton()->GetHitCount(actor).has_value());
+        return 1;
+    }
+
+    // Metamethods
+
+    int FormEquals(lua_State* L) {
+        lua_pushboolean(L, CheckHandle(L, 1)->formID == CheckHandle(L, 2)->formID);
+        return 1;
+    }
+
+    int FormToString(lua_State* L) {
+        lua_pushfstring(L, "Form(%08X)", static_cast<unsigned int>(CheckHandle(L, 1)->formID));
+        return 1;
+    }
+
+    constexpr luaL_Reg FormMethods[] = {
+        {"GetFormID", FormGetFormID},
+        {"IsValid", FormIsValid},
+        {"GetName", FormGetName},
+        {"GetFormType", FormGetFormType},
+        {"IsActor", FormIsActor},
+        {"GetHitCount", ActorGetHitCount},
+        {"GetActorValue", ActorGetActorValue},
+        {"GetPosition", ActorGetPosition},
+        {"GetDistance", ActorGetDistance},
+        {"IsTracked", ActorIsTracked},
+        {nullptr, nullptr},
+    };
+}
+
+void Sample::RegisterFormHandles(lua_State* L) {
+    luaL_newmetatable(L, MetatableName);
+    lua_newtable(L);
+    luaL_setfuncs(L, FormMethods, 0);
+    lua_setfield(L, -2, "__index");
+    lua_pushcfunction(L, FormEquals);
+    lua_setfield(L, -2, "__eq");
+    lua_pushcfunction(L, FormToString);
+    lua_setfield(L, -2, "__tostring");
+    lua_pop(L, 1);
+
+    // FormID -> handle, with weak values so unused handles can be collected
+    lua_newtable(L);
+    lua_createtable(L, 0, 1);
+    lua_pushliteral(L, "v");
+    lua_setfield(L, -2, "__mode");
+    lua_setmetatable(L, -2);
+    lua_setfield(L, LUA_REGISTRYINDEX, CacheKey);
+}
+
+void Sample::PushFormHandle(lua_State* L, TESForm* form) {
+    if (!form) {
+        lua_pushnil(L);
+        return;
+    }
+
+    const auto formID = form->GetFormID();
+    lua_getfield(L, LUA_REGISTRYINDEX, CacheKey);
+    if (lua_rawgeti(L, -1, formID) == LUA_TUSERDATA) {
+        // The caller just resolved this form, so refresh the cached pointer for free
+        auto* handle = static_cast<FormHandle*>(lua_touserdata(L, -1));
+        handle->form = form;
+        handle->generation = FormGeneration.load(std::memory_order_relaxed);
+        lua_remove(L, -2);
+        return;
+    }
+    lua_pop(L, 1);
+
+    auto* handle = static_cast<FormHandle*>(lua_newuserdata(L, sizeof(FormHandle)));
+    *handle = {formID, form, FormGeneration.load(std::memory_order_relaxed)};
+    luaL_setmetatable(L, MetatableName);
+    lua_pushvalue(L, -1);
+    lua_rawseti(L, -3, formID);
+    lua_remove(L, -2);
+}
+
+TESForm* Sample::GetFormArg(lua_State* L, int index) {
+    if (auto* handle = static_cast<FormHandle*>(luaL_testudata(L, index, MetatableName))) {
+        return Resolve(L, handle);
+    }
+    return TESForm::LookupByID(static_cast<FormID>(luaL_checkinteger(L, index)));
+}
+
+Actor* Sample::GetActorArg(lua_State* L, int index) {
+    auto* form = GetFormArg(L, index);
+    return form ? form->As<Actor>() : nullptr;
+}
+
+TESForm* Sample::ToForm(lua_State* L, int index) {
+    if (auto* handle = static_cast<FormHandle*>(luaL_testudata(L, index, MetatableName))) {
+        return Resolve(L, handle);
+    }
+    int isInteger = 0;
+    const auto formID = lua_tointegerx(L, index, &isInteger);
+    return isInteger ? TESForm::LookupByID(static_cast<FormID>(formID)) : nullptr;
+}
+
+Actor* Sample::ToActor(lua_State* L, int index) {
+    auto* form = ToForm(L, index);
+    return form ? form->As<Actor>() : nullptr;
+}
+
+FormID Sample::GetFormIDArg(lua_State* L, int index) {
+    if (auto* handle = static_cast<FormHandle*>(luaL_testudata(L, index, MetatableName))) {
+        return handle->formID;
+    }
+    return static_cast<FormID>(luaL_checkinteger(L, index));
+}
+
+ActorValue Sample::GetActorValueArg(lua_State* L, int index) {
+    if (lua_type(L, index) == LUA_TNUMBER) {
+        const auto value = luaL_checkinteger(L, index);
+        return value >= 0 && value < static_cast<lua_Integer>(ActorValue::kTotal) ? static_cast<ActorValue>(value)
+                                                                                    : ActorValue::kNone;
+    }
+    std::size_t length = 0;
+    const char* name = luaL_checklstring(L, index, &length);
+    return LookupActorValue({name, length});
+}
+
+void Sample::ApplyFormDeletions(lua_State* L) {
+    ApplyDeletions(L);
+}
+
+void Sample::InvalidateFormHandles() noexcept {
+    FormGeneration.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Sample::InitializeFormHandleEvents() {
+    static FormDeleteSink sink;
+    if (auto* events = ScriptEventSourceHolder::GetSingleton()) {
+        events->AddEventSink<TESFormDeleteEvent>(&sink);
+    }
+}
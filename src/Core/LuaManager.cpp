@@ -1,6 +1,17 @@
 #include "Core/PCH.h"
 #include "Core/LuaManager.h"
+#include "Core/ActorValues.h"
+#include "Core/FormIndex.h"
+#include "Core/GameEvents.h"
+#include "Core/Hash.h"
+#include "Core/HitEventQueue.h"
+#include "Core/HookRegistry.h"
+#include "Core/LuaAllocator.h"
+#include "Core/LuaBatch.h"
+#include "Core/LuaCommandQueue.h"
+#include "Core/LuaForms.h"
 #include "Core/SKSEManager.h"
+#include "Core/SpatialIndex.h"
 
 // Include Lua headers with proper extern "C" block to ensure correct linkage
 extern "C" {
@@ -17,13 +28,131 @@ extern "C" {
 
 namespace Sample {
 
+    namespace {
+        constexpr uint32_t BytecodeCacheMagic = 'HLBC';
+        constexpr uint32_t BytecodeCacheFormat = 1;
+
+        // Header written in front of every cached chunk. A chunk is reused only when every field matches.
+        struct BytecodeCacheHeader {
+            uint32_t magic;
+            uint32_t format;
+            uint32_t luaVersion;
+            uint32_t reserved;
+            uint64_t sourceSize;
+            int64_t sourceTime;
+            uint64_t sourceHash;
+        };
+
+        constexpr auto ConfigPath = "Data/SKSE/Plugins/HelloLua.ini";
+
+        size_t HistogramBucket(uint64_t micros) {
+            return static_cast<size_t>(std::ranges::lower_bound(LuaManager::GCHistogramLimits, micros) -
+                                       LuaManager::GCHistogramLimits.begin());
+        }
+
+        uint64_t ElapsedMicros(std::chrono::steady_clock::time_point start) {
+            return static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start)
+                    .count());
+        }
+
+        bool ReadWholeFile(const std::filesystem::path& path, std::string& out) {
+            std::ifstream file(path, std::ios::binary);
+            if (!file) {
+                return false;
+            }
+            file.seekg(0, std::ios::end);
+            const auto size = file.tellg();
+            if (size < 0) {
+                return false;
+            }
+            out.resize(static_cast<size_t>(size));
+            file.seekg(0, std::ios::beg);
+            file.read(out.data(), size);
+            return static_cast<bool>(file);
+        }
+
+        int WriteBytecode(lua_State*, const void* data, size_t size, void* userData) {
+            static_cast<std::string*>(userData)->append(static_cast<const char*>(data), size);
+            return 0;
+        }
+
+        // luaL_newstate installs a panic handler for us; lua_newstate does not
+        int LuaPanic(lua_State* L) {
+            SKSE::log::critical("Unprotected Lua error: {}", lua_isstring(L, -1) ? lua_tostring(L, -1) : "(no message)");
+            return 0;  // Lua aborts after the handler returns
+        }
+
+        // package.searchers entry that resolves modules on package.path and loads them through the bytecode cache
+        int CachedSearcher(lua_State* L) {
+            const char* name = luaL_checkstring(L, 1);
+
+            lua_getglobal(L, "package");
+            lua_getfield(L, -1, "searchpath");
+            lua_pushstring(L, name);
+            lua_getfield(L, -3, "path");
+            lua_call(L, 2, 2);
+            if (lua_isnil(L, -2)) {
+                return 1;  // error message listing the paths tried
+            }
+
+            const std::string path = lua_tostring(L, -2);
+            lua_settop(L, 1);
+            if (LuaManager::GetSingleton()->LoadScriptFile(L, path) != LUA_OK) {
+                return luaL_error(L, "error loading module '%s' from file '%s':\n\t%s", name, path.c_str(),
+                                  lua_tostring(L, -1));
+            }
+            lua_pushstring(L, path.c_str());
+            return 2;
+        }
+
+        constexpr auto HitBatchMetatable = "HelloLua.HitBatch";
+
+        // Userdata handed to OnHitBatch handlers; reads the records in the hit ring in place
+        struct HitBatchView {
+            uint64_t generation;
+            HitEventQueue::Batch batch;
+        };
+
+        // Bumped after every dispatch so views kept past their frame stop reading released records
+        uint64_t HitBatchGeneration = 0;
+
+        // Where the write batch sends writes: resolve the FormIDs it recorded and hand them to SKSEManager
+        bool ApplyWrite(const WriteBatch::Write& write) {
+            using Op = WriteBatch::Op;
+            auto* manager = SKSEManager::GetSingleton();
+            switch (write.op) {
+                case Op::kActorValue:
+                    if (auto* actor = RE::TESForm::LookupByID<RE::Actor>(write.target)) {
+                        manager->ForceActorValue(actor, static_cast<RE::ActorValue>(write.key), write.value);
+                        return true;
+                    }
+                    return false;
+                case Op::kEquip:
+                    return manager->EquipItem(RE::TESForm::LookupByID<RE::Actor>(write.target),
+                                              RE::TESForm::LookupByID(write.key), write.preventRemoval, write.silent);
+                case Op::kUnequip:
+                    return manager->UnequipItem(RE::TESForm::LookupByID<RE::Actor>(write.target),
+                                                RE::TESForm::LookupByID(write.key), write.silent);
+                case Op::kWeather:
+                    if (auto* weather = RE::TESForm::LookupByID<RE::TESWeather>(write.target)) {
+                        manager->ForceWeather(weather);
+                        return true;
+                    }
+                    return false;
+                default:
+                    return false;
+            }
+        }
+    }
+
     // Singleton instance
     LuaManager* LuaManager::GetSingleton() {
         static LuaManager instance;
         return &instance;
     }
 
-    LuaManager::LuaManager() : m_luaState(nullptr) {
+    LuaManager::LuaManager() : m_luaState(nullptr), m_writeBatch(ApplyWrite) {
         // Constructor
     }
 
@@ -37,22 +166,33 @@ namespace Sample {
             Close();
         }
 
-        // Create a new Lua state
-        m_luaState = luaL_newstate();
+        LoadConfig();
+
+        // Create a new Lua state backed by the pooled allocator
+        m_allocator = std::make_unique<LuaAllocator>();
+        m_luaState = lua_newstate(LuaAllocator::Allocate, m_allocator.get());
         if (!m_luaState) {
             SKSE::log::error("Failed to create Lua state");
+            m_allocator.reset();
             return false;
         }
+        lua_atpanic(m_luaState, LuaPanic);
 
         // Open standard libraries
         luaL_openlibs(m_luaState);
 
+        // Take over collector pacing from Lua
+        ApplyGCMode();
+
         // Register our custom functions
         RegisterStandardFunctions();
         
         // Register Skyrim-specific functions
         RegisterGameFunctions();
 
+        // Route require() through the bytecode cache
+        InstallCachedSearcher();
+
         // Set up paths for scripts
         std::string pluginsPath = "SKSE/Plugins/Scripts/";  // Removed "Data/" prefix
         std::string dataPath;
@@ -65,15 +205,73 @@ namespace Sample {
         AddPackagePath(dataPath + pluginsPath + "?.lua");
         AddPackagePath(dataPath + pluginsPath + "?/init.lua");
 
+        // Compiled chunks live next to the scripts they were built from
+        m_cacheDirectory = std::filesystem::path(dataPath + pluginsPath) / ".cache";
+        std::error_code ec;
+        std::filesystem::create_directories(m_cacheDirectory, ec);
+        if (ec) {
+            SKSE::log::warn("Unable to create bytecode cache directory {}: {}", m_cacheDirectory.string(),
+                            ec.message());
+        }
+
         SKSE::log::info("Lua environment initialized successfully");
         return true;
     }
 
     void LuaManager::Close() {
         if (m_luaState) {
+            ClearChunkCache();
+            m_updateDispatcher.Clear();
+            m_timers.Clear();
+            m_timerRemainderMs = 0.0;
+            m_tasks.Clear();
+            m_eventBus.Clear();
+            m_persistence.Clear();
+            m_callBridge.Reset();
+            m_writeBatch.Clear();
+            m_batchScratch = {};
+            HookRegistry::GetSingleton()->Reset();
+            GameEvents::GetSingleton()->Reset();
+            LuaCommandQueue::GetSingleton()->Clear();
+            LogGCStats();
             lua_close(m_luaState);
             m_luaState = nullptr;
         }
+        if (m_allocator) {
+            m_allocator->LogStats();
+            m_allocator.reset();
+        }
+    }
+
+    void LuaManager::SavePersistentTables(ByteWriter& out) {
+        if (m_luaState) {
+            m_persistence.Save(m_luaState, out);
+        }
+    }
+
+    bool LuaManager::LoadPersistentTables(std::span<const std::byte> data,
+                                          const LuaPersistence::FormResolver& resolve) {
+        return m_luaState && m_persistence.Load(m_luaState, data, resolve);
+    }
+
+    void LuaManager::RevertPersistentTables() {
+        if (m_luaState) {
+            m_persistence.Revert(m_luaState);
+        }
+    }
+
+    float LuaManager::CallFromPapyrus(const RE::BSFixedString& function, RE::TESForm* target,
+                                      std::span<const float> args) {
+        return m_luaState ? m_callBridge.Call(m_luaState, function, target, args) : 0.0f;
+    }
+
+    void LuaManager::CallBatchFromPapyrus(const RE::BSFixedString& function, std::span<RE::TESForm* const> targets,
+                                          std::span<const float> args, std::vector<float>& out) {
+        if (m_luaState) {
+            m_callBridge.CallBatch(m_luaState, function, targets, args, out);
+        } else {
+            out.assign(targets.size(), 0.0f);
+        }
     }
 
     bool LuaManager::ExecuteScript(const std::string& scriptPath) {
@@ -88,8 +286,8 @@ namespace Sample {
             return false;
         }
 
-        // Use luaL_loadfile and lua_pcall instead of luaL_dofile for better error handling
-        if (luaL_loadfile(m_luaState, fullPath.c_str()) != 0) {
+        // Load through the bytecode cache and use lua_pcall instead of luaL_dofile for better error handling
+        if (LoadScriptFile(m_luaState, fullPath) != LUA_OK) {
             SKSE::log::error("Failed to load Lua script: {}", lua_tostring(m_luaState, -1));
             lua_pop(m_luaState, 1);  // pop error message
             return false;
@@ -104,15 +302,14 @@ namespace Sample {
         return true;
     }
 
-    bool LuaManager::ExecuteString(const std::string& luaCode) {
+    bool LuaManager::ExecuteString(std::string_view luaCode, const char* chunkName) {
         if (!m_luaState) {
             SKSE::log::error("Cannot execute string: Lua state not initialized");
             return false;
         }
 
-        // Use luaL_loadstring and lua_pcall instead of luaL_dostring for Lua 5.1 compatibility
-        int loadResult = luaL_loadstring(m_luaState, luaCode.c_str());
-        if (loadResult != 0) {
+        // Repeated snippets come straight from the compiled-chunk cache; new ones go through luaL_loadbuffer
+        if (!m_chunkCache.Push(m_luaState, luaCode, chunkName)) {
             SKSE::log::error("Failed to load Lua string: {}", lua_tostring(m_luaState, -1));
             lua_pop(m_luaState, 1);  // pop error message
             return false;
@@ -128,6 +325,355 @@ namespace Sample {
         return true;
     }
 
+    void LuaManager::SetChunkCacheCapacity(size_t capacity) {
+        m_chunkCache.SetCapacity(m_luaState, capacity);
+    }
+
+    void LuaManager::ClearChunkCache() {
+        // Registry references die with the state, so only the bookkeeping needs clearing
+        if (m_chunkCache.Size() != 0) {
+            const auto& stats = m_chunkCache.GetStats();
+            SKSE::log::debug("ExecuteString chunk cache: {} hits, {} misses, {} evictions", stats.hits, stats.misses,
+                             stats.evictions);
+        }
+        m_chunkCache.Clear();
+    }
+
+    int LuaManager::LoadScriptFile(lua_State* L, const std::string& fullPath) {
+        const auto start = std::chrono::steady_clock::now();
+        const std::string chunkName = "@" + fullPath;
+
+        std::string source;
+        if (!ReadWholeFile(fullPath, source)) {
+            lua_pushfstring(L, "cannot read %s", fullPath.c_str());
+            return LUA_ERRFILE;
+        }
+
+        std::error_code ec;
+        const auto sourceTime = std::filesystem::last_write_time(fullPath, ec).time_since_epoch().count();
+
+        BytecodeCacheHeader key{};
+        key.magic = BytecodeCacheMagic;
+        key.format = BytecodeCacheFormat;
+        key.luaVersion = LUA_VERSION_NUM;
+        key.sourceSize = source.size();
+        key.sourceTime = ec ? 0 : static_cast<int64_t>(sourceTime);
+        key.sourceHash = HashBytes(source);
+
+        const auto cachePath = m_cacheDirectory / std::format("{:016x}.luac", HashBytes(fullPath));
+
+        // Try the cached chunk first
+        std::string cached;
+        if (!m_cacheDirectory.empty() && ReadWholeFile(cachePath, cached) && cached.size() > sizeof(key) &&
+            std::memcmp(cached.data(), &key, sizeof(key)) == 0) {
+            if (luaL_loadbufferx(L, cached.data() + sizeof(key), cached.size() - sizeof(key), chunkName.c_str(),
+                                 "b") == LUA_OK) {
+                ++m_bytecodeStats.hits;
+                m_bytecodeStats.loadMicros += ElapsedMicros(start);
+                return LUA_OK;
+            }
+            lua_pop(L, 1);  // stale or foreign bytecode, fall back to the source
+        }
+
+        ++m_bytecodeStats.misses;
+
+        // Skip a UTF-8 BOM and a leading '#' line like luaL_loadfile does, keeping the newline for line numbers
+        std::string_view text = source;
+        if (text.starts_with("\xEF\xBB\xBF")) {
+            text.remove_prefix(3);
+        }
+        if (text.starts_with('#')) {
+            text.remove_prefix(std::min(text.find('\n'), text.size()));
+        }
+
+        const auto parseStart = std::chrono::steady_clock::now();
+        const int status = luaL_loadbufferx(L, text.data(), text.size(), chunkName.c_str(), "t");
+        m_bytecodeStats.parseMicros += ElapsedMicros(parseStart);
+        if (status != LUA_OK) {
+            m_bytecodeStats.loadMicros += ElapsedMicros(start);
+            return status;
+        }
+
+        // Keep debug info so error messages still carry file and line
+        std::string bytecode(reinterpret_cast<const char*>(&key), sizeof(key));
+        if (!m_cacheDirectory.empty() && lua_dump(L, WriteBytecode, &bytecode, 0) == 0) {
+            auto tempPath = cachePath;
+            tempPath += ".tmp";
+            std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+            out.write(bytecode.data(), static_cast<std::streamsize>(bytecode.size()));
+            out.close();
+            if (out) {
+                std::filesystem::rename(tempPath, cachePath, ec);
+            }
+            if (!out || ec) {
+                SKSE::log::debug("Unable to write bytecode cache for {}", fullPath);
+                std::filesystem::remove(tempPath, ec);
+            }
+        }
+
+        m_bytecodeStats.loadMicros += ElapsedMicros(start);
+        return LUA_OK;
+    }
+
+    void LuaManager::LogBytecodeCacheStats() const {
+        SKSE::log::info("Bytecode cache: {} hits, {} misses, {} us loading, {} us compiling",
+                        m_bytecodeStats.hits, m_bytecodeStats.misses, m_bytecodeStats.loadMicros,
+                        m_bytecodeStats.parseMicros);
+    }
+
+    void LuaManager::InstallCachedSearcher() {
+        // Insert ahead of the stock Lua file searcher so require() picks up cached bytecode
+        lua_getglobal(m_luaState, "package");
+        lua_getfield(m_luaState, -1, "searchers");
+        const auto count = static_cast<lua_Integer>(lua_rawlen(m_luaState, -1));
+        for (lua_Integer i = count; i >= 2; --i) {
+            lua_rawgeti(m_luaState, -1, i);
+            lua_rawseti(m_luaState, -2, i + 1);
+        }
+        lua_pushcfunction(m_luaState, CachedSearcher);
+        lua_rawseti(m_luaState, -2, 2);
+        lua_pop(m_luaState, 2);
+    }
+
+    void LuaManager::LoadConfig() {
+        const auto iniPath = std::filesystem::absolute(ConfigPath).string();
+        const GCConfig defaults;
+
+        char mode[32]{};
+        GetPrivateProfileStringA("GC", "Mode", "incremental", mode, sizeof(mode), iniPath.c_str());
+        m_gcConfig.mode = _stricmp(mode, "generational") == 0 ? GCMode::kGenerational : GCMode::kIncremental;
+        m_gcConfig.budgetMicros =
+            GetPrivateProfileIntA("GC", "BudgetMicroseconds", defaults.budgetMicros, iniPath.c_str());
+        m_gcConfig.stepKB = std::max(1u, GetPrivateProfileIntA("GC", "StepKB", defaults.stepKB, iniPath.c_str()));
+        m_gcConfig.pause = std::max(100u, GetPrivateProfileIntA("GC", "Pause", defaults.pause, iniPath.c_str()));
+
+        SKSE::log::info("Lua GC: {} mode, {} us budget per frame, {} KB steps, {}% pause",
+                        m_gcConfig.mode == GCMode::kGenerational ? "generational" : "incremental",
+                        m_gcConfig.budgetMicros, m_gcConfig.stepKB, m_gcConfig.pause);
+
+        m_commandBudgetMicros = GetPrivateProfileIntA("Commands", "BudgetMicroseconds", 2000, iniPath.c_str());
+    }
+
+    void LuaManager::ConfigureGC(const GCConfig& config) {
+        m_gcConfig = config;
+        if (m_luaState) {
+            ApplyGCMode();
+        }
+    }
+
+    void LuaManager::ApplyGCMode() {
+        // Automatic collection is left in place only as a safety net for scripts that allocate heavily within a
+        // single frame; StepGC normally starts every cycle long before Lua would on its own
+        if (m_gcConfig.mode == GCMode::kGenerational) {
+            lua_gc(m_luaState, LUA_GCGEN, 100, 0);
+        } else {
+            lua_gc(m_luaState, LUA_GCINC, 1000, 0, 0);
+        }
+        m_gcCycleActive = false;
+        m_gcBaselineKB = lua_gc(m_luaState, LUA_GCCOUNT);
+        m_gcMicrosPerKB = 0.0;
+    }
+
+    void LuaManager::Update(float deltaTime) {
+        if (!m_luaState) {
+            return;
+        }
+
+        ApplyFormDeletions(m_luaState);
+        FireTimers(deltaTime);
+        DispatchHitBatch();
+        HookRegistry::GetSingleton()->Deliver(m_luaState);
+        DrainCommands();
+        m_tasks.Tick(m_luaState, deltaTime);
+        m_updateDispatcher.Dispatch(m_luaState, deltaTime);
+
+        // Everything scripts deferred this frame reaches the engine in one pass
+        m_writeBatch.Flush();
+
+        // Collect last so this frame's garbage is already visible
+        StepGC();
+    }
+
+    void LuaManager::FireTimers(float deltaTime) {
+        // Carry the sub-millisecond remainder so short frames still add up
+        m_timerRemainderMs += static_cast<double>(deltaTime) * 1000.0;
+        const auto ticks = static_cast<uint64_t>(m_timerRemainderMs);
+        m_timerRemainderMs -= static_cast<double>(ticks);
+
+        lua_State* L = m_luaState;
+        m_timers.Advance(ticks, [L](TimerWheel::TimerId, uint32_t functionRef, bool repeating) {
+            lua_rawgeti(L, LUA_REGISTRYINDEX, static_cast<int>(functionRef));
+            if (!repeating) {
+                luaL_unref(L, LUA_REGISTRYINDEX, static_cast<int>(functionRef));
+            }
+            if (lua_pcall(L, 0, 0, 0) != LUA_OK) {
+                SKSE::log::error("Error in timer callback: {}", lua_tostring(L, -1));
+                lua_pop(L, 1);  // pop error message
+            }
+        });
+    }
+
+    void LuaManager::DispatchHitBatch() {
+        auto* queue = HitEventQueue::GetSingleton();
+        const auto batch = queue->Peek();
+        if (batch.dropped != 0) {
+            SKSE::log::warn("Hit ring overflowed, {} hits dropped", batch.dropped);
+        }
+
+        // Building the view costs an allocation, so it is skipped while nothing listens; the hits are still released
+        const auto id = m_eventBus.Find("OnHitBatch");
+        const bool listening = (id && m_eventBus.HasHandlers(*id)) || m_tasks.HasWaiters("OnHitBatch");
+        if (batch.count != 0 && listening) {
+            auto* view = static_cast<HitBatchView*>(lua_newuserdata(m_luaState, sizeof(HitBatchView)));
+            *view = {HitBatchGeneration, batch};
+            luaL_setmetatable(m_luaState, HitBatchMetatable);
+            DispatchEvent(m_luaState, "OnHitBatch", lua_gettop(m_luaState), 1);
+            lua_pop(m_luaState, 1);
+            ++HitBatchGeneration;
+        }
+        queue->Release(batch);
+    }
+
+    void LuaManager::DrainCommands() {
+        // At least one command runs per frame, so a zero budget still makes progress
+        auto* queue = LuaCommandQueue::GetSingleton();
+        const auto start = LuaCommandQueue::NowMicros();
+        for (auto now = start; const auto* command = queue->Front();) {
+            switch (command->type) {
+                case LuaCommandQueue::Type::kGameEvent:
+                    GameEvents::GetSingleton()->Dispatch(m_luaState, command->gameEvent);
+                    break;
+                case LuaCommandQueue::Type::kEvent: {
+                    const auto firstArg = lua_gettop(m_luaState) + 1;
+                    for (std::uint8_t i = 0; i < command->argCount; ++i) {
+                        lua_pushnumber(m_luaState, static_cast<lua_Number>(command->args[i]));
+                    }
+                    DispatchEventIgnoringCase(m_luaState, command->name.c_str(), firstArg, command->argCount);
+                    lua_settop(m_luaState, firstArg - 1);
+                    break;
+                }
+            }
+            queue->Pop(now);
+
+            now = LuaCommandQueue::NowMicros();
+            if (now - start >= m_commandBudgetMicros) {
+                if (queue->Front()) {
+                    queue->NoteBacklog();
+                }
+                break;
+            }
+        }
+    }
+
+    bool LuaManager::DispatchEvent(lua_State* L, std::string_view eventName, int firstArg, int nargs) {
+        bool handled = false;
+        if (const auto id = m_eventBus.Find(eventName); id && m_eventBus.HasHandlers(*id)) {
+            m_eventBus.Dispatch(L, *id, firstArg, nargs);
+            handled = true;
+        }
+        if (m_tasks.SignalEvent(L, eventName, firstArg, nargs) != 0) {
+            handled = true;
+        }
+        return handled;
+    }
+
+    bool LuaManager::DispatchEvent(std::string_view eventName) {
+        if (!m_luaState) {
+            return false;
+        }
+        return DispatchEvent(m_luaState, eventName, lua_gettop(m_luaState) + 1, 0);
+    }
+
+    bool LuaManager::DispatchEventIgnoringCase(lua_State* L, std::string_view eventName, int firstArg, int nargs) {
+        // Handlers may register events while running, so take copies of the matching names before dispatching
+        std::vector<EventBus::EventId> ids;
+        m_eventBus.FindIgnoringCase(eventName, ids);
+        std::vector<std::string> names;
+        names.reserve(ids.size());
+        for (const auto id : ids) {
+            names.push_back(m_eventBus.GetName(id));
+        }
+
+        bool handled = false;
+        for (const auto& name : names) {
+            handled = DispatchEvent(L, name, firstArg, nargs) || handled;
+        }
+        return handled;
+    }
+
+    void LuaManager::StepGC() {
+        if (!m_gcCycleActive) {
+            const int64_t currentKB = lua_gc(m_luaState, LUA_GCCOUNT);
+            if (currentKB * 100 < static_cast<int64_t>(m_gcBaselineKB) * m_gcConfig.pause) {
+                return;
+            }
+            m_gcCycleActive = true;
+        }
+
+        // Each slice is sized from what recent slices cost per KB, so the first one is held to the budget as well. A
+        // cycle still advances by at least 1 KB a frame, and the atomic phase cannot be split at all.
+        const auto frameStart = std::chrono::steady_clock::now();
+        uint64_t frameMicros = 0;
+        do {
+            int stepKB = static_cast<int>(m_gcConfig.stepKB);
+            if (m_gcMicrosPerKB > 0.0) {
+                const double fits = static_cast<double>(m_gcConfig.budgetMicros - frameMicros) / m_gcMicrosPerKB;
+                stepKB = std::clamp(static_cast<int>(fits), 1, stepKB);
+            }
+
+            const auto stepStart = std::chrono::steady_clock::now();
+            const bool finished = lua_gc(m_luaState, LUA_GCSTEP, stepKB) != 0;
+            const std::chrono::duration<double, std::micro> step = std::chrono::steady_clock::now() - stepStart;
+            const auto stepMicros = static_cast<uint64_t>(step.count());
+
+            ++m_gcStats.steps;
+            ++m_gcStats.stepHistogram[HistogramBucket(stepMicros)];
+            m_gcStats.maxStepMicros = std::max(m_gcStats.maxStepMicros, static_cast<uint32_t>(stepMicros));
+
+            // A decaying maximum: one slow slice shrinks the next few without keeping them small for good
+            m_gcMicrosPerKB = std::max(step.count() / stepKB, m_gcMicrosPerKB * 0.75);
+
+            // Every generational step is a complete minor (or major) collection
+            if (finished || m_gcConfig.mode == GCMode::kGenerational) {
+                ++m_gcStats.cycles;
+                m_gcCycleActive = false;
+                m_gcBaselineKB = lua_gc(m_luaState, LUA_GCCOUNT);
+            }
+            frameMicros = ElapsedMicros(frameStart);
+            // Don't start another slice once not even 1 KB of work is expected to fit
+        } while (m_gcCycleActive && frameMicros < m_gcConfig.budgetMicros &&
+                 static_cast<double>(m_gcConfig.budgetMicros - frameMicros) >= m_gcMicrosPerKB);
+
+        ++m_gcStats.frames;
+        m_gcStats.totalMicros += frameMicros;
+        ++m_gcStats.frameHistogram[HistogramBucket(frameMicros)];
+        m_gcStats.maxFrameMicros = std::max(m_gcStats.maxFrameMicros, static_cast<uint32_t>(frameMicros));
+    }
+
+    void LuaManager::LogGCStats() const {
+        if (m_gcStats.frames == 0) {
+            return;
+        }
+
+        auto formatHistogram = [](const auto& histogram) {
+            std::string text;
+            for (size_t i = 0; i < histogram.size(); ++i) {
+                if (i < GCHistogramLimits.size()) {
+                    text += std::format("<={}us:{} ", GCHistogramLimits[i], histogram[i]);
+                } else {
+                    text += std::format(">{}us:{}", GCHistogramLimits.back(), histogram[i]);
+                }
+            }
+            return text;
+        };
+
+        SKSE::log::info("Lua GC: {} cycles over {} frames, {} steps, {} us total, worst frame {} us, worst step {} us",
+                        m_gcStats.cycles, m_gcStats.frames, m_gcStats.steps, m_gcStats.totalMicros,
+                        m_gcStats.maxFrameMicros, m_gcStats.maxStepMicros);
+        SKSE::log::info("  per-frame GC time: {}", formatHistogram(m_gcStats.frameHistogram));
+        SKSE::log::info("  pause lengths:     {}", formatHistogram(m_gcStats.stepHistogram));
+    }
+
     bool LuaManager::RegisterFunction(const char* name, LuaCFunction func) {
         if (!m_luaState) {
             SKSE::log::error("Cannot register function: Lua state not initialized");
@@ -164,16 +710,14 @@ namespace Sample {
     // Helper functions to reduce code duplication in Lua function bindings
     // -------------------------------------------------------------------------
 
-    // Helper to get an Actor from Form ID
+    // Helper to get an Actor from a Form handle or Form ID
     static RE::Actor* GetActorParam(lua_State* L, int index) {
-        const RE::FormID formId = static_cast<RE::FormID>(luaL_checkinteger(L, index));
-        return RE::TESForm::LookupByID<RE::Actor>(formId);
+        return GetActorArg(L, index);
     }
 
-    // Helper to get a Form from Form ID
+    // Helper to get a Form from a Form handle or Form ID
     static RE::TESForm* GetFormParam(lua_State* L, int index) {
-        const RE::FormID formId = static_cast<RE::FormID>(luaL_checkinteger(L, index));
-        return RE::TESForm::LookupByID(formId);
+        return GetFormArg(L, index);
     }
 
     // -------------------------------------------------------------------------
@@ -261,9 +805,63 @@ namespace Sample {
         return 1;
     }
 
+    // Rolling hit windows
+    static int GetHitsInLast(lua_State* L) {
+        auto actor = GetActorParam(L, 1);
+        const auto seconds = static_cast<uint32_t>(std::max<lua_Integer>(luaL_checkinteger(L, 2), 1));
+        lua_pushinteger(L, actor ? Sample::SKSEManager::GetSingleton()->GetHitsInLast(actor, seconds) : 0);
+        return 1;
+    }
+
+    static int GetHitRate(lua_State* L) {
+        auto actor = GetActorParam(L, 1);
+        const auto seconds = static_cast<uint32_t>(std::max<lua_Integer>(luaL_optinteger(L, 2, 10), 1));
+        lua_pushnumber(L, actor ? Sample::SKSEManager::GetSingleton()->GetHitRate(actor, seconds) : 0.0f);
+        return 1;
+    }
+
+    static int GetTimeSinceLastHit(lua_State* L) {
+        auto actor = GetActorParam(L, 1);
+        const auto elapsed = actor ? Sample::SKSEManager::GetSingleton()->GetTimeSinceLastHit(actor) : std::nullopt;
+        if (elapsed) {
+            lua_pushnumber(L, *elapsed);
+        } else {
+            lua_pushnil(L);
+        }
+        return 1;
+    }
+
+    // Aggregates over tracked actors
+    static int GetHitStats(lua_State* L) {
+        const auto* manager = Sample::SKSEManager::GetSingleton();
+        lua_createtable(L, 0, 2);
+        lua_pushinteger(L, static_cast<lua_Integer>(manager->GetTrackedActorCount()));
+        lua_setfield(L, -2, "tracked");
+        lua_pushinteger(L, static_cast<lua_Integer>(manager->GetTotalHits()));
+        lua_setfield(L, -2, "totalHits");
+        return 1;
+    }
+
+    // Returns the actor handles and a parallel array of their counts
+    static int GetTopHitActors(lua_State* L) {
+        const auto count = static_cast<std::size_t>(std::clamp<lua_Integer>(luaL_optinteger(L, 1, 10), 0, 1024));
+        std::vector<std::pair<RE::Actor*, int32_t>> top;
+        Sample::SKSEManager::GetSingleton()->GetTopHitActors(count, top);
+
+        lua_createtable(L, static_cast<int>(top.size()), 0);
+        lua_createtable(L, static_cast<int>(top.size()), 0);
+        for (std::size_t i = 0; i < top.size(); ++i) {
+            PushFormHandle(L, top[i].first);
+            lua_rawseti(L, -3, static_cast<lua_Integer>(i + 1));
+            lua_pushinteger(L, top[i].second);
+            lua_rawseti(L, -2, static_cast<lua_Integer>(i + 1));
+        }
+        return 2;
+    }
+
     // Actor Management
     static int GetActorByID(lua_State* L) {
-        const RE::FormID formId = static_cast<RE::FormID>(luaL_checkinteger(L, 1));
+        const RE::FormID formId = GetFormIDArg(L, 1);
         auto actor = Sample::SKSEManager::GetSingleton()->GetActorFromHandle(formId);
         if (actor) {
             lua_pushinteger(L, actor->GetFormID());
@@ -286,13 +884,9 @@ namespace Sample {
     }
 
     // Player functions
+    // A handle, so it compares equal to the handles events pass for the player
     static int GetPlayerActor(lua_State* L) {
-        auto player = Sample::SKSEManager::GetSingleton()->GetPlayer();
-        if (player) {
-            lua_pushinteger(L, player->GetFormID());
-        } else {
-            lua_pushnil(L);
-        }
+        PushFormHandle(L, Sample::SKSEManager::GetSingleton()->GetPlayer());
         return 1;
     }
 
@@ -304,11 +898,15 @@ namespace Sample {
             return 1;
         }
         
-        const char* avName = luaL_checkstring(L, 2);
+        const auto av = GetActorValueArg(L, 2);
         float value = static_cast<float>(luaL_checknumber(L, 3));
-        
-        Sample::SKSEManager::GetSingleton()->ForceActorValue(actor, avName, value);
-        lua_pushboolean(L, true);
+        if (av == RE::ActorValue::kNone) {
+            SKSE::log::error("Invalid actor value: {}", luaL_tolstring(L, 2, nullptr));
+            lua_pushboolean(L, false);
+            return 1;
+        }
+
+        lua_pushboolean(L, LuaManager::GetSingleton()->GetWriteBatch().SetActorValue(actor, av, value));
         return 1;
     }
 
@@ -319,12 +917,85 @@ namespace Sample {
             return 1;
         }
         
-        const char* avName = luaL_checkstring(L, 2);
-        float value = Sample::SKSEManager::GetSingleton()->GetActorValue(actor, avName);
+        const auto av = GetActorValueArg(L, 2);
+        if (av == RE::ActorValue::kNone) {
+            SKSE::log::error("Invalid actor value: {}", luaL_tolstring(L, 2, nullptr));
+            lua_pushnumber(L, 0.0);
+            return 1;
+        }
+        float value = Sample::SKSEManager::GetSingleton()->GetActorValue(actor, av);
         lua_pushnumber(L, value);
         return 1;
     }
 
+    // Batch queries: one call per array instead of one per actor. Entries that do not resolve come back as false so
+    // the result stays a proper sequence.
+
+    static int GetActorValues(lua_State* L) {
+        auto& actors = LuaManager::GetSingleton()->GetBatchScratch().actors;
+        const auto count = ReadBatchArray(L, 1, actors, ToActor);
+        const auto av = GetActorValueArg(L, 2);
+        auto* manager = Sample::SKSEManager::GetSingleton();
+
+        PushBatchResults(L, count, [&](std::size_t i) {
+            if (!actors[i] || av == RE::ActorValue::kNone) {
+                return false;
+            }
+            lua_pushnumber(L, manager->GetActorValue(actors[i], av));
+            return true;
+        });
+        return 1;
+    }
+
+    static int GetActorDistances(lua_State* L) {
+        auto& actors = LuaManager::GetSingleton()->GetBatchScratch().actors;
+        auto* origin = GetActorParam(L, 1);
+        const auto count = ReadBatchArray(L, 2, actors, ToActor);
+
+        const auto originPosition = origin ? origin->GetPosition() : RE::NiPoint3{};
+        PushBatchResults(L, count, [&](std::size_t i) {
+            if (!origin || !actors[i]) {
+                return false;
+            }
+            lua_pushnumber(L, originPosition.GetDistance(actors[i]->GetPosition()));
+            return true;
+        });
+        return 1;
+    }
+
+    static int GetHitCounts(lua_State* L) {
+        auto& scratch = LuaManager::GetSingleton()->GetBatchScratch();
+        auto& actors = scratch.actors;
+        auto& counts = scratch.counts;
+        const auto count = ReadBatchArray(L, 1, actors, ToActor);
+        Sample::SKSEManager::GetSingleton()->GetHitCounts(actors, counts);
+
+        PushBatchResults(L, count, [&](std::size_t i) {
+            if (!counts[i]) {
+                return false;
+            }
+            lua_pushinteger(L, *counts[i]);
+            return true;
+        });
+        return 1;
+    }
+
+    static int GetFormNames(lua_State* L) {
+        auto& forms = LuaManager::GetSingleton()->GetBatchScratch().forms;
+        const auto count = ReadBatchArray(L, 1, forms, ToForm);
+
+        PushBatchResults(L, count, [&](std::size_t i) {
+            if (!forms[i]) {
+                return false;
+            }
+            // Same lookup as GetFormName, without the std::string copy
+            auto* fullName = forms[i]->As<RE::TESFullName>();
+            lua_pushstring(L, fullName ? fullName->GetFullName() : "");
+            return true;
+        });
+        return 1;
+    }
+
     // Equipment functions
     static int EquipItem(lua_State* L) {
         auto actor = GetActorParam(L, 1);
@@ -338,7 +1009,7 @@ namespace Sample {
         bool preventRemoval = lua_toboolean(L, 3);
         bool silent = lua_toboolean(L, 4);
         
-        bool success = Sample::SKSEManager::GetSingleton()->EquipItem(actor, item, preventRemoval, silent);
+        bool success = LuaManager::GetSingleton()->GetWriteBatch().EquipItem(actor, item, preventRemoval, silent);
         lua_pushboolean(L, success);
         return 1;
     }
@@ -354,7 +1025,7 @@ namespace Sample {
         
         bool silent = lua_toboolean(L, 3);
         
-        bool success = Sample::SKSEManager::GetSingleton()->UnequipItem(actor, item, silent);
+        bool success = LuaManager::GetSingleton()->GetWriteBatch().UnequipItem(actor, item, silent);
         lua_pushboolean(L, success);
         return 1;
     }
@@ -370,17 +1041,75 @@ namespace Sample {
         float searchRadius = static_cast<float>(luaL_checknumber(L, 2));
         
         auto ref = Sample::SKSEManager::GetSingleton()->FindClosestReferenceOfType(form, searchRadius);
-        if (ref) {
-            lua_pushinteger(L, ref->GetFormID());
-        } else {
-            lua_pushnil(L);
+        PushFormHandle(L, ref);
+        return 1;
+    }
+
+    // Build a spatial query from an optional base form and an optional origin reference (the player by default)
+    static bool GetSpatialQuery(lua_State* L, float radius, int baseIndex, int originIndex,
+                                SpatialIndex::Query& query) {
+        RE::TESObjectREFR* origin = RE::PlayerCharacter::GetSingleton();
+        if (!lua_isnoneornil(L, originIndex)) {
+            auto* form = GetFormParam(L, originIndex);
+            origin = form ? form->AsReference() : nullptr;
+        }
+
+        RE::FormID baseId = 0;
+        if (!lua_isnoneornil(L, baseIndex)) {
+            auto* base = GetFormParam(L, baseIndex);
+            if (auto* ref = base ? base->AsReference() : nullptr) {
+                base = ref->GetBaseObject();
+            }
+            if (!base) {
+                return false;
+            }
+            baseId = base->GetFormID();
+        }
+
+        if (!origin) {
+            return false;
+        }
+        query = SpatialIndex::QueryAround(origin, radius, baseId);
+        return true;
+    }
+
+    static void PushSpatialHits(lua_State* L, const std::vector<SpatialIndex::Hit>& hits) {
+        lua_createtable(L, static_cast<int>(hits.size()), 0);
+        int index = 1;
+        for (const auto& hit : hits) {
+            if (auto* ref = RE::TESForm::LookupByID<RE::TESObjectREFR>(hit.formID)) {
+                PushFormHandle(L, ref);
+                lua_rawseti(L, -2, index++);
+            }
         }
+    }
+
+    static int FindReferencesInRadius(lua_State* L) {
+        const auto radius = static_cast<float>(luaL_checknumber(L, 1));
+        SpatialIndex::Query query;
+        std::vector<SpatialIndex::Hit> hits;
+        if (GetSpatialQuery(L, radius, 2, 3, query)) {
+            SpatialIndex::GetSingleton()->FindInRadius(query, hits);
+        }
+        PushSpatialHits(L, hits);
+        return 1;
+    }
+
+    static int FindNearestReferences(lua_State* L) {
+        const auto count = static_cast<std::size_t>(std::max<lua_Integer>(luaL_checkinteger(L, 1), 0));
+        const auto radius = static_cast<float>(luaL_optnumber(L, 2, std::numeric_limits<float>::max()));
+        SpatialIndex::Query query;
+        std::vector<SpatialIndex::Hit> hits;
+        if (GetSpatialQuery(L, radius, 3, 4, query)) {
+            SpatialIndex::GetSingleton()->FindNearest(query, count, hits);
+        }
+        PushSpatialHits(L, hits);
         return 1;
     }
 
     // Quest and game state
     static int SetQuestStage(lua_State* L) {
-        const RE::FormID questId = static_cast<RE::FormID>(luaL_checkinteger(L, 1));
+        const RE::FormID questId = GetFormIDArg(L, 1);
         uint16_t stage = static_cast<uint16_t>(luaL_checkinteger(L, 2));
         
         bool success = Sample::SKSEManager::GetSingleton()->SetQuestStage(questId, stage);
@@ -389,7 +1118,7 @@ namespace Sample {
     }
 
     static int GetQuestStage(lua_State* L) {
-        const RE::FormID questId = static_cast<RE::FormID>(luaL_checkinteger(L, 1));
+        const RE::FormID questId = GetFormIDArg(L, 1);
         
         uint16_t stage = Sample::SKSEManager::GetSingleton()->GetQuestStage(questId);
         lua_pushinteger(L, stage);
@@ -397,7 +1126,7 @@ namespace Sample {
     }
 
     static int IsQuestCompleted(lua_State* L) {
-        const RE::FormID questId = static_cast<RE::FormID>(luaL_checkinteger(L, 1));
+        const RE::FormID questId = GetFormIDArg(L, 1);
         
         bool completed = Sample::SKSEManager::GetSingleton()->IsQuestCompleted(questId);
         lua_pushboolean(L, completed);
@@ -416,7 +1145,7 @@ namespace Sample {
     }
 
     static int ForceWeather(lua_State* L) {
-        const RE::FormID weatherId = static_cast<RE::FormID>(luaL_checkinteger(L, 1));
+        const RE::FormID weatherId = GetFormIDArg(L, 1);
         
         auto weather = RE::TESForm::LookupByID<RE::TESWeather>(weatherId);
         if (!weather) {
@@ -424,8 +1153,40 @@ namespace Sample {
             return 1;
         }
         
-        Sample::SKSEManager::GetSingleton()->ForceWeather(weather);
-        lua_pushboolean(L, true);
+        lua_pushboolean(L, LuaManager::GetSingleton()->GetWriteBatch().ForceWeather(weather));
+        return 1;
+    }
+
+    // Deferred writes: SetActorValue, EquipItem, UnequipItem and ForceWeather are coalesced and applied at the end of
+    // the frame
+    static int SetDeferredWrites(lua_State* L) {
+        LuaManager::GetSingleton()->GetWriteBatch().SetDeferred(lua_toboolean(L, 1));
+        return 0;
+    }
+
+    static int FlushWrites(lua_State* L) {
+        LuaManager::GetSingleton()->GetWriteBatch().Flush();
+        return 0;
+    }
+
+    static int GetWriteStats(lua_State* L) {
+        const auto& batch = LuaManager::GetSingleton()->GetWriteBatch();
+        const auto& stats = batch.GetStats();
+        lua_createtable(L, 0, 7);
+        lua_pushboolean(L, batch.IsDeferred());
+        lua_setfield(L, -2, "deferred");
+        lua_pushinteger(L, static_cast<lua_Integer>(batch.Size()));
+        lua_setfield(L, -2, "pending");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.issued));
+        lua_setfield(L, -2, "issued");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.applied));
+        lua_setfield(L, -2, "applied");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.coalesced));
+        lua_setfield(L, -2, "coalesced");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.cancelled));
+        lua_setfield(L, -2, "cancelled");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.flushes));
+        lua_setfield(L, -2, "flushes");
         return 1;
     }
 
@@ -454,7 +1215,7 @@ namespace Sample {
 
     // Forms and objects
     static int GetFormByID(lua_State* L) {
-        const RE::FormID formId = static_cast<RE::FormID>(luaL_checkinteger(L, 1));
+        const RE::FormID formId = GetFormIDArg(L, 1);
         
         auto form = Sample::SKSEManager::GetSingleton()->GetFormFromID(formId);
         if (form) {
@@ -465,6 +1226,17 @@ namespace Sample {
         return 1;
     }
 
+    // Form handles; methods on the handle reuse the resolved pointer
+    static int GetForm(lua_State* L) {
+        PushFormHandle(L, GetFormParam(L, 1));
+        return 1;
+    }
+
+    static int GetActor(lua_State* L) {
+        PushFormHandle(L, GetActorParam(L, 1));
+        return 1;
+    }
+
     static int GetFormByEditorID(lua_State* L) {
         const char* editorId = luaL_checkstring(L, 1);
         
@@ -477,6 +1249,44 @@ namespace Sample {
         return 1;
     }
 
+    static int FindFormsByName(lua_State* L) {
+        const char* prefix = luaL_checkstring(L, 1);
+        const auto limit = static_cast<std::size_t>(std::max<lua_Integer>(luaL_optinteger(L, 2, 32), 0));
+
+        std::vector<RE::FormID> formIds;
+        FormIndex::GetSingleton()->FindByNamePrefix(prefix, limit, formIds);
+
+        lua_createtable(L, static_cast<int>(formIds.size()), 0);
+        int index = 1;
+        for (const auto formId : formIds) {
+            PushFormHandle(L, RE::TESForm::LookupByID(formId));
+            if (lua_isnil(L, -1)) {
+                lua_pop(L, 1);
+                continue;
+            }
+            lua_rawseti(L, -2, index++);
+        }
+        return 1;
+    }
+
+    static int GetFormIndexStats(lua_State* L) {
+        const auto& stats = FormIndex::GetSingleton()->GetStats();
+        lua_createtable(L, 0, 6);
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.formsScanned));
+        lua_setfield(L, -2, "formsScanned");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.editorIDs));
+        lua_setfield(L, -2, "editorIDs");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.names));
+        lua_setfield(L, -2, "names");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.bytes));
+        lua_setfield(L, -2, "bytes");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.threads));
+        lua_setfield(L, -2, "threads");
+        lua_pushnumber(L, stats.buildMillis);
+        lua_setfield(L, -2, "buildMillis");
+        return 1;
+    }
+
     // Utility functions
     static int GetActorDistance(lua_State* L) {
         auto actor1 = GetActorParam(L, 1);
@@ -504,22 +1314,597 @@ namespace Sample {
         return 1;
     }
 
-    // Add RegisterForOnUpdate functionality
+    // Timers backed by the native timing wheel
+    static int ScheduleTimer(lua_State* L, bool repeating) {
+        luaL_checktype(L, 1, LUA_TFUNCTION);
+        const double seconds = luaL_checknumber(L, 2);
+        const auto ticks = static_cast<uint64_t>(std::max(seconds, 0.0) * 1000.0);
+
+        lua_pushvalue(L, 1);
+        const int functionRef = luaL_ref(L, LUA_REGISTRYINDEX);
+        const uint64_t interval = repeating ? std::max<uint64_t>(ticks, 1) : 0;
+        const auto id =
+            LuaManager::GetSingleton()->GetTimers().Schedule(ticks, interval, static_cast<uint32_t>(functionRef));
+        lua_pushinteger(L, static_cast<lua_Integer>(id));
+        return 1;
+    }
+
+    static int SetTimeout(lua_State* L) {
+        return ScheduleTimer(L, false);
+    }
+
+    static int SetInterval(lua_State* L) {
+        return ScheduleTimer(L, true);
+    }
+
+    static int ClearTimer(lua_State* L) {
+        const auto id = static_cast<TimerWheel::TimerId>(luaL_checkinteger(L, 1));
+        uint32_t functionRef;
+        if (!LuaManager::GetSingleton()->GetTimers().Cancel(id, &functionRef)) {
+            lua_pushboolean(L, false);
+            return 1;
+        }
+        luaL_unref(L, LUA_REGISTRYINDEX, static_cast<int>(functionRef));
+        lua_pushboolean(L, true);
+        return 1;
+    }
+
+    // Coroutine tasks and their native wait points
+    static int StartTask(lua_State* L) {
+        luaL_checktype(L, 1, LUA_TFUNCTION);
+        LuaManager::GetSingleton()->GetTaskScheduler().Spawn(L, lua_gettop(L) - 1);
+        return 0;
+    }
+
+    static int Wait(lua_State* L) {
+        const double seconds = luaL_checknumber(L, 1);
+        if (!LuaManager::GetSingleton()->GetTaskScheduler().WaitSeconds(L, seconds)) {
+            return luaL_error(L, "Wait can only be called from a task started with StartTask");
+        }
+        return lua_yield(L, 0);
+    }
+
+    static int WaitFrames(lua_State* L) {
+        const auto frames = static_cast<uint32_t>(luaL_optinteger(L, 1, 1));
+        if (!LuaManager::GetSingleton()->GetTaskScheduler().WaitFrames(L, frames)) {
+            return luaL_error(L, "WaitFrames can only be called from a task started with StartTask");
+        }
+        return lua_yield(L, 0);
+    }
+
+    // Resumes with the arguments the event was signalled with
+    static int WaitForEvent(lua_State* L) {
+        size_t length;
+        const char* eventName = luaL_checklstring(L, 1, &length);
+        auto* manager = LuaManager::GetSingleton();
+        if (!manager->GetTaskScheduler().WaitForEvent(L, {eventName, length})) {
+            return luaL_error(L, "WaitForEvent can only be called from a task started with StartTask");
+        }
+        // Known to the bus, so that an event queued from Papyrus in another casing still finds the waiting task
+        manager->GetEventBus().Intern({eventName, length});
+        return lua_yield(L, 0);
+    }
+
+    static int SignalEvent(lua_State* L) {
+        size_t length;
+        const char* eventName = luaL_checklstring(L, 1, &length);
+        const auto resumed =
+            LuaManager::GetSingleton()->GetTaskScheduler().SignalEvent(L, {eventName, length}, 2, lua_gettop(L) - 1);
+        lua_pushinteger(L, static_cast<lua_Integer>(resumed));
+        return 1;
+    }
+
+    static int GetTaskStats(lua_State* L) {
+        const auto stats = LuaManager::GetSingleton()->GetTaskScheduler().GetStats();
+        lua_createtable(L, 0, 6);
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.spawned));
+        lua_setfield(L, -2, "spawned");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.completed));
+        lua_setfield(L, -2, "completed");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.failed));
+        lua_setfield(L, -2, "failed");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.resumes));
+        lua_setfield(L, -2, "resumes");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.pooled));
+        lua_setfield(L, -2, "pooled");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.suspended));
+        lua_setfield(L, -2, "suspended");
+        return 1;
+    }
+
+    // Cosave persistence
+    static int Persist(lua_State* L) {
+        size_t length;
+        const char* name = luaL_checklstring(L, 1, &length);
+        const bool dirtyTracking = lua_toboolean(L, 3);
+        auto& persistence = LuaManager::GetSingleton()->GetPersistence();
+        lua_settop(L, 2);
+        if (lua_isnil(L, 2)) {
+            // Without a table, hand back the one already persisted under the name, or a new one
+            lua_pop(L, 1);
+            persistence.Push(L, std::string_view(name, length));
+            if (lua_isnil(L, -1)) {
+                lua_pop(L, 1);
+                lua_newtable(L);
+            }
+        }
+        luaL_checktype(L, 2, LUA_TTABLE);
+        persistence.Register(L, std::string_view(name, length), 2, dirtyTracking);
+        lua_pushvalue(L, 2);
+        return 1;
+    }
+
+    static int MarkPersistDirty(lua_State* L) {
+        size_t length;
+        const char* name = luaL_checklstring(L, 1, &length);
+        lua_pushboolean(L, LuaManager::GetSingleton()->GetPersistence().MarkDirty(std::string_view(name, length)));
+        return 1;
+    }
+
+    static int GetPersistStats(lua_State* L) {
+        const auto& persistence = LuaManager::GetSingleton()->GetPersistence();
+        const auto& stats = persistence.GetStats();
+        lua_createtable(L, 0, 8);
+        lua_pushinteger(L, static_cast<lua_Integer>(persistence.Size()));
+        lua_setfield(L, -2, "tables");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.saves));
+        lua_setfield(L, -2, "saves");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.encodes));
+        lua_setfield(L, -2, "encodes");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.reuses));
+        lua_setfield(L, -2, "reuses");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.skipped));
+        lua_setfield(L, -2, "skipped");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.lastSaveBytes));
+        lua_setfield(L, -2, "lastSaveBytes");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.lastSaveMicros));
+        lua_setfield(L, -2, "lastSaveMicros");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.lastLoadMicros));
+        lua_setfield(L, -2, "lastLoadMicros");
+        return 1;
+    }
+
+    // Engine hooks; captured calls are delivered once per frame as an array
+    static int SubscribeHook(lua_State* L) {
+        size_t length;
+        const char* name = luaL_checklstring(L, 1, &length);
+        luaL_checktype(L, 2, LUA_TFUNCTION);
+
+        auto* registry = HookRegistry::GetSingleton();
+        const auto site = registry->FindSite(std::string_view(name, length));
+        if (!site) {
+            return luaL_error(L, "unknown hook '%s'", name);
+        }
+        lua_pushvalue(L, 2);
+        const int functionRef = luaL_ref(L, LUA_REGISTRYINDEX);
+        const auto handle = registry->Subscribe(*site, functionRef);
+        if (!handle) {
+            luaL_unref(L, LUA_REGISTRYINDEX, functionRef);
+            return luaL_error(L, "hook '%s' cannot be subscribed to", name);
+        }
+        lua_pushinteger(L, *handle);
+        return 1;
+    }
+
+    static int UnsubscribeHook(lua_State* L) {
+        const auto handle = static_cast<uint32_t>(luaL_checkinteger(L, 1));
+        lua_pushboolean(L, HookRegistry::GetSingleton()->Unsubscribe(L, handle));
+        return 1;
+    }
+
+    static int GetHookStats(lua_State* L) {
+        std::vector<HookRegistry::SiteStats> sites;
+        HookRegistry::GetSingleton()->GetStats(sites);
+        lua_createtable(L, 0, static_cast<int>(sites.size()));
+        for (const auto& site : sites) {
+            lua_createtable(L, 0, 4);
+            lua_pushinteger(L, site.subscribers);
+            lua_setfield(L, -2, "subscribers");
+            lua_pushinteger(L, static_cast<lua_Integer>(site.captured));
+            lua_setfield(L, -2, "captured");
+            lua_pushinteger(L, static_cast<lua_Integer>(site.dropped));
+            lua_setfield(L, -2, "dropped");
+            lua_pushinteger(L, static_cast<lua_Integer>(site.deliveries));
+            lua_setfield(L, -2, "deliveries");
+            lua_setfield(L, -2, std::string(site.name).c_str());
+        }
+        return 1;
+    }
+
+    // Papyrus call bridge
+    static int GetPapyrusCallStats(lua_State* L) {
+        const auto& bridge = LuaManager::GetSingleton()->GetCallBridge();
+        const auto& stats = bridge.GetStats();
+        lua_createtable(L, 0, 7);
+        lua_pushinteger(L, static_cast<lua_Integer>(bridge.Size()));
+        lua_setfield(L, -2, "cached");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.calls));
+        lua_setfield(L, -2, "calls");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.errors));
+        lua_setfield(L, -2, "errors");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.resolves));
+        lua_setfield(L, -2, "resolves");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.cacheHits));
+        lua_setfield(L, -2, "cacheHits");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.totalMicros));
+        lua_setfield(L, -2, "totalMicros");
+        lua_pushinteger(L, stats.maxMicros);
+        lua_setfield(L, -2, "maxMicros");
+        return 1;
+    }
+
+    static int ClearPapyrusCallCache(lua_State* L) {
+        LuaManager::GetSingleton()->GetCallBridge().Clear(L);
+        return 0;
+    }
+
+    // Event bus
+    static int RegisterEvent(lua_State* L) {
+        size_t length;
+        const char* eventName = luaL_checklstring(L, 1, &length);
+        luaL_checktype(L, 2, LUA_TFUNCTION);
+
+        auto& bus = LuaManager::GetSingleton()->GetEventBus();
+        const auto id = bus.Intern({eventName, length});
+        lua_pushvalue(L, 2);
+        const int functionRef = luaL_ref(L, LUA_REGISTRYINDEX);
+        lua_pushinteger(L, bus.Subscribe(id, functionRef));
+        return 1;
+    }
+
+    static int UnregisterEvent(lua_State* L) {
+        const auto handle = static_cast<uint32_t>(luaL_checkinteger(L, 1));
+        if (handle & GameEvents::HandleBit) {
+            lua_pushboolean(L, GameEvents::GetSingleton()->Unsubscribe(L, handle));
+            return 1;
+        }
+        lua_pushboolean(L, LuaManager::GetSingleton()->GetEventBus().Unsubscribe(L, handle));
+        return 1;
+    }
+
+    // Returns false if nothing was listening for the event
+    static int TriggerEvent(lua_State* L) {
+        size_t length;
+        const char* eventName = luaL_checklstring(L, 1, &length);
+        lua_pushboolean(L, LuaManager::GetSingleton()->DispatchEvent(L, {eventName, length}, 2, lua_gettop(L) - 1));
+        return 1;
+    }
+
+    // Hit batches: one OnHitBatch event per frame with a view over that frame's hits
+    static const HitEventQueue::Batch& CheckHitBatch(lua_State* L) {
+        auto* view = static_cast<HitBatchView*>(luaL_checkudata(L, 1, HitBatchMetatable));
+        if (view->generation != HitBatchGeneration) {
+            luaL_error(L, "hit batch is no longer valid; read it inside the OnHitBatch handler");
+        }
+        return view->batch;
+    }
+
+    static const HitEventQueue::Record& CheckHitRecord(lua_State* L) {
+        const auto& batch = CheckHitBatch(L);
+        const auto index = luaL_checkinteger(L, 2);
+        luaL_argcheck(L, index >= 1 && index <= static_cast<lua_Integer>(batch.count), 2, "hit index out of range");
+        return batch[static_cast<std::size_t>(index - 1)];
+    }
+
+    static int HitBatchCount(lua_State* L) {
+        lua_pushinteger(L, CheckHitBatch(L).count);
+        return 1;
+    }
+
+    static int HitBatchDropped(lua_State* L) {
+        lua_pushinteger(L, static_cast<lua_Integer>(CheckHitBatch(L).dropped));
+        return 1;
+    }
+
+    static int HitBatchTarget(lua_State* L) {
+        PushFormHandle(L, RE::TESForm::LookupByID(CheckHitRecord(L).target));
+        return 1;
+    }
+
+    static int HitBatchTargetID(lua_State* L) {
+        lua_pushinteger(L, CheckHitRecord(L).target);
+        return 1;
+    }
+
+    static int HitBatchTime(lua_State* L) {
+        lua_pushnumber(L, static_cast<lua_Number>(CheckHitRecord(L).timeMicros) / 1e6);
+        return 1;
+    }
+
+    static int HitBatchFrame(lua_State* L) {
+        lua_pushinteger(L, CheckHitRecord(L).frame);
+        return 1;
+    }
+
+    static int HitBatchGet(lua_State* L) {
+        const auto& record = CheckHitRecord(L);
+        lua_pushinteger(L, record.target);
+        lua_pushnumber(L, static_cast<lua_Number>(record.timeMicros) / 1e6);
+        lua_pushinteger(L, record.frame);
+        return 3;
+    }
+
+    static void RegisterHitBatchType(lua_State* L) {
+        static constexpr luaL_Reg methods[] = {
+            {"Count", HitBatchCount},
+            {"Dropped", HitBatchDropped},
+            {"Target", HitBatchTarget},
+            {"TargetID", HitBatchTargetID},
+            {"Time", HitBatchTime},
+            {"Frame", HitBatchFrame},
+            {"Get", HitBatchGet},
+            {nullptr, nullptr},
+        };
+        luaL_newmetatable(L, HitBatchMetatable);
+        lua_newtable(L);
+        luaL_setfuncs(L, methods, 0);
+        lua_setfield(L, -2, "__index");
+        lua_pushcfunction(L, HitBatchCount);
+        lua_setfield(L, -2, "__len");
+        lua_pop(L, 1);
+    }
+
+    static int GetHitEventStats(lua_State* L) {
+        const auto stats = HitEventQueue::GetSingleton()->GetStats();
+        lua_createtable(L, 0, 3);
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.pushed));
+        lua_setfield(L, -2, "pushed");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.dropped));
+        lua_setfield(L, -2, "dropped");
+        lua_pushinteger(L, stats.highWater);
+        lua_setfield(L, -2, "highWater");
+        return 1;
+    }
+
+    // Call fn with the stack index of a filter field's value, or of each element if the value is an array
+    template <class Fn>
+    static void ForEachFilterValue(lua_State* L, int index, const char* field, Fn&& fn) {
+        const auto type = lua_getfield(L, index, field);
+        if (type == LUA_TTABLE) {
+            const auto count = static_cast<lua_Integer>(lua_rawlen(L, -1));
+            for (lua_Integer i = 1; i <= count; ++i) {
+                lua_rawgeti(L, -1, i);
+                fn(lua_gettop(L));
+                lua_pop(L, 1);
+            }
+        } else if (type != LUA_TNIL) {
+            fn(lua_gettop(L));
+        }
+        lua_pop(L, 1);
+    }
+
+    // Raise any error in a { actors = {...}, formType = n or {...}, menu = "name" or {...} } filter
+    static void CheckGameEventFilter(lua_State* L, int index) {
+        if (lua_isnoneornil(L, index)) {
+            return;
+        }
+        luaL_checktype(L, index, LUA_TTABLE);
+        ForEachFilterValue(L, index, "actors", [&](int value) { GetFormIDArg(L, value); });
+        ForEachFilterValue(L, index, "formType", [&](int value) { luaL_checkinteger(L, value); });
+        ForEachFilterValue(L, index, "menu", [&](int value) { luaL_checkstring(L, value); });
+    }
+
+    // Read a filter CheckGameEventFilter has accepted; the values are known to convert, so nothing here raises
+    static GameEvents::Filter ReadGameEventFilter(lua_State* L, int index) {
+        GameEvents::Filter filter;
+        if (lua_isnoneornil(L, index)) {
+            return filter;
+        }
+        ForEachFilterValue(L, index, "actors", [&](int value) { filter.actors.push_back(GetFormIDArg(L, value)); });
+        ForEachFilterValue(L, index, "formType", [&](int value) {
+            filter.formTypes.push_back(static_cast<RE::FormType>(lua_tointeger(L, value)));
+        });
+        ForEachFilterValue(L, index, "menu", [&](int value) { filter.menus.emplace_back(lua_tostring(L, value)); });
+        return filter;
+    }
+
+    // Native game events (OnEquip, OnMenuOpen, ...) are filtered in C++ and delivered once per frame. Anything else,
+    // such as OnGameLoad, is dispatched by the plugin onto the bus under its own name.
+    static int HookGameEvent(lua_State* L) {
+        size_t length;
+        const char* eventName = luaL_checklstring(L, 1, &length);
+        const auto kind = GameEvents::FindKind({eventName, length});
+        if (!kind) {
+            return RegisterEvent(L);
+        }
+        luaL_checktype(L, 2, LUA_TFUNCTION);
+        CheckGameEventFilter(L, 3);
+
+        // A Lua error unwinds past C++ destructors, so every argument has been checked before the filter is built.
+        // The reference is taken first, as it is the last step that can raise (when out of memory).
+        lua_pushvalue(L, 2);
+        const int functionRef = luaL_ref(L, LUA_REGISTRYINDEX);
+        auto filter = ReadGameEventFilter(L, 3);
+        lua_pushinteger(L, GameEvents::GetSingleton()->Subscribe(*kind, functionRef, std::move(filter)));
+        return 1;
+    }
+
+    static int GetCommandQueueStats(lua_State* L) {
+        auto* queue = LuaCommandQueue::GetSingleton();
+        const auto stats = queue->GetStats();
+        lua_createtable(L, 0, 9);
+        lua_pushinteger(L, static_cast<lua_Integer>(queue->Size()));
+        lua_setfield(L, -2, "size");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.pushed));
+        lua_setfield(L, -2, "pushed");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.drained));
+        lua_setfield(L, -2, "drained");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.dropped));
+        lua_setfield(L, -2, "dropped");
+        lua_pushinteger(L, stats.highWater);
+        lua_setfield(L, -2, "highWater");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.backlogFrames));
+        lua_setfield(L, -2, "backlogFrames");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.totalLatencyMicros));
+        lua_setfield(L, -2, "totalLatencyMicros");
+        lua_pushinteger(L, stats.maxLatencyMicros);
+        lua_setfield(L, -2, "maxLatencyMicros");
+        lua_pushinteger(L, LuaManager::GetSingleton()->GetCommandBudgetMicros());
+        lua_setfield(L, -2, "budgetMicros");
+        return 1;
+    }
+
+    static int GetGameEventStats(lua_State* L) {
+        std::vector<GameEvents::Stats> kinds;
+        GameEvents::GetSingleton()->GetStats(kinds);
+        lua_createtable(L, 0, static_cast<int>(kinds.size()));
+        for (const auto& kind : kinds) {
+            lua_createtable(L, 0, 5);
+            lua_pushinteger(L, kind.subscriptions);
+            lua_setfield(L, -2, "subscriptions");
+            lua_pushinteger(L, static_cast<lua_Integer>(kind.received));
+            lua_setfield(L, -2, "received");
+            lua_pushinteger(L, static_cast<lua_Integer>(kind.delivered));
+            lua_setfield(L, -2, "delivered");
+            lua_pushinteger(L, static_cast<lua_Integer>(kind.dropped));
+            lua_setfield(L, -2, "dropped");
+            lua_pushinteger(L, static_cast<lua_Integer>(kind.handlerCalls));
+            lua_setfield(L, -2, "handlerCalls");
+            lua_setfield(L, -2, std::string(kind.name).c_str());
+        }
+        return 1;
+    }
+
+    static int GetEventStats(lua_State* L) {
+        const auto& stats = LuaManager::GetSingleton()->GetEventBus().GetStats();
+        lua_createtable(L, 0, 3);
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.dispatches));
+        lua_setfield(L, -2, "dispatches");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.handlerCalls));
+        lua_setfield(L, -2, "handlerCalls");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.handlerErrors));
+        lua_setfield(L, -2, "handlerErrors");
+        return 1;
+    }
+
+    // Allocator statistics: live/peak bytes and a per-size-class histogram
+    static int GetLuaMemoryStats(lua_State* L) {
+        auto allocator = LuaManager::GetSingleton()->GetAllocator();
+        if (!allocator) {
+            lua_pushnil(L);
+            return 1;
+        }
+
+        const auto& stats = allocator->GetStats();
+        lua_createtable(L, 0, 6);
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.liveBytes));
+        lua_setfield(L, -2, "live");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.peakBytes));
+        lua_setfield(L, -2, "peak");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.slabBytes));
+        lua_setfield(L, -2, "slabBytes");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.largeLiveBytes));
+        lua_setfield(L, -2, "largeBytes");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.largeAllocations));
+        lua_setfield(L, -2, "largeAllocations");
+
+        lua_createtable(L, static_cast<int>(LuaAllocator::ClassCount), 0);
+        for (size_t i = 0; i < LuaAllocator::ClassCount; ++i) {
+            lua_createtable(L, 0, 3);
+            lua_pushinteger(L, LuaAllocator::ClassSizes[i]);
+            lua_setfield(L, -2, "size");
+            lua_pushinteger(L, static_cast<lua_Integer>(stats.classLive[i]));
+            lua_setfield(L, -2, "live");
+            lua_pushinteger(L, static_cast<lua_Integer>(stats.classAllocations[i]));
+            lua_setfield(L, -2, "allocated");
+            lua_rawseti(L, -2, static_cast<lua_Integer>(i + 1));
+        }
+        lua_setfield(L, -2, "classes");
+        return 1;
+    }
+
+    // Collector statistics: per-frame GC time and pause length histograms
+    static int GetGCStats(lua_State* L) {
+        const auto& stats = LuaManager::GetSingleton()->GetGCStats();
+
+        auto pushHistogram = [L](const auto& histogram) {
+            lua_createtable(L, static_cast<int>(histogram.size()), 0);
+            for (size_t i = 0; i < histogram.size(); ++i) {
+                lua_pushinteger(L, static_cast<lua_Integer>(histogram[i]));
+                lua_rawseti(L, -2, static_cast<lua_Integer>(i + 1));
+            }
+        };
+
+        lua_createtable(L, 0, 9);
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.frames));
+        lua_setfield(L, -2, "frames");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.steps));
+        lua_setfield(L, -2, "steps");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.cycles));
+        lua_setfield(L, -2, "cycles");
+        lua_pushinteger(L, static_cast<lua_Integer>(stats.totalMicros));
+        lua_setfield(L, -2, "totalMicros");
+        lua_pushinteger(L, stats.maxFrameMicros);
+        lua_setfield(L, -2, "maxFrameMicros");
+        lua_pushinteger(L, stats.maxStepMicros);
+        lua_setfield(L, -2, "maxStepMicros");
+        pushHistogram(stats.frameHistogram);
+        lua_setfield(L, -2, "frameHistogram");
+        pushHistogram(stats.stepHistogram);
+        lua_setfield(L, -2, "pauseHistogram");
+        pushHistogram(LuaManager::GCHistogramLimits);
+        lua_setfield(L, -2, "bucketLimits");
+        return 1;
+    }
+
+    // Register a function to be called from the per-frame tick with the elapsed time.
+    // An optional second argument selects the update-rate tier: { everyFrames = N } or { intervalMs = N }.
     static int RegisterForOnUpdate(lua_State* L) {
         // Check if a function was passed as parameter
         if (!lua_isfunction(L, 1)) {
             luaL_error(L, "RegisterForOnUpdate requires a function callback as parameter");
             return 0;
         }
-        
+
+        auto tier = UpdateDispatcher::Tier::kEveryFrame;
+        uint32_t period = 1;
+        if (lua_istable(L, 2)) {
+            if (lua_getfield(L, 2, "everyFrames") != LUA_TNIL) {
+                tier = UpdateDispatcher::Tier::kEveryNFrames;
+                period = static_cast<uint32_t>(luaL_checkinteger(L, -1));
+            } else if (lua_getfield(L, 2, "intervalMs") != LUA_TNIL) {
+                tier = UpdateDispatcher::Tier::kInterval;
+                period = static_cast<uint32_t>(luaL_checkinteger(L, -1));
+            }
+            lua_settop(L, 1);
+        }
+
         // Store the function in the registry to prevent garbage collection
         // and to be able to call it later
+        lua_pushvalue(L, 1);
         int functionRef = luaL_ref(L, LUA_REGISTRYINDEX);
-        
-        // Store the function reference for later use when update events happen
-        Sample::SKSEManager::GetSingleton()->RegisterLuaUpdateCallback(functionRef);
-        
-        lua_pushboolean(L, true);
+
+        auto handle = LuaManager::GetSingleton()->GetUpdateDispatcher().Register(functionRef, tier, period);
+        lua_pushinteger(L, handle);
+        return 1;
+    }
+
+    static int UnregisterForOnUpdate(lua_State* L) {
+        const auto handle = static_cast<uint32_t>(luaL_checkinteger(L, 1));
+        lua_pushboolean(L, LuaManager::GetSingleton()->GetUpdateDispatcher().Unregister(L, handle));
+        return 1;
+    }
+
+    // Per-callback call counts and timings
+    static int GetUpdateCallbackStats(lua_State* L) {
+        const auto& callbacks = LuaManager::GetSingleton()->GetUpdateDispatcher().GetCallbacks();
+        lua_createtable(L, static_cast<int>(callbacks.size()), 0);
+        lua_Integer index = 1;
+        for (const auto& callback : callbacks) {
+            if (callback.removed) {
+                continue;
+            }
+            lua_createtable(L, 0, 4);
+            lua_pushinteger(L, callback.handle);
+            lua_setfield(L, -2, "handle");
+            lua_pushinteger(L, static_cast<lua_Integer>(callback.calls));
+            lua_setfield(L, -2, "calls");
+            lua_pushinteger(L, static_cast<lua_Integer>(callback.totalMicros));
+            lua_setfield(L, -2, "totalMicros");
+            lua_pushinteger(L, callback.maxMicros);
+            lua_setfield(L, -2, "maxMicros");
+            lua_rawseti(L, -2, index++);
+        }
         return 1;
     }
 
@@ -527,14 +1912,35 @@ namespace Sample {
         // Register utility functions
         RegisterFunction("Log", LuaLog);
         RegisterFunction("GetPlayerPosition", GetPlayerPosition);
+        RegisterFunction("GetLuaMemoryStats", GetLuaMemoryStats);
+        RegisterFunction("GetGCStats", GetGCStats);
     }
     
+    void LuaManager::RegisterActorValueConstants() {
+        // AV.Health and friends, so hot scripts can pass integers instead of names
+        const auto names = GetActorValueNames();
+        lua_createtable(m_luaState, 0, static_cast<int>(names.size()));
+        for (const auto& entry : names) {
+            lua_pushinteger(m_luaState, static_cast<lua_Integer>(entry.value));
+            lua_setfield(m_luaState, -2, std::string(entry.name).c_str());
+        }
+        lua_setglobal(m_luaState, "AV");
+    }
+
     void LuaManager::RegisterGameFunctions() {
+        RegisterFormHandles(m_luaState);
+        RegisterHitBatchType(m_luaState);
+
         // Register hit counter related functions
         RegisterFunction("TrackActor", TrackActor);
         RegisterFunction("UntrackActor", UntrackActor);
         RegisterFunction("IncrementHitCount", IncrementHitCount);
         RegisterFunction("GetHitCount", GetHitCount);
+        RegisterFunction("GetHitsInLast", GetHitsInLast);
+        RegisterFunction("GetHitRate", GetHitRate);
+        RegisterFunction("GetTimeSinceLastHit", GetTimeSinceLastHit);
+        RegisterFunction("GetHitStats", GetHitStats);
+        RegisterFunction("GetTopHitActors", GetTopHitActors);
         RegisterFunction("PrintToConsole", PrintToConsole);
         
         // Actor Management
@@ -545,8 +1951,15 @@ namespace Sample {
         RegisterFunction("GetPlayer", GetPlayerActor);
         
         // NPC Management
+        RegisterActorValueConstants();
         RegisterFunction("SetActorValue", SetActorValue);
         RegisterFunction("GetActorValue", GetActorValue);
+
+        // Batch queries
+        RegisterFunction("GetActorValues", GetActorValues);
+        RegisterFunction("GetActorDistances", GetActorDistances);
+        RegisterFunction("GetHitCounts", GetHitCounts);
+        RegisterFunction("GetFormNames", GetFormNames);
         
         // Equipment functions
         RegisterFunction("EquipItem", EquipItem);
@@ -554,6 +1967,9 @@ namespace Sample {
         
         // World interaction
         RegisterFunction("FindClosestReference", FindClosestReference);
+        RegisterFunction("FindClosestReferenceOfType", FindClosestReference);
+        RegisterFunction("FindReferencesInRadius", FindReferencesInRadius);
+        RegisterFunction("FindNearestReferences", FindNearestReferences);
         
         // Quest and game state
         RegisterFunction("SetQuestStage", SetQuestStage);
@@ -563,6 +1979,11 @@ namespace Sample {
         // Weather and environment
         RegisterFunction("GetCurrentWeather", GetCurrentWeather);
         RegisterFunction("ForceWeather", ForceWeather);
+
+        // Deferred writes
+        RegisterFunction("SetDeferredWrites", SetDeferredWrites);
+        RegisterFunction("FlushWrites", FlushWrites);
+        RegisterFunction("GetWriteStats", GetWriteStats);
         
         // UI functions
         RegisterFunction("IsMenuOpen", IsMenuOpen);
@@ -572,12 +1993,57 @@ namespace Sample {
         // Forms and objects
         RegisterFunction("GetFormByID", GetFormByID);
         RegisterFunction("GetFormByEditorID", GetFormByEditorID);
+        RegisterFunction("GetForm", GetForm);
+        RegisterFunction("GetActor", GetActor);
+        RegisterFunction("GetFormFromID", GetForm);
+        RegisterFunction("GetActorFromHandle", GetActor);
+        RegisterFunction("FindFormsByName", FindFormsByName);
+        RegisterFunction("GetFormIndexStats", GetFormIndexStats);
         
         // Utility functions
         RegisterFunction("GetActorDistance", GetActorDistance);
         RegisterFunction("GetFormName", GetFormName);
         
-        // Register the update function
+        // Register the update functions
         RegisterFunction("RegisterForOnUpdate", RegisterForOnUpdate);
+        RegisterFunction("UnregisterForOnUpdate", UnregisterForOnUpdate);
+        RegisterFunction("GetUpdateCallbackStats", GetUpdateCallbackStats);
+
+        // Timers
+        RegisterFunction("SetTimeout", SetTimeout);
+        RegisterFunction("SetInterval", SetInterval);
+        RegisterFunction("ClearTimer", ClearTimer);
+
+        // Coroutine tasks
+        RegisterFunction("StartTask", StartTask);
+        RegisterFunction("Wait", Wait);
+        RegisterFunction("WaitFrames", WaitFrames);
+        RegisterFunction("WaitForEvent", WaitForEvent);
+        RegisterFunction("SignalEvent", SignalEvent);
+        RegisterFunction("GetTaskStats", GetTaskStats);
+
+        // Events
+        RegisterFunction("RegisterEvent", RegisterEvent);
+        RegisterFunction("UnregisterEvent", UnregisterEvent);
+        RegisterFunction("TriggerEvent", TriggerEvent);
+        RegisterFunction("HookGameEvent", HookGameEvent);
+        RegisterFunction("GetGameEventStats", GetGameEventStats);
+        RegisterFunction("GetCommandQueueStats", GetCommandQueueStats);
+        RegisterFunction("GetEventStats", GetEventStats);
+        RegisterFunction("GetHitEventStats", GetHitEventStats);
+
+        // Cosave persistence
+        RegisterFunction("Persist", Persist);
+        RegisterFunction("MarkPersistDirty", MarkPersistDirty);
+        RegisterFunction("GetPersistStats", GetPersistStats);
+
+        // Engine hooks
+        RegisterFunction("SubscribeHook", SubscribeHook);
+        RegisterFunction("UnsubscribeHook", UnsubscribeHook);
+        RegisterFunction("GetHookStats", GetHookStats);
+
+        // Papyrus call bridge
+        RegisterFunction("GetPapyrusCallStats", GetPapyrusCallStats);
+        RegisterFunction("ClearPapyrusCallCache", ClearPapyrusCallCache);
     }
 }
\ No newline at end of file
@@ -0,0 +1,518 @@
+#include "Core/LuaPersistence.h"
+
+#include <Core/LuaForms.h>
+
+extern "C" {
+#include <lua.h>
+#include <lauxlib.h>
+}
+
+#include <SKSE/SKSE.h>
+
+#include <chrono>
+#include <utility>
+
+using namespace RE;
+using namespace Sample;
+
+namespace {
+    enum class Tag : std::uint8_t {
+        End,        // Closes the keyed part of a table
+        False,
+        True,
+        Integer,    // Zigzag varint
+        Number,     // 8-byte double
+        String,     // Varint length and bytes; gets the next string index
+        StringRef,  // Varint index of an earlier string
+        Table,      // Varint array length, the array values, then key/value pairs up to End; gets the next table ID
+        TableRef,   // Varint ID of an earlier table, for shared tables and cycles
+        Form        // 4-byte FormID
+    };
+
+    std::uint64_t NowMicros() noexcept {
+        const auto now = std::chrono::steady_clock::now().time_since_epoch();
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(now).count());
+    }
+
+    void ClearTable(lua_State* L, int index) {
+        index = lua_absindex(L, index);
+        lua_pushnil(L);
+        while (lua_next(L, index)) {
+            lua_pop(L, 1);
+            lua_pushvalue(L, -1);
+            lua_pushnil(L);
+            lua_rawset(L, index);  // Clearing the current key is allowed during traversal
+        }
+    }
+
+    class Encoder {
+    public:
+        Encoder(lua_State* L, ByteWriter& out) : _L(L), _out(out) {}
+
+        void EncodeRoot(int index) { EncodeTable(lua_absindex(_L, index), 0); }
+
+        [[nodiscard]] std::uint64_t GetSkipped() const noexcept { return _skipped; }
+
+    private:
+        [[nodiscard]] bool IsSupported(int index, std::uint32_t depth) const {
+            switch (lua_type(_L, index)) {
+                case LUA_TBOOLEAN:
+                case LUA_TNUMBER:
+                case LUA_TSTRING:
+                    return true;
+                case LUA_TTABLE:
+                    return depth < LuaPersistence::MaxDepth || _tables.contains(lua_topointer(_L, index));
+                case LUA_TUSERDATA:
+                    return ToForm(_L, index) != nullptr;
+                default:
+                    return false;
+            }
+        }
+
+        void WriteTag(Tag tag) { _out.Write(static_cast<std::uint8_t>(tag)); }
+
+        void Encode(int index, std::uint32_t depth) {
+            switch (lua_type(_L, index)) {
+                case LUA_TBOOLEAN:
+                    WriteTag(lua_toboolean(_L, index) ? Tag::True : Tag::False);
+                    break;
+                case LUA_TNUMBER:
+                    if (lua_isinteger(_L, index)) {
+                        WriteTag(Tag::Integer);
+                        _out.WriteVarInt(lua_tointeger(_L, index));
+                    } else {
+                        WriteTag(Tag::Number);
+                        _out.Write(static_cast<double>(lua_tonumber(_L, index)));
+                    }
+                    break;
+                case LUA_TSTRING: {
+                    std::size_t length;
+                    const char* data = lua_tolstring(_L, index, &length);
+                    const auto id = static_cast<std::uint32_t>(_strings.size());
+                    const auto [found, inserted] = _strings.try_emplace(std::string_view(data, length), id);
+                    if (inserted) {
+                        WriteTag(Tag::String);
+                        _out.WriteVarUInt(length);
+                        _out.WriteBytes(data, length);
+                    } else {
+                        WriteTag(Tag::StringRef);
+                        _out.WriteVarUInt(found->second);
+                    }
+                    break;
+                }
+                case LUA_TTABLE:
+                    EncodeTable(lua_absindex(_L, index), depth);
+                    break;
+                case LUA_TUSERDATA:
+                    WriteTag(Tag::Form);
+                    _out.Write(ToForm(_L, index)->GetFormID());
+                    break;
+            }
+        }
+
+        void EncodeTable(int index, std::uint32_t depth) {
+            const auto [found, inserted] =
+                _tables.try_emplace(lua_topointer(_L, index), static_cast<std::uint32_t>(_tables.size()));
+            if (!inserted) {
+                WriteTag(Tag::TableRef);
+                _out.WriteVarUInt(found->second);
+                return;
+            }
+            luaL_checkstack(_L, 4, "table nested too deeply to persist");
+            WriteTag(Tag::Table);
+
+            // The array part runs up to the first missing or unsupported value; anything after it is keyed
+            lua_Integer length = 0;
+            for (;; ++length) {
+                const bool present =
+                    lua_rawgeti(_L, index, length + 1) != LUA_TNIL && IsSupported(-1, depth + 1);
+                lua_pop(_L, 1);
+                if (!present) {
+                    break;
+                }
+            }
+            _out.WriteVarUInt(static_cast<std::uint64_t>(length));
+            for (lua_Integer i = 1; i <= length; ++i) {
+                lua_rawgeti(_L, index, i);
+                Encode(-1, depth + 1);
+                lua_pop(_L, 1);
+            }
+
+            lua_pushnil(_L);
+            while (lua_next(_L, index)) {
+                const auto key = lua_isinteger(_L, -2) ? lua_tointeger(_L, -2) : 0;
+                if (key < 1 || key > length) {
+                    if (IsSupported(-2, depth + 1) && IsSupported(-1, depth + 1)) {
+                        Encode(-2, depth + 1);
+                        Encode(-1, depth + 1);
+                    } else {
+                        ++_skipped;
+                    }
+                }
+                lua_pop(_L, 1);
+            }
+            WriteTag(Tag::End);
+        }
+
+        lua_State* _L;
+        ByteWriter& _out;
+        // Strings are only viewed while the tables holding them are being encoded, so they stay alive
+        std::unordered_map<std::string_view, std::uint32_t> _strings;
+        std::unordered_map<const void*, std::uint32_t> _tables;
+        std::uint64_t _skipped = 0;
+    };
+
+    class Decoder {
+    public:
+        Decoder(lua_State* L, std::span<const std::byte> data, const LuaPersistence::FormResolver& resolve)
+            : _L(L), _in(data), _resolve(resolve) {}
+
+        // Decode a root into the table at <code>target</code>, which must be empty
+        bool DecodeRoot(int target) {
+            target = lua_absindex(_L, target);
+            lua_createtable(_L, 0, 0);
+            _tablesIndex = lua_gettop(_L);
+
+            std::uint8_t tag;
+            std::uint64_t length;
+            if (!_in.Read(tag) || static_cast<Tag>(tag) != Tag::Table || !_in.ReadVarUInt(length)) {
+                return false;
+            }
+            lua_pushvalue(_L, target);
+            lua_rawseti(_L, _tablesIndex, ++_tableCount);
+            return FillTable(target, length, 0);
+        }
+
+    private:
+        enum class Result { Failed, Dropped, Pushed };
+
+        Result Decode(std::uint8_t tag, std::uint32_t depth) {
+            switch (static_cast<Tag>(tag)) {
+                case Tag::False:
+                case Tag::True:
+                    lua_pushboolean(_L, static_cast<Tag>(tag) == Tag::True);
+                    return Result::Pushed;
+                case Tag::Integer: {
+                    std::int64_t value;
+                    if (!_in.ReadVarInt(value)) {
+                        return Result::Failed;
+                    }
+                    lua_pushinteger(_L, static_cast<lua_Integer>(value));
+                    return Result::Pushed;
+                }
+                case Tag::Number: {
+                    double value;
+                    if (!_in.Read(value)) {
+                        return Result::Failed;
+                    }
+                    lua_pushnumber(_L, static_cast<lua_Number>(value));
+                    return Result::Pushed;
+                }
+                case Tag::String: {
+                    std::uint64_t length;
+                    std::span<const std::byte> bytes;
+                    if (!_in.ReadVarUInt(length) || !_in.ReadBytes(static_cast<std::size_t>(length), bytes)) {
+                        return Result::Failed;
+                    }
+                    _strings.emplace_back(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+                    lua_pushlstring(_L, _strings.back().data(), _strings.back().size());
+                    return Result::Pushed;
+                }
+                case Tag::StringRef: {
+                    std::uint64_t index;
+                    if (!_in.ReadVarUInt(index) || index >= _strings.size()) {
+                        return Result::Failed;
+                    }
+                    lua_pushlstring(_L, _strings[index].data(), _strings[index].size());
+                    return Result::Pushed;
+                }
+                case Tag::Table: {
+                    std::uint64_t length;
+                    if (depth >= LuaPersistence::MaxDepth || !_in.ReadVarUInt(length)) {
+                        return Result::Failed;
+                    }
+                    luaL_checkstack(_L, 4, "persisted table nested too deeply");
+                    // Every array value takes at least a byte, which bounds the preallocation for corrupt lengths
+                    lua_createtable(_L, static_cast<int>(std::min<std::uint64_t>(length, _in.Remaining())), 0);
+                    lua_pushvalue(_L, -1);
+                    lua_rawseti(_L, _tablesIndex, ++_tableCount);
+                    return FillTable(lua_gettop(_L), length, depth + 1) ? Result::Pushed : Result::Failed;
+                }
+                case Tag::TableRef: {
+                    std::uint64_t id;
+                    if (!_in.ReadVarUInt(id) || id >= _tableCount) {
+                        return Result::Failed;
+                    }
+                    lua_rawgeti(_L, _tablesIndex, static_cast<lua_Integer>(id + 1));
+                    return Result::Pushed;
+                }
+                case Tag::Form: {
+                    FormID savedID;
+                    if (!_in.Read(savedID)) {
+                        return Result::Failed;
+                    }
+                    FormID formID;
+                    auto* form = _resolve(savedID, formID) ? TESForm::LookupByID(formID) : nullptr;
+                    if (!form) {
+                        return Result::Dropped;
+                    }
+                    PushFormHandle(_L, form);
+                    return Result::Pushed;
+                }
+                default:
+                    return Result::Failed;
+            }
+        }
+
+        bool FillTable(int index, std::uint64_t length, std::uint32_t depth) {
+            std::uint8_t tag;
+            for (std::uint64_t i = 1; i <= length; ++i) {
+                if (!_in.Read(tag)) {
+                    return false;
+                }
+                const auto value = Decode(tag, depth);
+                if (value == Result::Failed) {
+                    return false;
+                }
+                if (value == Result::Pushed) {
+                    lua_rawseti(_L, index, static_cast<lua_Integer>(i));
+                }
+            }
+
+            for (;;) {
+                if (!_in.Read(tag)) {
+                    return false;
+                }
+                if (static_cast<Tag>(tag) == Tag::End) {
+                    return true;
+                }
+                const auto key = Decode(tag, depth);
+                if (key == Result::Failed || !_in.Read(tag)) {
+                    return false;
+                }
+                const auto value = Decode(tag, depth);
+                if (value == Result::Failed) {
+                    return false;
+                }
+
+                // Entries whose key or value is a form missing from the current load order are dropped
+                if (key == Result::Pushed && value == Result::Pushed) {
+                    lua_rawset(_L, index);
+                } else {
+                    lua_pop(_L, (key == Result::Pushed) + (value == Result::Pushed));
+                }
+            }
+        }
+
+        lua_State* _L;
+        ByteReader _in;
+        const LuaPersistence::FormResolver& _resolve;
+        std::vector<std::string_view> _strings;  // Views into the record being loaded
+        int _tablesIndex = 0;                    // Stack slot of the table mapping IDs to decoded tables
+        std::uint32_t _tableCount = 0;
+    };
+
+    struct EncodeCall {
+        Encoder* encoder;
+        int tableRef;
+    };
+
+    int ProtectedEncode(lua_State* L) {
+        auto* call = static_cast<EncodeCall*>(lua_touserdata(L, 1));
+        lua_rawgeti(L, LUA_REGISTRYINDEX, call->tableRef);
+        call->encoder->EncodeRoot(-1);
+        return 0;
+    }
+
+    struct DecodeCall {
+        Decoder* decoder;
+        int tableRef;
+        bool decoded;
+    };
+
+    int ProtectedDecode(lua_State* L) {
+        auto* call = static_cast<DecodeCall*>(lua_touserdata(L, 1));
+        lua_rawgeti(L, LUA_REGISTRYINDEX, call->tableRef);
+        ClearTable(L, -1);
+        call->decoded = call->decoder->DecodeRoot(-1);
+        return 0;
+    }
+}
+
+LuaPersistence::Root* LuaPersistence::Find(std::string_view name) {
+    const auto found = _index.find(name);
+    return found != _index.end() ? &_roots[found->second] : nullptr;
+}
+
+LuaPersistence::Root& LuaPersistence::Add(lua_State* L, std::string_view name) {
+    _index.emplace(std::string(name), _roots.size());
+    return _roots.emplace_back(Root{std::string(name), luaL_ref(L, LUA_REGISTRYINDEX), false, true, true, {}});
+}
+
+void LuaPersistence::Register(lua_State* L, std::string_view name, int index, bool dirtyTracking) {
+    index = lua_absindex(L, index);
+    auto* root = Find(name);
+    if (!root) {
+        lua_pushvalue(L, index);
+        root = &Add(L, name);
+    } else {
+        lua_rawgeti(L, LUA_REGISTRYINDEX, root->tableRef);
+        if (!lua_rawequal(L, -1, index)) {
+            // Entries loaded before anyone registered the name win over the defaults in the new table
+            if (!root->registered) {
+                lua_pushnil(L);
+                while (lua_next(L, -2)) {
+                    lua_pushvalue(L, -2);
+                    lua_insert(L, -2);
+                    lua_rawset(L, index);
+                }
+            }
+            luaL_unref(L, LUA_REGISTRYINDEX, root->tableRef);
+            lua_pushvalue(L, index);
+            root->tableRef = luaL_ref(L, LUA_REGISTRYINDEX);
+        }
+        lua_pop(L, 1);
+    }
+
+    root->registered = true;
+    root->dirtyTracking = dirtyTracking;
+    root->dirty = true;
+}
+
+void LuaPersistence::Push(lua_State* L, std::string_view name) const {
+    const auto found = _index.find(name);
+    if (found == _index.end()) {
+        lua_pushnil(L);
+        return;
+    }
+    lua_rawgeti(L, LUA_REGISTRYINDEX, _roots[found->second].tableRef);
+}
+
+bool LuaPersistence::MarkDirty(std::string_view name) {
+    auto* root = Find(name);
+    if (!root) {
+        return false;
+    }
+    root->dirty = true;
+    return true;
+}
+
+void LuaPersistence::Save(lua_State* L, ByteWriter& out) {
+    const auto start = NowMicros();
+    ++_stats.saves;
+
+    ByteWriter scratch;
+    std::size_t written = 0;
+    for (auto& root : _roots) {
+        if (root.dirtyTracking && !root.dirty && root.encoded.Size() > 0) {
+            ++_stats.reuses;
+            ++written;
+            continue;
+        }
+
+        scratch.Clear();
+        Encoder encoder(L, scratch);
+        EncodeCall call{&encoder, root.tableRef};
+        lua_pushcfunction(L, ProtectedEncode);
+        lua_pushlightuserdata(L, &call);
+        if (lua_pcall(L, 1, 0, 0) != LUA_OK) {
+            // Keep the last good encoding rather than losing the table
+            SKSE::log::error("Failed to persist Lua table '{}': {}", root.name, lua_tostring(L, -1));
+            lua_pop(L, 1);
+        } else {
+            std::swap(root.encoded, scratch);
+            root.dirty = false;
+            ++_stats.encodes;
+            _stats.skipped += encoder.GetSkipped();
+        }
+        if (root.encoded.Size() > 0) {
+            ++written;
+        }
+    }
+
+    out.WriteVarUInt(written);
+    for (const auto& root : _roots) {
+        if (root.encoded.Size() == 0) {
+            continue;
+        }
+        out.WriteVarUInt(root.name.size());
+        out.WriteBytes(root.name.data(), root.name.size());
+        out.WriteVarUInt(root.encoded.Size());
+        out.WriteBytes(root.encoded.Data(), root.encoded.Size());
+    }
+
+    _stats.lastSaveBytes = out.Size();
+    _stats.lastSaveMicros = NowMicros() - start;
+}
+
+bool LuaPersistence::Load(lua_State* L, std::span<const std::byte> data, const FormResolver& resolve) {
+    const auto start = NowMicros();
+    ByteReader reader(data);
+
+    std::uint64_t count;
+    if (!reader.ReadVarUInt(count)) {
+        return false;
+    }
+    for (; count > 0; --count) {
+        std::uint64_t nameLength;
+        std::uint64_t blobLength;
+        std::span<const std::byte> name;
+        std::span<const std::byte> blob;
+        if (!reader.ReadVarUInt(nameLength) || !reader.ReadBytes(static_cast<std::size_t>(nameLength), name) ||
+            !reader.ReadVarUInt(blobLength) || !reader.ReadBytes(static_cast<std::size_t>(blobLength), blob)) {
+            return false;
+        }
+
+        const std::string_view rootName(reinterpret_cast<const char*>(name.data()), name.size());
+        auto* root = Find(rootName);
+        if (!root) {
+            lua_newtable(L);
+            root = &Add(L, rootName);
+        }
+
+        Decoder decoder(L, blob, resolve);
+        DecodeCall call{&decoder, root->tableRef, false};
+        lua_pushcfunction(L, ProtectedDecode);
+        lua_pushlightuserdata(L, &call);
+        if (lua_pcall(L, 1, 0, 0) != LUA_OK) {
+            SKSE::log::error("Failed to load persisted Lua table '{}': {}", root->name, lua_tostring(L, -1));
+            lua_pop(L, 1);
+        } else if (!call.decoded) {
+            SKSE::log::error("Persisted Lua table '{}' is corrupt; loaded what could be read.", root->name);
+        }
+        // FormIDs may have been remapped, so the old encoding is stale
+        root->dirty = true;
+        root->encoded.Clear();
+    }
+
+    _stats.lastLoadMicros = NowMicros() - start;
+    return true;
+}
+
+void LuaPersistence::Revert(lua_State* L) {
+    std::vector<Root> kept;
+    kept.reserve(_roots.size());
+    for (auto& root : _roots) {
+        if (!root.registered) {
+            luaL_unref(L, LUA_REGISTRYINDEX, root.tableRef);
+            continue;
+        }
+        lua_rawgeti(L, LUA_REGISTRYINDEX, root.tableRef);
+        ClearTable(L, -1);
+        lua_pop(L, 1);
+        root.dirty = true;
+        root.encoded.Clear();
+        kept.push_back(std::move(root));
+    }
+
+    _roots = std::move(kept);
+    _index.clear();
+    for (std::size_t i = 0; i < _roots.size(); ++i) {
+        _index.emplace(_roots[i].name, i);
+    }
+}
+
+void LuaPersistence::Clear() noexcept {
+    _roots.clear();
+    _index.clear();
+}
@@ -1,5 +1,7 @@
 #include "Core/Papyrus.h"
 
+#include <Core/LuaCommandQueue.h>
+#include <Core/LuaManager.h>
 #include <Core/SKSEManager.h>
 
 using namespace Sample;
@@ -10,28 +12,7 @@ using namespace SKSE;
 
 namespace {
     constexpr std::string_view PapyrusClass = "HitCounter";
-
-    int32_t* PopulateHitData(Actor* target, char* unk0);
-
-    // The <code>Relocation</code> class references something in the Skyrim engine (e.g. static data, a function, etc.)
-    // that can be relocated in memory at runtime. Windows will rebase the memory of the Skyrim process to a random one,
-    // so we cannot hard-code the memory address. Relocation will rebase your memory offset to the base memory address
-    // of the Skyrim process, so that it adjusts on every run. However, it is recommended not to provide a memory
-    // offset, but rather a <code>REL::ID</code> to lookup the offset dynamically with Address Library.
-    //
-    // The ID here is the ID of the function in Address Library. We use it to not be tied to the specific Skyrim
-    // executable version. However, there are still three incompatible databases of addresses, for Skyrim 1.5.x
-    // (pre-AE), Skyrim 1.6.x (post-AE), and Skyrim VR. This sample supports all three by allowing you to build a
-    // separate DLL for each and changing the ID used with a macro. The SE ID is used for Skyrim VR as well, since the
-    // VR address library uses SE ID's but maps them to a VR offset. RELOCATION_ID is a macro in CommonLibSSE NG which
-    // can dynamically choose between an SE and AE ID at runtime, depending on which version of Skyrim is in use. This
-    // allows for a single DLL that works across both versions of Skyrim.
-    Relocation<decltype(PopulateHitData)>& GetHookedFunction() noexcept {
-        static Relocation<decltype(PopulateHitData)> value(RELOCATION_ID(42832, 44001), 0x42);
-        return value;
-    }
-
-    Relocation<decltype(PopulateHitData)> OriginalPopulateHitData;
+    constexpr std::string_view LuaBridgeClass = "HelloLua";
 
     // Start handlers for Papyrus functions.
     //
@@ -54,8 +35,47 @@ namespace {
         return SKSEManager::GetSingleton()->UntrackActor(actor);
     }
 
+    // Array variants for scripts managing many actors: one native call and one lock for the whole array
+    int32_t StartCountingAll(StaticFunctionTag*, std::vector<Actor*> actors) {
+        return static_cast<int32_t>(SKSEManager::GetSingleton()->TrackActors(actors));
+    }
+
+    std::vector<int32_t> GetCounts(StaticFunctionTag*, std::vector<Actor*> actors) {
+        std::vector<std::optional<int32_t>> counts;
+        SKSEManager::GetSingleton()->GetHitCounts(actors, counts);
+
+        std::vector<int32_t> result;
+        result.reserve(counts.size());
+        for (const auto& count : counts) {
+            result.push_back(count.value_or(0));
+        }
+        return result;
+    }
+
+    void ResetCounts(StaticFunctionTag*, std::vector<Actor*> actors) {
+        SKSEManager::GetSingleton()->ResetHitCounts(actors);
+    }
+
     int32_t GetTotalHitCounters(StaticFunctionTag*) {
-        return 0;
+        return static_cast<int32_t>(SKSEManager::GetSingleton()->GetTrackedActorCount());
+    }
+
+    // Papyrus ints are 32-bit, so the sum saturates
+    int32_t GetTotalHits(StaticFunctionTag*) {
+        return static_cast<int32_t>(std::clamp<int64_t>(SKSEManager::GetSingleton()->GetTotalHits(), INT32_MIN,
+                                                        INT32_MAX));
+    }
+
+    std::vector<Actor*> GetTopHitActors(StaticFunctionTag*, int32_t count) {
+        std::vector<std::pair<Actor*, int32_t>> top;
+        SKSEManager::GetSingleton()->GetTopHitActors(static_cast<std::size_t>(std::clamp(count, 0, 128)), top);
+
+        std::vector<Actor*> result;
+        result.reserve(top.size());
+        for (const auto& entry : top) {
+            result.push_back(entry.first);
+        }
+        return result;
     }
 
     void Increment(StaticFunctionTag*, Actor* actor, int32_t by) {
@@ -71,9 +91,46 @@ namespace {
         return SKSEManager::GetSingleton()->GetHitCount(actor).value_or(0);
     }
 
-    int32_t* PopulateHitData(Actor* target, char* unk0) {
-        SKSEManager::GetSingleton()->IncrementHitCount(target, 1);
-        return OriginalPopulateHitData(target, unk0);
+    int32_t GetHitsInLast(StaticFunctionTag*, Actor* actor, int32_t seconds) {
+        if (!actor) {
+            return 0;
+        }
+        return static_cast<int32_t>(
+            SKSEManager::GetSingleton()->GetHitsInLast(actor, static_cast<uint32_t>(std::max(seconds, 1))));
+    }
+
+    float GetHitRate(StaticFunctionTag*, Actor* actor, int32_t seconds) {
+        if (!actor) {
+            return 0.0f;
+        }
+        return SKSEManager::GetSingleton()->GetHitRate(actor, static_cast<uint32_t>(std::max(seconds, 1)));
+    }
+
+    // Papyrus has no optional floats, so "never hit" is -1.0
+    float GetTimeSinceLastHit(StaticFunctionTag*, Actor* actor) {
+        if (!actor) {
+            return -1.0f;
+        }
+        return SKSEManager::GetSingleton()->GetTimeSinceLastHit(actor).value_or(-1.0f);
+    }
+
+    // Papyrus to Lua bridge. These natives are not callable from tasklets, so the VM runs them on the main thread,
+    // which is the only thread allowed to touch the Lua state.
+    float CallLua(StaticFunctionTag*, BSFixedString function, TESForm* target, std::vector<float> args) {
+        return LuaManager::GetSingleton()->CallFromPapyrus(function, target, args);
+    }
+
+    std::vector<float> CallLuaBatch(StaticFunctionTag*, BSFixedString function, std::vector<TESForm*> targets,
+                                    std::vector<float> args) {
+        std::vector<float> results;
+        LuaManager::GetSingleton()->CallBatchFromPapyrus(function, targets, args, results);
+        return results;
+    }
+
+    // Fire and forget: callable from tasklets, so the VM need not wait for the main thread. The event reaches the
+    // event bus when the main thread next drains the command queue.
+    bool QueueLuaEvent(StaticFunctionTag*, BSFixedString eventName, std::vector<float> args) {
+        return LuaCommandQueue::GetSingleton()->Push(eventName, args);
     }
 }
 
@@ -86,23 +143,25 @@ namespace {
 bool Sample::RegisterHitCounter(IVirtualMachine* vm) {
     vm->RegisterFunction("StartCounting", PapyrusClass, StartCounting);
     vm->RegisterFunction("StopCounting", PapyrusClass, StopCounting);
+    vm->RegisterFunction("StartCountingAll", PapyrusClass, StartCountingAll);
+    vm->RegisterFunction("GetCounts", PapyrusClass, GetCounts);
+    vm->RegisterFunction("ResetCounts", PapyrusClass, ResetCounts);
     vm->RegisterFunction("GetTotalHitCounters", PapyrusClass, GetTotalHitCounters);
+    vm->RegisterFunction("GetTotalHits", PapyrusClass, GetTotalHits);
+    vm->RegisterFunction("GetTopHitActors", PapyrusClass, GetTopHitActors);
     vm->RegisterFunction("Increment", PapyrusClass, Increment);
     vm->RegisterFunction("GetCount", PapyrusClass, GetCount);
+    vm->RegisterFunction("GetHitsInLast", PapyrusClass, GetHitsInLast);
+    vm->RegisterFunction("GetHitRate", PapyrusClass, GetHitRate);
+    vm->RegisterFunction("GetTimeSinceLastHit", PapyrusClass, GetTimeSinceLastHit);
 
     return true;
 }
 
-void Sample::InitializeHook(Trampoline& trampoline) {
-    // The trampoline can be used to write a new call instruction at a given address (here the start of the function for
-    // HitData::Populate). We use write_code<5> to indicate this is a 5-byte call instruction (rather than the much
-    // rarer 6-byte call). We pass in the address of our function that will be called, and a pointer to the trampoline
-    // function is returned.
-    //
-    // The trampoline pointed to contains any instructions from the original function we overwrote and a call to the
-    // instruction that comes after, so that if we call that address as a function, we are in effect calling the
-    // original code.
-    OriginalPopulateHitData = trampoline.write_call<5>(GetHookedFunction().address(),
-                                                       reinterpret_cast<uintptr_t>(PopulateHitData));
-    log::debug("Hit data hook written.");
+bool Sample::RegisterLuaBridge(IVirtualMachine* vm) {
+    vm->RegisterFunction("CallLua", LuaBridgeClass, CallLua);
+    vm->RegisterFunction("CallLuaBatch", LuaBridgeClass, CallLuaBatch);
+    vm->RegisterFunction("QueueLuaEvent", LuaBridgeClass, QueueLuaEvent, true);
+
+    return true;
 }
@@ -1,13 +1,51 @@
 #include <SKSE/SKSE.h>
 #include <Core/SKSEManager.h>
+#include <Core/ActorValues.h>
+#include <Core/ByteBuffer.h>
+#include <Core/FormIndex.h>
+#include <Core/HitRecord.h>
+#include <Core/LuaManager.h>
+#include <Core/LuaForms.h>
+#include <Core/SpatialIndex.h>
 
 using namespace RE;
 using namespace Sample;
 using namespace SKSE;
 
 namespace {
+    inline const auto HitsRecord = _byteswap_ulong('HITS');
+    constexpr std::uint32_t HitsRecordVersion = 1;
+
+    inline const auto LuaStateRecord = _byteswap_ulong('LUAS');
+    constexpr std::uint32_t LuaStateRecordVersion = 1;
+
+    // Written by older versions, which stored a size_t count followed by raw fields
     inline const auto TrackedActorsRecord = _byteswap_ulong('TACT');
     inline const auto HitCountsRecord = _byteswap_ulong('HITC');
+
+    void WriteRecord(SerializationInterface* serde, std::uint32_t type, std::uint32_t version,
+                     const ByteWriter& writer) {
+        if (!serde->OpenRecord(type, version)) {
+            log::error("Unable to open record to write cosave data.");
+            return;
+        }
+        if (!serde->WriteRecordData(writer.Data(), static_cast<std::uint32_t>(writer.Size()))) {
+            log::error("Unable to write {} bytes of record {:08X} to the cosave.", writer.Size(), type);
+        }
+    }
+
+    Actor* ResolveActor(SerializationInterface* serde, RE::FormID savedID) {
+        RE::FormID formID;
+        if (!serde->ResolveFormID(savedID, formID)) {
+            log::warn("Actor ID {:X} could not be found after loading the save.", savedID);
+            return nullptr;
+        }
+        auto* actor = TESForm::LookupByID<Actor>(formID);
+        if (!actor) {
+            log::warn("Actor ID {:X} could not be found after loading the save.", formID);
+        }
+        return actor;
+    }
 }
 
 // Basic functionality methods
@@ -17,42 +55,62 @@ SKSEManager* SKSEManager::GetSingleton() noexcept {
 }
 
 bool SKSEManager::TrackActor(Actor* target) {
-    if (!target) {
-        return false;
-    }
-    std::unique_lock lock(_lock);
-    return _trackedActors.emplace(target).second;
+    return _hits.Track(target);
 }
 
 bool SKSEManager::UntrackActor(Actor* target) {
-    if (!target) {
-        return false;
-    }
-    std::unique_lock lock(_lock);
-    return _trackedActors.erase(target);
+    return _hits.Untrack(target);
+}
+
+std::size_t SKSEManager::TrackActors(std::span<Actor* const> actors) {
+    return _hits.Track(actors);
+}
+
+void SKSEManager::ResetHitCounts(std::span<Actor* const> actors) {
+    _hits.ResetCounts(actors);
 }
 
 void SKSEManager::IncrementHitCount(Actor* target, int32_t by) {
-    if (!target) {
-        return;
-    }
-    std::unique_lock lock(_lock);
-    if (!_trackedActors.contains(target)) {
-        return;
-    }
-    auto result = _hitCounts.try_emplace(target, by);
-    if (!result.second) {
-        result.first->second += by;
-    }
+    _hits.Increment(target, by);
 }
 
 std::optional<int32_t> SKSEManager::GetHitCount(Actor* target) const noexcept {
-    std::unique_lock lock(_lock);
-    auto result = _hitCounts.find(target);
-    if (result == _hitCounts.end()) {
-        return {};
+    return _hits.GetCount(target);
+}
+
+void SKSEManager::GetHitCounts(std::span<Actor* const> targets, std::vector<std::optional<int32_t>>& out) const {
+    out.clear();
+    out.reserve(targets.size());
+    for (auto* target : targets) {
+        out.push_back(_hits.GetCount(target));
     }
-    return result->second;
+}
+
+uint32_t SKSEManager::GetHitsInLast(Actor* target, uint32_t seconds) const noexcept {
+    return _hits.GetHitsInLast(target, seconds);
+}
+
+float SKSEManager::GetHitRate(Actor* target, uint32_t seconds) const noexcept {
+    seconds = std::clamp<uint32_t>(seconds, 1, HitCounterTable::WindowSeconds);
+    return static_cast<float>(_hits.GetHitsInLast(target, seconds)) / static_cast<float>(seconds);
+}
+
+std::optional<float> SKSEManager::GetTimeSinceLastHit(Actor* target) const noexcept {
+    const auto elapsed = _hits.GetTimeSinceLastHit(target);
+    return elapsed ? std::optional{static_cast<float>(*elapsed)} : std::nullopt;
+}
+
+std::size_t SKSEManager::GetTrackedActorCount() const noexcept {
+    return _hits.GetTotals().tracked;
+}
+
+int64_t SKSEManager::GetTotalHits() const noexcept {
+    return _hits.GetTotals().hits;
+}
+
+void SKSEManager::GetTopHitActors(std::size_t count, std::vector<std::pair<Actor*, int32_t>>& out) const {
+    out.clear();
+    _hits.GetTop(count, out);
 }
 
 void SKSEManager::PrintToConsole(const std::string& message) {
@@ -77,48 +135,63 @@ Actor* SKSEManager::GetPlayer() const {
     return RE::PlayerCharacter::GetSingleton();
 }
 
-// NPC Management - Stub implementations
-void SKSEManager::ForceActorValue(Actor* actor, const std::string& avName, float value) {
+// NPC Management
+void SKSEManager::ForceActorValue(Actor* actor, std::string_view avName, float value) {
     if (!actor) {
         return;
     }
-    
-    auto avList = RE::ActorValueList::GetSingleton();
-    if (!avList) {
-        SKSE::log::error("ActorValueList singleton not available");
+
+    const auto av = LookupActorValue(avName);
+    if (av == ActorValue::kNone) {
+        SKSE::log::error("Invalid actor value name: {}", avName);
         return;
     }
-    
-    auto av = avList->LookupActorValueByName(avName);
-    if (av == RE::ActorValue::kNone) {
-        SKSE::log::error("Invalid actor value name: {}", avName);
+    ForceActorValue(actor, av, value);
+}
+
+void SKSEManager::ForceActorValue(Actor* actor, ActorValue av, float value) {
+    if (!actor || av == ActorValue::kNone) {
         return;
     }
-    
-    // Log that we're not actually setting anything
-    SKSE::log::info("ForceActorValue called for {}, but is stubbed. Value would be {}", avName, value);
+
+    // Like Papyrus ForceActorValue: move the current value by healing or adding damage first, and only change the
+    // base value for whatever an undamaged value cannot reach
+    auto* owner = actor->AsActorValueOwner();
+    float delta = value - owner->GetActorValue(av);
+    if (delta < 0.0f) {
+        owner->RestoreActorValue(ACTOR_VALUE_MODIFIER::kDamage, av, delta);
+        return;
+    }
+
+    const float damage = -actor->GetActorValueModifier(ACTOR_VALUE_MODIFIER::kDamage, av);
+    if (damage > 0.0f) {
+        const float healed = std::min(damage, delta);
+        owner->RestoreActorValue(ACTOR_VALUE_MODIFIER::kDamage, av, healed);
+        delta -= healed;
+    }
+    if (delta > 0.0f) {
+        owner->SetBaseActorValue(av, owner->GetBaseActorValue(av) + delta);
+    }
 }
 
-float SKSEManager::GetActorValue(Actor* actor, const std::string& avName) const {
+float SKSEManager::GetActorValue(Actor* actor, std::string_view avName) const {
     if (!actor) {
         return 0.0f;
     }
-    
-    auto avList = RE::ActorValueList::GetSingleton();
-    if (!avList) {
-        SKSE::log::error("ActorValueList singleton not available");
+
+    const auto av = LookupActorValue(avName);
+    if (av == ActorValue::kNone) {
+        SKSE::log::error("Invalid actor value name: {}", avName);
         return 0.0f;
     }
-    
-    auto av = avList->LookupActorValueByName(avName);
-    if (av == RE::ActorValue::kNone) {
-        SKSE::log::error("Invalid actor value name: {}", avName);
+    return GetActorValue(actor, av);
+}
+
+float SKSEManager::GetActorValue(Actor* actor, ActorValue av) const {
+    if (!actor || av == ActorValue::kNone) {
         return 0.0f;
     }
-    
-    // Return a default value
-    SKSE::log::info("GetActorValue called for {}, but is stubbed. Returning 0.0", avName);
-    return 0.0f;
+    return actor->AsActorValueOwner()->GetActorValue(av);
 }
 
 // Equipment functions - No changes needed here
@@ -168,23 +241,24 @@ bool SKSEManager::UnequipItem(Actor* actor, TESForm* item, bool silent) {
     return true;
 }
 
-// World interaction - Super simplified approach
+// World interaction
 TESObjectREFR* SKSEManager::FindClosestReferenceOfType(TESForm* formToMatch, float searchRadius) const {
-    // Mark the parameter as unused to avoid compiler warning
-    (void)searchRadius;
-    
     auto player = RE::PlayerCharacter::GetSingleton();
     if (!player || !formToMatch) {
         return nullptr;
     }
-    
-    // Return player if matching, otherwise null
-    SKSE::log::info("FindClosestReferenceOfType is a stub function");
-    if (player->GetBaseObject() == formToMatch) {
-        return player;
+
+    // Given a reference, match other references to the same base object
+    if (auto* ref = formToMatch->AsReference()) {
+        formToMatch = ref->GetBaseObject();
+        if (!formToMatch) {
+            return nullptr;
+        }
     }
-    
-    return nullptr;
+
+    const auto query = SpatialIndex::QueryAround(player, searchRadius, formToMatch->GetFormID());
+    const auto hit = SpatialIndex::GetSingleton()->FindClosest(query);
+    return hit ? TESForm::LookupByID<TESObjectREFR>(hit->formID) : nullptr;
 }
 
 // Quest and game state - Stub implementations
@@ -248,8 +322,8 @@ TESForm* SKSEManager::GetFormFromID(uint32_t formId) const {
 }
 
 TESForm* SKSEManager::GetFormFromEditorID(const std::string& editorId) const {
-    SKSE::log::info("GetFormFromEditorID called with editor ID {}, but is stubbed", editorId);
-    return nullptr;
+    const auto formId = FormIndex::GetSingleton()->FindByEditorID(editorId);
+    return formId ? TESForm::LookupByID(formId) : nullptr;
 }
 
 // Utility functions - No changes needed
@@ -279,92 +353,90 @@ RE::NiPoint3 SKSEManager::GetPlayerPosition() const {
     return RE::NiPoint3();  // Return default position (0,0,0) if player not found
 }
 
-// Serialization methods - No changes needed
+// Serialization methods
 void SKSEManager::OnRevert(SerializationInterface*) {
-    std::unique_lock lock(GetSingleton()->_lock);
-    GetSingleton()->_hitCounts.clear();
-    GetSingleton()->_trackedActors.clear();
+    GetSingleton()->_hits.Clear();
+    InvalidateFormHandles();
+    LuaManager::GetSingleton()->RevertPersistentTables();
     SKSE::log::info("SKSEManager state reverted.");
 }
 
 void SKSEManager::OnGameSaved(SerializationInterface* serde) {
-    std::unique_lock lock(GetSingleton()->_lock);
-    if (!serde->OpenRecord(HitCountsRecord, 0)) {
-        log::error("Unable to open record to write cosave data.");
-        return;
-    }
+    std::vector<SavedActor> actors;
+    GetSingleton()->_hits.ForEach([&](Actor* actor, bool tracked, std::optional<int32_t> count) {
+        actors.push_back({actor->formID, tracked, count});
+    });
 
-    auto hitCountsSize = GetSingleton()->_hitCounts.size();
-    serde->WriteRecordData(&hitCountsSize, sizeof(hitCountsSize));
-    for (auto& count : GetSingleton()->_hitCounts) {
-        serde->WriteRecordData(&count.first->formID, sizeof(count.first->formID));
-        serde->WriteRecordData(&count.second, sizeof(count.second));
-    }
+    ByteWriter writer;
+    WriteHitsRecord(actors, writer);
+    WriteRecord(serde, HitsRecord, HitsRecordVersion, writer);
 
-    if (!serde->OpenRecord(TrackedActorsRecord, 0)) {
-        log::error("Unable to open record to write cosave data.");
-        return;
-    }
-
-    auto trackedActorsCount = GetSingleton()->_trackedActors.size();
-    serde->WriteRecordData(&trackedActorsCount, sizeof(trackedActorsCount));
-    for (auto* actor : GetSingleton()->_trackedActors) {
-        serde->WriteRecordData(&actor->formID, sizeof(actor->formID));
+    ByteWriter luaState;
+    LuaManager::GetSingleton()->SavePersistentTables(luaState);
+    if (luaState.Size() > 0) {
+        WriteRecord(serde, LuaStateRecord, LuaStateRecordVersion, luaState);
     }
 }
 
 void SKSEManager::OnGameLoaded(SerializationInterface* serde) {
+    auto& hits = GetSingleton()->_hits;
+    std::vector<std::byte> buffer;
+    std::vector<SavedActor> actors;
+
     std::uint32_t type;
     std::uint32_t size;
     std::uint32_t version;
-    
     while (serde->GetNextRecordInfo(type, version, size)) {
-        if (type == HitCountsRecord) {
-            std::size_t hitCountsSize;
-            serde->ReadRecordData(&hitCountsSize, sizeof(hitCountsSize));
-            for (; hitCountsSize > 0; --hitCountsSize) {
-                RE::FormID actorFormID;
-                serde->ReadRecordData(&actorFormID, sizeof(actorFormID));
-                RE::FormID newActorFormID;
-                if (!serde->ResolveFormID(actorFormID, newActorFormID)) {
-                    log::warn("Actor ID {:X} could not be found after loading the save.", actorFormID);
-                    continue;
-                }
-                int32_t hitCount;
-                serde->ReadRecordData(&hitCount, sizeof(hitCount));
-                auto* actor = TESForm::LookupByID<Actor>(newActorFormID);
-                if (actor) {
-                    GetSingleton()->_hitCounts.try_emplace(actor, hitCount);
-                } else {
-                    log::warn("Actor ID {:X} could not be found after loading the save.", newActorFormID);
-                }
+        buffer.resize(size);
+        if (serde->ReadRecordData(buffer.data(), size) != size) {
+            log::error("Cosave record {:08X} is truncated.", type);
+            continue;
+        }
+
+        actors.clear();
+        ByteReader reader(buffer);
+        bool parsed;
+        if (type == HitsRecord) {
+            if (version > HitsRecordVersion) {
+                log::warn("Hit data was saved by a newer version of the plugin (record version {}); skipping it.",
+                          version);
+                continue;
             }
-        } else if (type == TrackedActorsRecord) {
-            std::size_t trackedActorsSize;
-            serde->ReadRecordData(&trackedActorsSize, sizeof(trackedActorsSize));
-            for (; trackedActorsSize > 0; --trackedActorsSize) {
-                RE::FormID actorFormID;
-                serde->ReadRecordData(&actorFormID, sizeof(actorFormID));
-                RE::FormID newActorFormID;
-                if (!serde->ResolveFormID(actorFormID, newActorFormID)) {
-                    log::warn("Actor ID {:X} could not be found after loading the save.", actorFormID);
-                    continue;
-                }
-                auto* actor = TESForm::LookupByID<Actor>(newActorFormID);
-                if (actor) {
-                    GetSingleton()->_trackedActors.emplace(actor);
-                } else {
-                    log::warn("Actor ID {:X} could not be found after loading the save.", newActorFormID);
-                }
+            parsed = ParseHitsRecord(reader, actors);
+        } else if (type == LuaStateRecord) {
+            if (version > LuaStateRecordVersion) {
+                log::warn("Lua tables were saved by a newer version of the plugin (record version {}); skipping them.",
+                          version);
+            } else if (!LuaManager::GetSingleton()->LoadPersistentTables(
+                           buffer, [serde](RE::FormID savedID, RE::FormID& formID) {
+                               return serde->ResolveFormID(savedID, formID);
+                           })) {
+                log::error("The persisted Lua tables in the cosave are corrupt.");
             }
+            continue;
+        } else if (type == HitCountsRecord) {
+            parsed = ParseLegacyHitCounts(reader, actors);
+        } else if (type == TrackedActorsRecord) {
+            parsed = ParseLegacyTrackedActors(reader, actors);
         } else {
             log::warn("Unknown record type in cosave.");
+            continue;
+        }
+        if (!parsed) {
+            log::error("Cosave record {:08X} is corrupt; loaded the first {} entries.", type, actors.size());
+        }
+
+        for (const auto& saved : actors) {
+            auto* actor = ResolveActor(serde, saved.formID);
+            if (!actor) {
+                continue;
+            }
+            if (saved.count) {
+                hits.SetCount(actor, *saved.count);
+            }
+            if (saved.tracked) {
+                hits.Track(actor);
+            }
         }
     }
 }
-
-void SKSEManager::RegisterLuaUpdateCallback(int functionRef) {
-    std::unique_lock lock(_lock);
-    _luaUpdateCallbacks.push_back(functionRef);
-    SKSE::log::info("Registered Lua update callback with reference ID: {}", functionRef);
-}
\ No newline at end of file
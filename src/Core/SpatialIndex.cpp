@@ -0,0 +1,453 @@
+#include "Core/SpatialIndex.h"
+
+#include <SKSE/SKSE.h>
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+using namespace RE;
+using namespace Sample;
+
+namespace {
+    class ReferenceEventSink : public BSTEventSink<TESCellAttachDetachEvent>,
+                               public BSTEventSink<TESObjectLoadedEvent>,
+                               public BSTEventSink<TESMoveAttachDetachEvent>,
+                               public BSTEventSink<TESFormDeleteEvent> {
+    public:
+        BSEventNotifyControl ProcessEvent(const TESCellAttachDetachEvent* event,
+                                          BSTEventSource<TESCellAttachDetachEvent>*) override {
+            if (event && event->reference) {
+                if (event->attached) {
+                    SpatialIndex::GetSingleton()->Add(event->reference.get());
+                } else {
+                    SpatialIndex::GetSingleton()->Remove(event->reference->GetFormID());
+                }
+            }
+            return BSEventNotifyControl::kContinue;
+        }
+
+        // Catches references placed at runtime, which do not come with a cell attach
+        BSEventNotifyControl ProcessEvent(const TESObjectLoadedEvent* event,
+                                          BSTEventSource<TESObjectLoadedEvent>*) override {
+            if (event && event->loaded) {
+                SpatialIndex::GetSingleton()->Add(TESForm::LookupByID<TESObjectREFR>(event->formID));
+            }
+            return BSEventNotifyControl::kContinue;
+        }
+
+        BSEventNotifyControl ProcessEvent(const TESMoveAttachDetachEvent* event,
+                                          BSTEventSource<TESMoveAttachDetachEvent>*) override {
+            if (event && event->movedRef) {
+                if (event->isCellAttached) {
+                    SpatialIndex::GetSingleton()->Add(event->movedRef.get());
+                } else {
+                    SpatialIndex::GetSingleton()->Remove(event->movedRef->GetFormID());
+                }
+            }
+            return BSEventNotifyControl::kContinue;
+        }
+
+        BSEventNotifyControl ProcessEvent(const TESFormDeleteEvent* event,
+                                          BSTEventSource<TESFormDeleteEvent>*) override {
+            if (event) {
+                SpatialIndex::GetSingleton()->Remove(event->formID);
+            }
+            return BSEventNotifyControl::kContinue;
+        }
+    };
+
+    struct FartherFirst {
+        bool operator()(const SpatialIndex::Hit& left, const SpatialIndex::Hit& right) const noexcept {
+            return left.distance < right.distance;
+        }
+    };
+
+    void SortByDistance(std::vector<SpatialIndex::Hit>& hits, std::size_t from) {
+        std::sort(hits.begin() + static_cast<std::ptrdiff_t>(from), hits.end(),
+                  [](const SpatialIndex::Hit& left, const SpatialIndex::Hit& right) {
+                      return left.distance < right.distance;
+                  });
+    }
+}
+
+SpatialIndex* SpatialIndex::GetSingleton() noexcept {
+    static SpatialIndex instance;
+    return &instance;
+}
+
+FormID SpatialIndex::GetSpace(const TESObjectREFR* ref) noexcept {
+    if (!ref) {
+        return 0;
+    }
+    if (auto* worldspace = ref->GetWorldspace()) {
+        return worldspace->GetFormID();
+    }
+    if (auto* cell = ref->GetParentCell()) {
+        return cell->GetFormID();
+    }
+    return 0;
+}
+
+SpatialIndex::Query SpatialIndex::QueryAround(const TESObjectREFR* ref, float radius, FormID baseID) {
+    Query query;
+    query.radius = radius;
+    query.baseID = baseID;
+    if (ref) {
+        query.space = GetSpace(ref);
+        query.origin = ref->GetPosition();
+        query.exclude = ref->GetFormID();
+    }
+    return query;
+}
+
+std::uint64_t SpatialIndex::CellKey(FormID space, std::int32_t x, std::int32_t y) noexcept {
+    return (static_cast<std::uint64_t>(space) << 32) | (static_cast<std::uint64_t>(static_cast<std::uint16_t>(x)) << 16) |
+           static_cast<std::uint16_t>(y);
+}
+
+std::int32_t SpatialIndex::CellCoordinate(float value) noexcept {
+    return static_cast<std::int32_t>(std::floor(value / CellSize));
+}
+
+std::int32_t SpatialIndex::KeyX(std::uint64_t key) noexcept {
+    return static_cast<std::int16_t>(key >> 16);
+}
+
+std::int32_t SpatialIndex::KeyY(std::uint64_t key) noexcept {
+    return static_cast<std::int16_t>(key);
+}
+
+void SpatialIndex::Rebuild() {
+    Clear();
+    auto* tes = TES::GetSingleton();
+    if (!tes) {
+        return;
+    }
+
+    // The callback takes a pointer or a reference depending on the CommonLib version
+    tes->ForEachReference([this](auto&& ref) {
+        if constexpr (std::is_pointer_v<std::remove_cvref_t<decltype(ref)>>) {
+            Add(ref);
+        } else {
+            Add(&ref);
+        }
+        return BSContainer::ForEachResult::kContinue;
+    });
+
+    const auto stats = GetStats();
+    SKSE::log::info("Spatial index rebuilt: {} references ({} actors) in {} grid cells", stats.references,
+                    stats.mobile, stats.cells);
+}
+
+void SpatialIndex::Add(TESObjectREFR* ref) {
+    if (!ref || ref->IsDisabled()) {
+        return;
+    }
+
+    const auto formID = ref->GetFormID();
+    const auto* base = ref->GetBaseObject();
+    const auto space = GetSpace(ref);
+    const auto position = ref->GetPosition();
+    const bool mobile = ref->As<Actor>() != nullptr;
+    const auto key = CellKey(space, CellCoordinate(position.x), CellCoordinate(position.y));
+
+    std::unique_lock lock(_lock);
+    if (const auto it = _byFormID.find(formID); it != _byFormID.end()) {
+        auto& entry = _entries[it->second];
+        entry.position = position;
+        if (entry.cell != key) {
+            Unplace(it->second);
+            Place(it->second, key);
+            ++_stats.relocated;
+        }
+        return;
+    }
+
+    std::uint32_t index;
+    if (!_freeEntries.empty()) {
+        index = _freeEntries.back();
+        _freeEntries.pop_back();
+    } else {
+        index = static_cast<std::uint32_t>(_entries.size());
+        _entries.emplace_back();
+    }
+
+    _entries[index] = {ref, formID, base ? base->GetFormID() : 0, position, key, None, None};
+    Place(index, key);
+    if (mobile) {
+        _entries[index].slotInMobile = static_cast<std::uint32_t>(_mobile.size());
+        _mobile.push_back(index);
+    }
+    _byFormID.emplace(formID, index);
+}
+
+void SpatialIndex::Remove(FormID formID) {
+    std::unique_lock lock(_lock);
+    if (const auto it = _byFormID.find(formID); it != _byFormID.end()) {
+        const auto index = it->second;
+        _byFormID.erase(it);
+        RemoveIndex(index);
+    }
+}
+
+void SpatialIndex::Clear() {
+    std::unique_lock lock(_lock);
+    _entries.clear();
+    _freeEntries.clear();
+    _byFormID.clear();
+    _cells.clear();
+    _bounds.clear();
+    _mobile.clear();
+    _refreshCursor = 0;
+}
+
+void SpatialIndex::Refresh() {
+    std::unique_lock lock(_lock);
+    const auto count = std::min(RefreshPerFrame, _mobile.size());
+    for (std::size_t i = 0; i < count; ++i) {
+        if (_refreshCursor >= _mobile.size()) {
+            _refreshCursor = 0;
+        }
+        const auto index = _mobile[_refreshCursor++];
+        auto& entry = _entries[index];
+        entry.position = entry.ref->GetPosition();
+        const auto key =
+            CellKey(GetSpace(entry.ref), CellCoordinate(entry.position.x), CellCoordinate(entry.position.y));
+        if (key != entry.cell) {
+            Unplace(index);
+            Place(index, key);
+            ++_stats.relocated;
+        }
+    }
+    _stats.refreshed += count;
+}
+
+void SpatialIndex::Place(std::uint32_t index, std::uint64_t key) {
+    auto& cell = _cells[key];
+    _entries[index].cell = key;
+    _entries[index].slotInCell = static_cast<std::uint32_t>(cell.size());
+    cell.push_back(index);
+
+    const auto x = KeyX(key);
+    const auto y = KeyY(key);
+    const auto [bounds, added] = _bounds.try_emplace(static_cast<FormID>(key >> 32), Bounds{x, y, x, y});
+    if (!added) {
+        auto& box = bounds->second;
+        box = {std::min(box.minX, x), std::min(box.minY, y), std::max(box.maxX, x), std::max(box.maxY, y)};
+    }
+}
+
+void SpatialIndex::Unplace(std::uint32_t index) {
+    const auto it = _cells.find(_entries[index].cell);
+    auto& cell = it->second;
+    const auto slot = _entries[index].slotInCell;
+    cell[slot] = cell.back();
+    _entries[cell[slot]].slotInCell = slot;
+    cell.pop_back();
+    if (cell.empty()) {
+        const auto key = it->first;
+        _cells.erase(it);
+        UpdateBounds(key);
+    }
+}
+
+void SpatialIndex::UpdateBounds(std::uint64_t emptied) {
+    const auto space = static_cast<FormID>(emptied >> 32);
+    const auto bounds = _bounds.find(space);
+    const auto& box = bounds->second;
+    const auto x = KeyX(emptied);
+    const auto y = KeyY(emptied);
+    if (x != box.minX && x != box.maxX && y != box.minY && y != box.maxY) {
+        return;  // An inner square; the box is unchanged
+    }
+
+    // Squares empty as cells detach, a handful at a time, so recomputing from the occupied squares is cheap
+    std::optional<Bounds> shrunk;
+    for (const auto& [key, cell] : _cells) {
+        if (static_cast<FormID>(key >> 32) != space) {
+            continue;
+        }
+        const auto kx = KeyX(key);
+        const auto ky = KeyY(key);
+        shrunk = shrunk ? Bounds{std::min(shrunk->minX, kx), std::min(shrunk->minY, ky), std::max(shrunk->maxX, kx),
+                                 std::max(shrunk->maxY, ky)}
+                        : Bounds{kx, ky, kx, ky};
+    }
+    if (shrunk) {
+        bounds->second = *shrunk;
+    } else {
+        _bounds.erase(bounds);
+    }
+}
+
+void SpatialIndex::RemoveIndex(std::uint32_t index) {
+    Unplace(index);
+
+    auto& entry = _entries[index];
+    if (entry.slotInMobile != None) {
+        const auto slot = entry.slotInMobile;
+        _mobile[slot] = _mobile.back();
+        _entries[_mobile[slot]].slotInMobile = slot;
+        _mobile.pop_back();
+    }
+    entry = {};
+    _freeEntries.push_back(index);
+}
+
+template <class F>
+void SpatialIndex::VisitCell(const Query& query, std::uint64_t key, F&& visit) const {
+    const auto it = _cells.find(key);
+    if (it == _cells.end()) {
+        return;
+    }
+    for (const auto index : it->second) {
+        const auto& entry = _entries[index];
+        if ((query.baseID && entry.baseID != query.baseID) || entry.formID == query.exclude) {
+            continue;
+        }
+        const float distance = entry.position.GetDistance(query.origin);
+        if (distance <= query.radius) {
+            visit(Hit{entry.formID, distance});
+        }
+    }
+}
+
+template <class F>
+void SpatialIndex::Search(const Query& query, bool exhaustive, F&& visitRing) const {
+    ++_stats.queries;
+    const auto bounds = _bounds.find(query.space);
+    if (query.radius < 0.0f || bounds == _bounds.end()) {
+        return;
+    }
+
+    const auto originX = CellCoordinate(query.origin.x);
+    const auto originY = CellCoordinate(query.origin.y);
+    // Grid coordinates are 16-bit, so no search needs more rings than that
+    const auto radiusRings = static_cast<std::int64_t>(std::ceil(std::min(query.radius / CellSize, 32768.0f)));
+    // Nor more than it takes to reach the farthest occupied square; this is what ends a search that finds too little
+    const auto& box = bounds->second;
+    const auto originKey = CellKey(query.space, originX, originY);
+    const auto x = KeyX(originKey);
+    const auto y = KeyY(originKey);
+    const auto reach = std::max({x - box.minX, box.maxX - x, y - box.minY, box.maxY - y, 0});
+    const auto rings = std::min<std::int64_t>(radiusRings, reach);
+
+    // A query that visits every ring anyway is cheaper to answer by walking the occupied squares when the rings span
+    // more squares than are occupied
+    if (exhaustive && (2 * rings + 1) * (2 * rings + 1) > static_cast<std::int64_t>(_cells.size())) {
+        visitRing(0, [&](auto&& visit) {
+            for (const auto& [key, cell] : _cells) {
+                if (key >> 32 == query.space) {
+                    VisitCell(query, key, visit);
+                }
+            }
+        });
+        return;
+    }
+
+    for (std::int32_t ring = 0; ring <= rings; ++ring) {
+        // Anything in this ring is at least (ring - 1) squares away from the origin
+        const float nearest = ring == 0 ? 0.0f : static_cast<float>(ring - 1) * CellSize;
+        const bool keepGoing = visitRing(nearest, [&](auto&& visit) {
+            const auto cell = [&](std::int32_t x, std::int32_t y) {
+                VisitCell(query, CellKey(query.space, x, y), visit);
+            };
+            if (ring == 0) {
+                cell(originX, originY);
+                return;
+            }
+            for (std::int32_t d = -ring; d <= ring; ++d) {
+                cell(originX + d, originY - ring);
+                cell(originX + d, originY + ring);
+            }
+            for (std::int32_t d = -ring + 1; d < ring; ++d) {
+                cell(originX - ring, originY + d);
+                cell(originX + ring, originY + d);
+            }
+        });
+        if (!keepGoing) {
+            return;
+        }
+    }
+}
+
+std::optional<SpatialIndex::Hit> SpatialIndex::FindClosest(const Query& query) const {
+    std::unique_lock lock(_lock);
+    std::optional<Hit> best;
+    Search(query, false, [&](float nearest, auto&& scan) {
+        if (best && nearest > best->distance) {
+            return false;
+        }
+        scan([&](const Hit& hit) {
+            if (!best || hit.distance < best->distance) {
+                best = hit;
+            }
+        });
+        return true;
+    });
+    return best;
+}
+
+void SpatialIndex::FindInRadius(const Query& query, std::vector<Hit>& out) const {
+    const auto from = out.size();
+    {
+        std::unique_lock lock(_lock);
+        Search(query, true, [&](float, auto&& scan) {
+            scan([&](const Hit& hit) { out.push_back(hit); });
+            return true;
+        });
+    }
+    SortByDistance(out, from);
+}
+
+void SpatialIndex::FindNearest(const Query& query, std::size_t count, std::vector<Hit>& out) const {
+    if (count == 0) {
+        return;
+    }
+
+    // Max-heap on distance holding the best candidates so far
+    std::priority_queue<Hit, std::vector<Hit>, FartherFirst> best;
+    {
+        std::unique_lock lock(_lock);
+        Search(query, false, [&](float nearest, auto&& scan) {
+            if (best.size() == count && nearest > best.top().distance) {
+                return false;
+            }
+            scan([&](const Hit& hit) {
+                if (best.size() < count) {
+                    best.push(hit);
+                } else if (hit.distance < best.top().distance) {
+                    best.pop();
+                    best.push(hit);
+                }
+            });
+            return true;
+        });
+    }
+
+    const auto from = out.size();
+    for (; !best.empty(); best.pop()) {
+        out.push_back(best.top());
+    }
+    SortByDistance(out, from);
+}
+
+SpatialIndex::Stats SpatialIndex::GetStats() const {
+    std::unique_lock lock(_lock);
+    auto stats = _stats;
+    stats.references = _byFormID.size();
+    stats.mobile = _mobile.size();
+    stats.cells = _cells.size();
+    return stats;
+}
+
+void SpatialIndex::InitializeEvents() {
+    static ReferenceEventSink sink;
+    if (auto* events = ScriptEventSourceHolder::GetSingleton()) {
+        events->AddEventSink<TESCellAttachDetachEvent>(&sink);
+        events->AddEventSink<TESObjectLoadedEvent>(&sink);
+        events->AddEventSink<TESMoveAttachDetachEvent>(&sink);
+        events->AddEventSink<TESFormDeleteEvent>(&sink);
+    }
+}
@@ -0,0 +1,200 @@
+#include "Core/TaskScheduler.h"
+
+extern "C" {
+#include <lua.h>
+#include <lauxlib.h>
+}
+
+#include <SKSE/SKSE.h>
+
+namespace Sample {
+
+    void TaskScheduler::Spawn(lua_State* L, int nargs) {
+        const std::uint32_t index = Acquire(L);
+        lua_xmove(L, _tasks[index].thread, nargs + 1);
+        ++_stats.spawned;
+        Resume(L, index, nargs);
+    }
+
+    bool TaskScheduler::WaitSeconds(lua_State* thread, double seconds) {
+        const auto index = FindYieldableTask(thread);
+        if (!index) {
+            return false;
+        }
+        _sleeping.Schedule(static_cast<std::uint64_t>(std::max(seconds, 0.0) * 1000.0), 0, *index);
+        _tasks[*index].waiting = true;
+        return true;
+    }
+
+    bool TaskScheduler::WaitFrames(lua_State* thread, std::uint32_t frames) {
+        const auto index = FindYieldableTask(thread);
+        if (!index) {
+            return false;
+        }
+        _waitingFrames.Schedule(frames, 0, *index);
+        _tasks[*index].waiting = true;
+        return true;
+    }
+
+    bool TaskScheduler::WaitForEvent(lua_State* thread, std::string_view eventName) {
+        const auto index = FindYieldableTask(thread);
+        if (!index) {
+            return false;
+        }
+        auto waiters = _waitingEvents.find(eventName);
+        if (waiters == _waitingEvents.end()) {
+            waiters = _waitingEvents.emplace(std::string(eventName), std::vector<std::uint32_t>{}).first;
+        }
+        waiters->second.push_back(*index);
+        _tasks[*index].waiting = true;
+        return true;
+    }
+
+    std::size_t TaskScheduler::SignalEvent(lua_State* L, std::string_view eventName, int firstArg, int nargs) {
+        auto found = _waitingEvents.find(eventName);
+        if (found == _waitingEvents.end() || found->second.empty()) {
+            return 0;
+        }
+
+        // Tasks that wait for the same event again while being resumed are queued for the next signal. References
+        // into the map stay valid even if resumed tasks add new events.
+        auto& list = found->second;
+        std::vector<std::uint32_t> waiters;
+        waiters.swap(list);
+        for (const std::uint32_t index : waiters) {
+            lua_State* thread = _tasks[index].thread;
+            for (int i = 0; i < nargs; ++i) {
+                lua_pushvalue(L, firstArg + i);
+            }
+            lua_xmove(L, thread, nargs);
+            Resume(L, index, nargs);
+        }
+
+        const std::size_t resumed = waiters.size();
+        if (list.empty()) {
+            waiters.clear();
+            list.swap(waiters);  // keep the capacity for the next wait
+        }
+        return resumed;
+    }
+
+    bool TaskScheduler::HasWaiters(std::string_view eventName) const {
+        const auto found = _waitingEvents.find(eventName);
+        return found != _waitingEvents.end() && !found->second.empty();
+    }
+
+    void TaskScheduler::Tick(lua_State* L, float deltaTime) {
+        auto ready = [this](TimerWheel::TimerId, std::uint32_t index, bool) { _ready.push_back(index); };
+
+        _waitingFrames.Advance(1, ready);
+
+        _remainderMs += static_cast<double>(deltaTime) * 1000.0;
+        const auto ticks = static_cast<std::uint64_t>(_remainderMs);
+        _remainderMs -= static_cast<double>(ticks);
+        _sleeping.Advance(ticks, ready);
+
+        if (_ready.empty()) {
+            return;
+        }
+
+        // Tasks that go back to sleep for zero time while being resumed wake on the next tick, not this one
+        _resuming.swap(_ready);
+        for (const std::uint32_t index : _resuming) {
+            Resume(L, index, 0);
+        }
+        _resuming.clear();
+    }
+
+    void TaskScheduler::Clear() noexcept {
+        _tasks.clear();
+        _pooled.clear();
+        _freeSlots.clear();
+        _taskByThread.clear();
+        _sleeping.Clear();
+        _waitingFrames.Clear();
+        _remainderMs = 0.0;
+        _waitingEvents.clear();
+        _ready.clear();
+        _resuming.clear();
+    }
+
+    TaskScheduler::Stats TaskScheduler::GetStats() const noexcept {
+        Stats stats = _stats;
+        stats.pooled = _pooled.size();
+        stats.suspended = _taskByThread.size() - _pooled.size();
+        return stats;
+    }
+
+    std::uint32_t TaskScheduler::Acquire(lua_State* L) {
+        if (!_pooled.empty()) {
+            const std::uint32_t index = _pooled.back();
+            _pooled.pop_back();
+            return index;
+        }
+
+        lua_State* thread = lua_newthread(L);
+        const int threadRef = luaL_ref(L, LUA_REGISTRYINDEX);
+
+        std::uint32_t index;
+        if (!_freeSlots.empty()) {
+            index = _freeSlots.back();
+            _freeSlots.pop_back();
+            _tasks[index] = {thread, threadRef, false};
+        } else {
+            index = static_cast<std::uint32_t>(_tasks.size());
+            _tasks.push_back({thread, threadRef, false});
+        }
+        _taskByThread.emplace(thread, index);
+        return index;
+    }
+
+    void TaskScheduler::Resume(lua_State* L, std::uint32_t index, int nargs) {
+        ++_stats.resumes;
+        lua_State* thread = _tasks[index].thread;
+        _tasks[index].waiting = false;
+
+        int results = 0;
+        const int status = lua_resume(thread, L, nargs, &results);
+        if (status == LUA_YIELD) {
+            lua_pop(thread, results);
+            // A bare coroutine.yield() inside a task waits for the next frame
+            if (!_tasks[index].waiting) {
+                _waitingFrames.Schedule(1, 0, index);
+                _tasks[index].waiting = true;
+            }
+            return;
+        }
+
+        if (status == LUA_OK) {
+            ++_stats.completed;
+            lua_settop(thread, 0);
+            if (_pooled.size() < MaxPooledThreads) {
+                _pooled.push_back(index);
+            } else {
+                Retire(L, index);
+            }
+            return;
+        }
+
+        ++_stats.failed;
+        luaL_traceback(L, thread, lua_tostring(thread, -1), 0);
+        SKSE::log::error("Task failed: {}", lua_tostring(L, -1));
+        lua_pop(L, 1);  // pop traceback
+        Retire(L, index);
+    }
+
+    void TaskScheduler::Retire(lua_State* L, std::uint32_t index) {
+        _taskByThread.erase(_tasks[index].thread);
+        luaL_unref(L, LUA_REGISTRYINDEX, _tasks[index].threadRef);
+        _tasks[index] = {nullptr, LUA_NOREF, false};
+        _freeSlots.push_back(index);
+    }
+
+    std::optional<std::uint32_t> TaskScheduler::FindYieldableTask(lua_State* thread) const {
+        const auto found = _taskByThread.find(thread);
+        if (found == _taskByThread.end() || !lua_isyieldable(thread)) {
+            return std::nullopt;
+        }
+        return found->second;
+    }
+}
@@ -0,0 +1,98 @@
+#include "Core/TimerWheel.h"
+
+#include <algorithm>
+
+namespace Sample {
+
+    TimerWheel::TimerId TimerWheel::Schedule(std::uint64_t delay, std::uint64_t interval, std::uint32_t payload) {
+        std::uint32_t index;
+        if (!_freeNodes.empty()) {
+            index = _freeNodes.back();
+            _freeNodes.pop_back();
+        } else {
+            index = static_cast<std::uint32_t>(_nodes.size());
+            _nodes.push_back({});
+        }
+
+        auto& node = _nodes[index];
+        node.expiry = _now + std::clamp<std::uint64_t>(delay, 1, MaxDelay);
+        node.interval = std::min(interval, MaxDelay);
+        node.payload = payload;
+        node.active = true;
+        Link(index);
+        ++_count;
+        return MakeId(index, node.generation);
+    }
+
+    bool TimerWheel::Cancel(TimerId id, std::uint32_t* payload) {
+        const auto index = static_cast<std::uint32_t>(id);
+        const auto generation = static_cast<std::uint32_t>(id >> 32);
+        if (index >= _nodes.size() || !_nodes[index].active || _nodes[index].generation != generation) {
+            return false;
+        }
+
+        if (payload) {
+            *payload = _nodes[index].payload;
+        }
+        Unlink(index);
+        Release(index);
+        return true;
+    }
+
+    void TimerWheel::Clear() noexcept {
+        _nodes.clear();
+        _freeNodes.clear();
+        _slots = MakeEmptySlots();
+        _count = 0;
+    }
+
+    void TimerWheel::Link(std::uint32_t index) noexcept {
+        auto& node = _nodes[index];
+        const std::uint64_t delta = node.expiry - _now;
+
+        unsigned level = 0;
+        while (level + 1 < Levels && delta >= (std::uint64_t{1} << (LevelBits * (level + 1)))) {
+            ++level;
+        }
+        const auto slot = level * SlotsPerLevel +
+                          static_cast<unsigned>((node.expiry >> (LevelBits * level)) & (SlotsPerLevel - 1));
+
+        node.slot = slot;
+        node.prev = Nil;
+        node.next = _slots[slot];
+        if (node.next != Nil) {
+            _nodes[node.next].prev = index;
+        }
+        _slots[slot] = index;
+    }
+
+    void TimerWheel::Unlink(std::uint32_t index) noexcept {
+        auto& node = _nodes[index];
+        if (node.prev != Nil) {
+            _nodes[node.prev].next = node.next;
+        } else {
+            _slots[node.slot] = node.next;
+        }
+        if (node.next != Nil) {
+            _nodes[node.next].prev = node.prev;
+        }
+    }
+
+    void TimerWheel::Release(std::uint32_t index) {
+        auto& node = _nodes[index];
+        node.active = false;
+        ++node.generation;
+        _freeNodes.push_back(index);
+        --_count;
+    }
+
+    void TimerWheel::Cascade(unsigned level, unsigned slot) noexcept {
+        std::uint32_t index = _slots[level * SlotsPerLevel + slot];
+        _slots[level * SlotsPerLevel + slot] = Nil;
+        while (index != Nil) {
+            const std::uint32_t next = _nodes[index].next;
+            Link(index);
+            index = next;
+        }
+    }
+}
@@ -0,0 +1,93 @@
+#include "Core/UpdateDispatcher.h"
+
+extern "C" {
+#include <lua.h>
+#include <lauxlib.h>
+}
+
+#include <SKSE/SKSE.h>
+
+namespace Sample {
+
+    std::uint32_t UpdateDispatcher::Register(int functionRef, Tier tier, std::uint32_t period) {
+        const std::uint32_t handle = _nextHandle++;
+        period = tier == Tier::kEveryFrame ? 1 : std::max(period, 1u);
+        _callbacks.push_back({handle, functionRef, tier, period, tier == Tier::kEveryNFrames ? handle % period : 0});
+        return handle;
+    }
+
+    bool UpdateDispatcher::Unregister(lua_State* L, std::uint32_t handle) {
+        auto callback = std::ranges::find(_callbacks, handle, &Callback::handle);
+        if (callback == _callbacks.end() || callback->removed) {
+            return false;
+        }
+
+        luaL_unref(L, LUA_REGISTRYINDEX, callback->functionRef);
+        if (_dispatching) {
+            callback->removed = true;  // compacted once the dispatch loop is done
+        } else {
+            _callbacks.erase(callback);
+        }
+        return true;
+    }
+
+    void UpdateDispatcher::Dispatch(lua_State* L, float deltaTime) {
+        ++_frame;
+        _dispatching = true;
+
+        // Callbacks registered while dispatching are picked up next frame; index rather than iterate because they
+        // may reallocate the vector
+        const std::size_t count = _callbacks.size();
+        for (std::size_t i = 0; i < count; ++i) {
+            auto& callback = _callbacks[i];
+            if (callback.removed) {
+                continue;
+            }
+
+            callback.elapsed += deltaTime;
+            bool due = true;
+            if (callback.tier == Tier::kEveryNFrames) {
+                due = (_frame + callback.phase) % callback.period == 0;
+            } else if (callback.tier == Tier::kInterval) {
+                due = callback.elapsed * 1000.0f >= static_cast<float>(callback.period);
+            }
+            if (!due) {
+                continue;
+            }
+
+            const float elapsed = callback.elapsed;
+            callback.elapsed = 0.0f;
+
+            lua_rawgeti(L, LUA_REGISTRYINDEX, callback.functionRef);
+            lua_pushnumber(L, elapsed);
+            const auto start = std::chrono::steady_clock::now();
+            const int status = lua_pcall(L, 1, 0, 0);
+            const auto micros = static_cast<std::uint32_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start)
+                    .count());
+
+            auto& after = _callbacks[i];
+            ++after.calls;
+            after.totalMicros += micros;
+            after.maxMicros = std::max(after.maxMicros, micros);
+
+            if (status != LUA_OK) {
+                SKSE::log::error("Update callback {} raised an error and was removed: {}", after.handle,
+                                 lua_tostring(L, -1));
+                lua_pop(L, 1);  // pop error message
+                if (!after.removed) {
+                    luaL_unref(L, LUA_REGISTRYINDEX, after.functionRef);
+                    after.removed = true;
+                }
+            }
+        }
+
+        _dispatching = false;
+        std::erase_if(_callbacks, [](const Callback& callback) { return callback.removed; });
+    }
+
+    void UpdateDispatcher::Clear() noexcept {
+        _callbacks.clear();
+        _frame = 0;
+    }
+}
@@ -0,0 +1,91 @@
+#include "Core/WriteBatch.h"
+
+using namespace RE;
+using namespace Sample;
+
+WriteBatch::Slot WriteBatch::GetSlot(const Write& write) noexcept {
+    switch (write.op) {
+        case Op::kEquip:
+        case Op::kUnequip:
+            return {static_cast<std::uint8_t>(Op::kEquip), write.target, write.key};
+        case Op::kWeather:
+            return {static_cast<std::uint8_t>(Op::kWeather), 0, 0};
+        default:
+            return {static_cast<std::uint8_t>(write.op), write.target, write.key};
+    }
+}
+
+void WriteBatch::SetDeferred(bool deferred) {
+    if (_deferred && !deferred) {
+        Flush();
+    }
+    _deferred = deferred;
+}
+
+bool WriteBatch::SetActorValue(Actor* actor, ActorValue av, float value) {
+    return Issue({Op::kActorValue, false, false, actor->GetFormID(), static_cast<std::uint32_t>(av), value});
+}
+
+bool WriteBatch::EquipItem(Actor* actor, TESForm* item, bool preventRemoval, bool silent) {
+    return Issue({Op::kEquip, preventRemoval, silent, actor->GetFormID(), item->GetFormID(), 0.0f});
+}
+
+bool WriteBatch::UnequipItem(Actor* actor, TESForm* item, bool silent) {
+    return Issue({Op::kUnequip, false, silent, actor->GetFormID(), item->GetFormID(), 0.0f});
+}
+
+bool WriteBatch::ForceWeather(TESWeather* weather) {
+    return Issue({Op::kWeather, false, false, weather->GetFormID(), 0, 0.0f});
+}
+
+bool WriteBatch::Issue(const Write& write) {
+    ++_stats.issued;
+    if (!_deferred) {
+        return Apply(write);
+    }
+
+    const auto [slot, inserted] = _slots.try_emplace(GetSlot(write), _writes.size());
+    if (inserted) {
+        _writes.push_back(write);
+        return true;
+    }
+
+    auto& pending = _writes[slot->second];
+    if ((pending.op == Op::kEquip && write.op == Op::kUnequip) ||
+        (pending.op == Op::kUnequip && write.op == Op::kEquip)) {
+        // The entry stays in place so the indices of later writes hold; the flush skips it
+        pending.op = Op::kNone;
+        _slots.erase(slot);
+        ++_stats.cancelled;
+        return true;
+    }
+    pending = write;
+    ++_stats.coalesced;
+    return true;
+}
+
+bool WriteBatch::Apply(const Write& write) {
+    const bool applied = _apply(write);
+    if (applied) {
+        ++_stats.applied;
+    }
+    return applied;
+}
+
+void WriteBatch::Flush() {
+    if (_writes.empty()) {
+        return;
+    }
+    for (const auto& write : _writes) {
+        if (write.op != Op::kNone) {
+            Apply(write);
+        }
+    }
+    ++_stats.flushes;
+    Clear();
+}
+
+void WriteBatch::Clear() noexcept {
+    _writes.clear();
+    _slots.clear();
+}
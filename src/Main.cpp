@@ -1,6 +1,11 @@
 #include <Core/LuaManager.h>
 #include "Core/SKSEManager.h"
 #include "Core/Papyrus.h"
+#include "Core/FormIndex.h"
+#include "Core/GameEvents.h"
+#include "Core/Hooks.h"
+#include "Core/LuaForms.h"
+#include "Core/SpatialIndex.h"
 
 #include <stddef.h>
 
@@ -85,7 +90,8 @@ namespace {
      */
     void InitializePapyrus() {
         log::trace("Initializing Papyrus binding...");
-        if (GetPapyrusInterface()->Register(Sample::RegisterHitCounter)) {
+        auto* papyrus = GetPapyrusInterface();
+        if (papyrus->Register(Sample::RegisterHitCounter) && papyrus->Register(Sample::RegisterLuaBridge)) {
             log::debug("Papyrus functions bound.");
         } else {
             stl::report_and_fail("Failure to register Papyrus bindings.");
@@ -115,6 +121,8 @@ namespace {
                     // Test by running a simple Lua string
                     luaManager->ExecuteString("Log('Hello from Lua!')");
                 }
+
+                luaManager->LogBytecodeCacheStats();
             } else {
                 log::error("Failed to initialize Lua environment");
             }
@@ -140,10 +148,10 @@ namespace {
     void InitializeHooking() {
         log::trace("Initializing trampoline...");
         auto& trampoline = GetTrampoline();
-        trampoline.create(64);
+        trampoline.create(Sample::GetHookTrampolineSize());
         log::trace("Trampoline initialized.");
 
-        Sample::InitializeHook(trampoline);
+        Sample::InitializeHooks(trampoline);
     }
 
     /**
@@ -178,15 +186,23 @@ namespace {
                 case MessagingInterface::kDataLoaded: // All ESM/ESL/ESP plugins have loaded, main menu is now active.
                     // It is now safe to access form data.
                     InitializeHooking();
+                    Sample::InitializeFormHandleEvents();
+                    Sample::FormIndex::GetSingleton()->Build();
+                    Sample::SpatialIndex::GetSingleton()->InitializeEvents();
+                    Sample::GameEvents::GetSingleton()->Initialize();
                     InitializeLua(); // Initialize Lua after game data is loaded
                     break;
 
                 // Skyrim game events.
                 case MessagingInterface::kNewGame: // Player starts a new game from main menu.
-                case MessagingInterface::kPreLoadGame: // Player selected a game to load, but it hasn't loaded yet.
-                    // Data will be the name of the loaded save.
                 case MessagingInterface::kPostLoadGame: // Player's selected save game has finished loading.
                     // Data will be a boolean indicating whether the load was successful.
+                    Sample::InvalidateFormHandles();
+                    Sample::SpatialIndex::GetSingleton()->Rebuild();
+                    Sample::LuaManager::GetSingleton()->DispatchEvent("OnGameLoad");
+                    break;
+                case MessagingInterface::kPreLoadGame: // Player selected a game to load, but it hasn't loaded yet.
+                    // Data will be the name of the loaded save.
                 case MessagingInterface::kSaveGame: // The player has saved a game.
                     // Data will be the save name.
                 case MessagingInterface::kDeleteGame: // The player deleted a saved game from within the load menu.
@@ -0,0 +1,85 @@
+#include "Core/ActorValues.h"
+
+#include "Check.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace Sample;
+
+namespace {
+    std::string WithCase(std::string_view name, bool upper) {
+        std::string result(name);
+        std::transform(result.begin(), result.end(), result.begin(), [upper](unsigned char c) {
+            return static_cast<char>(upper ? std::toupper(c) : std::tolower(c));
+        });
+        return result;
+    }
+
+    void TestTable() {
+        const auto names = GetActorValueNames();
+        CHECK(names.size() > 46);
+
+        // Every name resolves through the table in any casing
+        bool resolved = true;
+        for (const auto& entry : names) {
+            resolved = resolved && LookupActorValue(entry.name) == entry.value;
+            resolved = resolved && LookupActorValue(WithCase(entry.name, true)) == entry.value;
+            resolved = resolved && LookupActorValue(WithCase(entry.name, false)) == entry.value;
+        }
+        CHECK(resolved);
+
+        // Aliases land on the same value as the game's name
+        CHECK(LookupActorValue("Archery") == RE::ActorValue::kArchery);
+        CHECK(LookupActorValue("Marksman") == RE::ActorValue::kArchery);
+        CHECK(LookupActorValue("speech") == RE::ActorValue::kSpeech);
+        CHECK(LookupActorValue("RESISTFIRE") == RE::ActorValue::kResistFire);
+    }
+
+    void TestFallback() {
+        // Not in the table, so only the game's list knows them
+        CHECK(LookupActorValue("Paralysis") == RE::ActorValue::kParalysis);
+        CHECK(LookupActorValue("nighteye") == RE::ActorValue::kNightEye);
+
+        CHECK(LookupActorValue("") == RE::ActorValue::kNone);
+        CHECK(LookupActorValue("Healt") == RE::ActorValue::kNone);
+        CHECK(LookupActorValue("Health ") == RE::ActorValue::kNone);
+        CHECK(LookupActorValue("NotAnActorValue") == RE::ActorValue::kNone);
+    }
+
+    // Names as scripts pass them, against the game's scan over every actor value that resolved them before
+    void BenchmarkLookup() {
+        const std::vector<std::string> queries{"Health", "magicka", "Stamina", "OneHanded", "Archery",
+                                               "DamageResist", "SpeedMult", "CarryWeight", "Sneak", "Destruction"};
+        constexpr std::size_t Iterations = 1000000;
+        auto* list = RE::ActorValueList::GetSingleton();
+
+        std::size_t query = 0;
+        unsigned sum = 0;
+        const auto table = Test::MeasureNanos(Iterations, [&] {
+            sum += static_cast<unsigned>(LookupActorValue(queries[query++ % queries.size()]));
+        });
+        query = 0;
+        const auto scan = Test::MeasureNanos(Iterations, [&] {
+            sum += static_cast<unsigned>(list->LookupActorValueByName(queries[query++ % queries.size()]));
+        });
+        const auto miss = Test::MeasureNanos(Iterations / 10, [&] {
+            sum += static_cast<unsigned>(LookupActorValue("NotAnActorValue"));
+        });
+        CHECK(sum != 0);
+
+        std::printf("Actor value lookup: %.1f ns through the table, %.1f ns scanning %zu actor values, "
+                    "%.1f ns for an unknown name\n",
+                    table, scan, static_cast<std::size_t>(RE::ActorValue::kTotal), miss);
+    }
+}
+
+int main() {
+    TestTable();
+    TestFallback();
+    BenchmarkLookup();
+    return Test::Report("ActorValuesTest");
+}
@@ -0,0 +1,131 @@
+#include "Core/ByteBuffer.h"
+
+#include "Check.h"
+
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+using namespace Sample;
+
+namespace {
+    std::span<const std::byte> Bytes(const ByteWriter& writer) {
+        return {writer.Data(), writer.Size()};
+    }
+
+    void TestFixedSize() {
+        ByteWriter writer;
+        writer.Write<std::uint32_t>(0x12345678);
+        writer.Write<std::uint8_t>(7);
+        writer.Write(-1.5f);
+        const char text[] = "abc";
+        writer.WriteBytes(text, 3);
+        CHECK(writer.Size() == 4 + 1 + 4 + 3);
+        // Native order, which is little-endian on every platform the plugin runs on
+        CHECK(writer.Data()[0] == std::byte{0x78});
+
+        ByteReader reader(Bytes(writer));
+        std::uint32_t word = 0;
+        std::uint8_t small = 0;
+        float real = 0.0f;
+        std::span<const std::byte> bytes;
+        CHECK(reader.Read(word) && word == 0x12345678);
+        CHECK(reader.Read(small) && small == 7);
+        CHECK(reader.Read(real) && real == -1.5f);
+        CHECK(reader.ReadBytes(3, bytes) && bytes.size() == 3 && bytes.data() == writer.Data() + 9);
+        CHECK(reader.Remaining() == 0);
+
+        // Reads past the end fail and leave the value and the position alone
+        CHECK(!reader.Read(word));
+        CHECK(word == 0x12345678);
+        CHECK(!reader.ReadBytes(1, bytes));
+
+        ByteReader partial(Bytes(writer).first(3));
+        CHECK(!partial.Read(word));
+        CHECK(partial.Remaining() == 3);
+    }
+
+    void TestVarUInt() {
+        const std::pair<std::uint64_t, std::size_t> cases[] = {
+            {0, 1},
+            {1, 1},
+            {0x7F, 1},
+            {0x80, 2},
+            {0x3FFF, 2},
+            {0x4000, 3},
+            {0xFFFFFFFF, 5},
+            {std::numeric_limits<std::uint64_t>::max(), 10},
+        };
+        for (const auto& [value, size] : cases) {
+            ByteWriter writer;
+            writer.WriteVarUInt(value);
+            CHECK(writer.Size() == size);
+
+            ByteReader reader(Bytes(writer));
+            std::uint64_t decoded = 0;
+            CHECK(reader.ReadVarUInt(decoded) && decoded == value);
+            CHECK(reader.Remaining() == 0);
+
+            // Every proper prefix is truncated
+            for (std::size_t length = 0; length < size; ++length) {
+                ByteReader truncated(Bytes(writer).first(length));
+                CHECK(!truncated.ReadVarUInt(decoded));
+            }
+        }
+
+        // Eleven continuation bytes are more than any 64-bit value needs
+        const std::vector<std::byte> overlong(11, std::byte{0x80});
+        ByteReader reader(overlong);
+        std::uint64_t decoded = 0;
+        CHECK(!reader.ReadVarUInt(decoded));
+    }
+
+    void TestZigzag() {
+        const std::pair<std::int64_t, std::size_t> cases[] = {
+            {0, 1},
+            {-1, 1},
+            {1, 1},
+            {-64, 1},
+            {63, 1},
+            {64, 2},
+            {-65, 2},
+            {std::numeric_limits<std::int32_t>::max(), 5},
+            {std::numeric_limits<std::int32_t>::min(), 5},
+            {std::numeric_limits<std::int64_t>::max(), 10},
+            {std::numeric_limits<std::int64_t>::min(), 10},
+        };
+        ByteWriter writer;
+        for (const auto& [value, size] : cases) {
+            const auto before = writer.Size();
+            writer.WriteVarInt(value);
+            CHECK(writer.Size() - before == size);
+        }
+
+        ByteReader reader(Bytes(writer));
+        bool roundTrips = true;
+        for (const auto& [value, size] : cases) {
+            std::int64_t decoded = 0;
+            roundTrips = roundTrips && reader.ReadVarInt(decoded) && decoded == value;
+        }
+        CHECK(roundTrips);
+        CHECK(reader.Remaining() == 0);
+    }
+
+    void TestClearKeepsCapacity() {
+        ByteWriter writer;
+        writer.Reserve(64);
+        writer.WriteVarUInt(300);
+        writer.Clear();
+        CHECK(writer.Size() == 0);
+        writer.WriteVarUInt(5);
+        CHECK(writer.Size() == 1);
+    }
+}
+
+int main() {
+    TestFixedSize();
+    TestVarUInt();
+    TestZigzag();
+    TestClearKeepsCapacity();
+    return Test::Report("ByteBufferTest");
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+
+namespace Sample::Test {
+    inline int& Failures() noexcept {
+        static int failures = 0;
+        return failures;
+    }
+
+    inline void Fail(const char* expression, const char* file, int line) noexcept {
+        std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+        ++Failures();
+    }
+
+    /**
+     * Print the outcome of a test executable and turn it into its exit code.
+     */
+    inline int Report(const char* name) noexcept {
+        if (Failures() != 0) {
+            std::fprintf(stderr, "%s: %d check(s) failed\n", name, Failures());
+            return 1;
+        }
+        std::printf("%s: all checks passed\n", name);
+        return 0;
+    }
+
+    /**
+     * Run <code>body</code> the given number of times.
+     *
+     * @return The mean time of one run, in nanoseconds.
+     */
+    template <class F>
+    double MeasureNanos(std::size_t iterations, F&& body) {
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < iterations; ++i) {
+            body();
+        }
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() / static_cast<double>(iterations);
+    }
+}
+
+#define CHECK(expression) ((expression) ? void() : ::Sample::Test::Fail(#expression, __FILE__, __LINE__))
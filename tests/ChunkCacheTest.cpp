@@ -0,0 +1,165 @@
+#include "Core/ChunkCache.h"
+
+#include "Check.h"
+
+extern "C" {
+#include <lua.h>
+#include <lualib.h>
+#include <lauxlib.h>
+}
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace Sample;
+
+namespace {
+    // Run a snippet through the cache and return its integer result, or -1 if it failed
+    lua_Integer Run(lua_State* L, ChunkCache& cache, const std::string& source) {
+        if (!cache.Push(L, source, "=test")) {
+            lua_pop(L, 1);
+            return -1;
+        }
+        if (lua_pcall(L, 0, 1, 0) != LUA_OK) {
+            lua_pop(L, 1);
+            return -1;
+        }
+        const lua_Integer result = lua_tointeger(L, -1);
+        lua_pop(L, 1);
+        return result;
+    }
+
+    void TestHitsAndMisses() {
+        lua_State* L = luaL_newstate();
+        ChunkCache cache;
+
+        CHECK(Run(L, cache, "return 1 + 2") == 3);
+        CHECK(Run(L, cache, "return 1 + 2") == 3);
+        CHECK(Run(L, cache, "return 40 + 2") == 42);
+        CHECK(cache.GetStats().hits == 1);
+        CHECK(cache.GetStats().misses == 2);
+        CHECK(cache.Size() == 2);
+
+        // A cached chunk still sees the current globals
+        CHECK(Run(L, cache, "counter = (counter or 0) + 1 return counter") == 1);
+        CHECK(Run(L, cache, "counter = (counter or 0) + 1 return counter") == 2);
+
+        // Errors are reported, not cached
+        const int top = lua_gettop(L);
+        CHECK(!cache.Push(L, "return +", "=test"));
+        CHECK(lua_gettop(L) == top + 1 && lua_isstring(L, -1));
+        lua_pop(L, 1);
+        CHECK(cache.Size() == 3);
+
+        lua_close(L);
+    }
+
+    // The same source run under two chunk names keeps both, so each error names the chunk it came from
+    void TestChunkNames() {
+        lua_State* L = luaL_newstate();
+        luaL_openlibs(L);
+        ChunkCache cache;
+        const auto error = [&](const char* chunkName) {
+            CHECK(cache.Push(L, "error('boom')", chunkName));
+            CHECK(lua_pcall(L, 0, 0, 0) != LUA_OK);
+            std::string message = lua_tostring(L, -1);
+            lua_pop(L, 1);
+            return message;
+        };
+
+        CHECK(error("=quest") == "quest:1: boom");
+        CHECK(error("=combat") == "combat:1: boom");
+        CHECK(error("=quest") == "quest:1: boom");
+        CHECK(cache.Size() == 2);
+        CHECK(cache.GetStats().hits == 1 && cache.GetStats().misses == 2);
+        lua_close(L);
+    }
+
+    void TestEviction() {
+        lua_State* L = luaL_newstate();
+        ChunkCache cache;
+        cache.SetCapacity(L, 2);
+
+        Run(L, cache, "return 1");
+        Run(L, cache, "return 2");
+        Run(L, cache, "return 1");  // Now the most recently used
+        Run(L, cache, "return 3");  // Evicts "return 2"
+        CHECK(cache.Size() == 2);
+        CHECK(cache.GetStats().evictions == 1);
+
+        const auto misses = cache.GetStats().misses;
+        CHECK(Run(L, cache, "return 1") == 1);
+        CHECK(cache.GetStats().misses == misses);
+        CHECK(Run(L, cache, "return 2") == 2);
+        CHECK(cache.GetStats().misses == misses + 1);
+
+        // Shrinking drops the oldest entries and their registry references
+        cache.SetCapacity(L, 1);
+        CHECK(cache.Size() == 1);
+        CHECK(Run(L, cache, "return 2") == 2);
+        CHECK(cache.GetStats().misses == misses + 1);
+
+        // Zero capacity still runs every snippet, it just keeps none
+        cache.SetCapacity(L, 0);
+        CHECK(Run(L, cache, "return 5") == 5);
+        CHECK(Run(L, cache, "return 5") == 5);
+        CHECK(cache.Size() == 0);
+
+        lua_close(L);
+    }
+
+    // Replays a trace of ExecuteString calls: a few dozen distinct snippets, the hot ones called far more often than
+    // the rest, against compiling every call as ExecuteString did before the cache
+    void BenchmarkReplay() {
+        constexpr std::size_t Snippets = 48;
+        constexpr std::size_t Calls = 200000;
+
+        std::vector<std::string> snippets;
+        for (std::size_t i = 0; i < Snippets; ++i) {
+            snippets.push_back("local hits = " + std::to_string(i) +
+                               "\nlocal total = 0\nfor i = 1, 4 do total = total + hits * i end\n"
+                               "if total > 100 then return total - 100 end\nreturn total\n");
+        }
+        std::mt19937 random(2);
+        std::geometric_distribution<std::size_t> pick(0.15);
+        std::vector<std::size_t> trace(Calls);
+        for (auto& index : trace) {
+            index = std::min(pick(random), Snippets - 1);
+        }
+
+        const auto replay = [&](std::size_t capacity) {
+            lua_State* L = luaL_newstate();
+            ChunkCache cache;
+            cache.SetCapacity(L, capacity);
+            lua_Integer checksum = 0;
+            std::size_t call = 0;
+            const auto nanos = Test::MeasureNanos(Calls, [&] { checksum += Run(L, cache, snippets[trace[call++]]); });
+            const auto hits = cache.GetStats().hits;
+            lua_close(L);
+            return std::tuple{nanos, checksum, hits};
+        };
+
+        const auto [compiled, compiledSum, compiledHits] = replay(0);
+        const auto [cached, cachedSum, cachedHits] = replay(64);
+        const auto [small, smallSum, smallHits] = replay(8);
+        CHECK(compiledSum == cachedSum && cachedSum == smallSum);
+        CHECK(compiledHits == 0 && cachedHits == Calls - Snippets);
+
+        std::printf("%zu calls over %zu snippets: %.0f calls/s compiling each, %.0f calls/s cached (%.1fx), "
+                    "%.0f calls/s with 8 slots (%.1f%% hits)\n",
+                    Calls, Snippets, 1e9 / compiled, 1e9 / cached, compiled / cached, 1e9 / small,
+                    100.0 * static_cast<double>(smallHits) / Calls);
+    }
+}
+
+int main() {
+    TestHitsAndMisses();
+    TestChunkNames();
+    TestEviction();
+    BenchmarkReplay();
+    return Test::Report("ChunkCacheTest");
+}
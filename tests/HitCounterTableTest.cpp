@@ -0,0 +1,364 @@
+#include "Core/HitCounterTable.h"
+
+#include "Check.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <optional>
+#include <thread>
+#include <vector>
+
+using namespace Sample;
+
+namespace {
+    // The table only hashes and compares actor pointers, so distinct addresses stand in for actors
+    struct alignas(16) FakeActor {
+        char bytes[16];
+    };
+
+    class Actors {
+    public:
+        explicit Actors(std::size_t count) : _storage(count) {
+            _actors.reserve(count);
+            for (auto& actor : _storage) {
+                _actors.push_back(reinterpret_cast<RE::Actor*>(&actor));
+            }
+        }
+
+        RE::Actor* operator[](std::size_t index) const noexcept { return _actors[index]; }
+        [[nodiscard]] std::span<RE::Actor* const> All() const noexcept { return _actors; }
+        [[nodiscard]] std::span<RE::Actor* const> Range(std::size_t first, std::size_t count) const noexcept {
+            return std::span{_actors}.subspan(first, count);
+        }
+
+    private:
+        std::vector<FakeActor> _storage;
+        std::vector<RE::Actor*> _actors;
+    };
+
+    void TestCounting() {
+        HitCounterTable table;
+        const Actors actors(4);
+
+        // Hits on untracked actors are ignored, and an actor has no count until it is hit while tracked
+        table.Increment(actors[0], 1);
+        CHECK(!table.GetCount(actors[0]));
+        CHECK(table.Track(actors[0]));
+        CHECK(!table.Track(actors[0]));
+        CHECK(!table.GetCount(actors[0]));
+        table.Increment(actors[0], 3);
+        table.Increment(actors[0], 2);
+        CHECK(table.GetCount(actors[0]) == 5);
+        CHECK(table.GetHitsInLast(actors[0], 60) == 5);
+        CHECK(table.GetTimeSinceLastHit(actors[0]).has_value());
+        CHECK(!table.GetTimeSinceLastHit(actors[1]));
+
+        // Untracking keeps the count but stops counting
+        CHECK(table.Untrack(actors[0]));
+        CHECK(!table.Untrack(actors[0]));
+        table.Increment(actors[0], 1);
+        CHECK(table.GetCount(actors[0]) == 5);
+        CHECK(!table.IsTracked(actors[0]));
+
+        table.SetCount(actors[1], 9);
+        CHECK(table.GetCount(actors[1]) == 9);
+        CHECK(!table.IsTracked(actors[1]));
+
+        table.Clear();
+        CHECK(!table.GetCount(actors[0]));
+        CHECK(table.GetTotals().tracked == 0);
+        CHECK(table.GetTotals().hits == 0);
+    }
+
+    // The totals cover tracked actors only; tracking or untracking an actor moves its count in or out
+    void TestTotals() {
+        HitCounterTable table;
+        const Actors actors(3);
+        table.Track(actors.Range(0, 2));
+        table.Increment(actors[0], 4);
+        table.Increment(actors[1], 6);
+        CHECK(table.GetTotals().tracked == 2);
+        CHECK(table.GetTotals().hits == 10);
+
+        table.Untrack(actors[1]);
+        CHECK(table.GetTotals().tracked == 1);
+        CHECK(table.GetTotals().hits == 4);
+
+        // Loading a count for an untracked actor leaves the total alone until it is tracked
+        table.SetCount(actors[2], 20);
+        CHECK(table.GetTotals().hits == 4);
+        table.Track(actors[2]);
+        table.Track(actors[1]);
+        CHECK(table.GetTotals().tracked == 3);
+        CHECK(table.GetTotals().hits == 30);
+
+        table.SetCount(actors[0], 1);
+        CHECK(table.GetTotals().hits == 27);
+        table.ResetCounts(actors.All());
+        CHECK(table.GetTotals().hits == 0);
+    }
+
+    void TestTop() {
+        HitCounterTable table;
+        const Actors actors(100);
+        table.Track(actors.All());
+        for (std::size_t i = 0; i < 100; ++i) {
+            table.Increment(actors[i], static_cast<std::int32_t>((i * 37) % 100 + 1));
+        }
+        // An untracked actor is not ranked, whatever its count
+        table.Untrack(actors[63]);  // (63 * 37) % 100 + 1 == 32
+        table.SetCount(actors[63], 1000);
+
+        std::vector<std::pair<RE::Actor*, std::int32_t>> top;
+        table.GetTop(5, top);
+        CHECK(top.size() == 5);
+        for (std::size_t i = 0; i < top.size(); ++i) {
+            CHECK(top[i].second == static_cast<std::int32_t>(100 - i));
+        }
+
+        // Counts crossing a power of two move the actor to another bucket
+        table.Increment(actors[0], 500);
+        top.clear();
+        table.GetTop(1, top);
+        CHECK(top.size() == 1 && top[0].first == actors[0] && top[0].second == 501);
+
+        table.ResetCounts(actors.Range(0, 1));
+        top.clear();
+        table.GetTop(200, top);
+        CHECK(top.size() == 99);
+        CHECK(std::is_sorted(top.begin(), top.end(), [](const auto& l, const auto& r) { return l.second > r.second; }));
+        CHECK(top.back().first == actors[0] && top.back().second == 0);
+    }
+
+    constexpr std::uint64_t Second = 1000000;
+
+    void TestWindow() {
+        HitCounterTable::Window window;
+        window.Reset();
+        const std::uint64_t start = 1000 * Second;
+        window.Record(start, 2);
+        window.Record(start + 1 * Second, 3);
+        window.Record(start + 5 * Second, 4);
+        CHECK(window.Sum(start + 5 * Second, 1) == 4);
+        CHECK(window.Sum(start + 5 * Second, 5) == 7);
+        CHECK(window.Sum(start + 5 * Second, 60) == 9);
+        CHECK(window.Sum(start + 62 * Second, 60) == 4);
+
+        // A gap of a minute or more clears the window
+        window.Record(start + 70 * Second, 1);
+        CHECK(window.Sum(start + 70 * Second, 60) == 1);
+        CHECK(window.lastHitMicros == start + 70 * Second);
+    }
+
+    // A hit timestamped before another thread's later hit, but recorded after it, lands in its own second and keeps
+    // the history
+    void TestWindowOutOfOrder() {
+        HitCounterTable::Window window;
+        window.Reset();
+        const std::uint64_t start = 1000 * Second;
+        window.Record(start, 5);
+        window.Record(start + 10 * Second, 1);
+        window.Record(start + 9 * Second + 500000, 2);
+        CHECK(window.second == 1010);
+        CHECK(window.lastHitMicros == start + 10 * Second);
+        CHECK(window.Sum(start + 10 * Second, 1) == 1);
+        CHECK(window.Sum(start + 10 * Second, 2) == 3);
+        CHECK(window.Sum(start + 10 * Second, 60) == 8);
+
+        // Older than the window: dropped, and nothing else is touched
+        window.Record(start - 60 * Second, 7);
+        CHECK(window.Sum(start + 10 * Second, 60) == 8);
+
+        // Two threads racing across a second boundary, in either order
+        HitCounterTable::Window raced;
+        raced.Reset();
+        raced.Record(start, 1);
+        raced.Record(start + Second, 1);
+        raced.Record(start + Second - 1, 1);
+        CHECK(raced.Sum(start + Second, 60) == 3);
+        CHECK(raced.Sum(start + Second, 1) == 1);
+    }
+
+    // Hit threads increment a set of tracked actors while another thread tracks thousands more, growing the table
+    // under them, and a reader ranks, sums windows and reads counts. No increment may be lost to a grow.
+    void TestStress() {
+        constexpr std::size_t Hot = 64;
+        constexpr std::size_t Added = 20000;
+        constexpr std::size_t HitThreads = 4;
+        constexpr std::size_t HitsPerThread = 200000;
+
+        HitCounterTable table;
+        const Actors actors(Hot + Added);
+        table.Track(actors.Range(0, Hot));
+
+        std::atomic<bool> start{false};
+        std::atomic<std::size_t> running{HitThreads + 1};
+        std::vector<std::thread> threads;
+        for (std::size_t thread = 0; thread < HitThreads; ++thread) {
+            threads.emplace_back([&, thread] {
+                while (!start.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                }
+                for (std::size_t i = 0; i < HitsPerThread; ++i) {
+                    table.Increment(actors[(i + thread) % Hot], 1);
+                }
+                running.fetch_sub(1, std::memory_order_release);
+            });
+        }
+        threads.emplace_back([&] {
+            while (!start.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            for (std::size_t i = 0; i < Added; ++i) {
+                table.Track(actors[Hot + i]);
+            }
+            running.fetch_sub(1, std::memory_order_release);
+        });
+
+        std::size_t reads = 0;
+        bool ranked = true;
+        std::vector<std::pair<RE::Actor*, std::int32_t>> top;
+        start.store(true, std::memory_order_release);
+        while (running.load(std::memory_order_acquire) != 0) {
+            top.clear();
+            table.GetTop(8, top);
+            ranked = ranked && top.size() <= 8 &&
+                     std::is_sorted(top.begin(), top.end(), [](const auto& l, const auto& r) { return l.second > r.second; });
+            const auto* actor = actors[reads % Hot];
+            const auto count = table.GetCount(actor).value_or(0);
+            ranked = ranked && count >= 0 && table.GetHitsInLast(actor, 60) <= HitThreads * HitsPerThread;
+            ++reads;
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        constexpr auto PerActor = static_cast<std::int32_t>(HitThreads * HitsPerThread / Hot);
+        bool exact = true;
+        bool windowed = true;
+        for (std::size_t i = 0; i < Hot; ++i) {
+            exact = exact && table.GetCount(actors[i]) == PerActor;
+            // Well under the 65535 a bucket holds, so the last minute holds every hit
+            windowed = windowed && table.GetHitsInLast(actors[i], 60) == static_cast<std::uint32_t>(PerActor);
+        }
+        CHECK(ranked);
+        CHECK(exact);
+        CHECK(windowed);
+        CHECK(table.GetTotals().tracked == Hot + Added);
+        CHECK(table.GetTotals().hits == static_cast<std::int64_t>(HitThreads * HitsPerThread));
+        CHECK(std::all_of(actors.All().begin(), actors.All().end(), [&](auto* actor) { return table.IsTracked(actor); }));
+        std::printf("%zu threads x %zu hits while tracking %zu actors: %zu concurrent reads\n", HitThreads,
+                    HitsPerThread, Added, reads);
+    }
+
+    void BenchmarkHitPath() {
+        constexpr std::size_t Iterations = 10000000;
+        HitCounterTable table;
+        const Actors actors(1024);
+        table.Track(actors.Range(0, 8));
+
+        // Most actors hit in the game are not tracked; the filter turns them away
+        std::size_t next = 0;
+        const auto untracked = Test::MeasureNanos(Iterations, [&] {
+            table.Increment(actors[8 + next++ % 1016], 1);
+        });
+        const auto tracked = Test::MeasureNanos(Iterations, [&] { table.Increment(actors[next++ % 8], 1); });
+        std::printf("Increment: %.1f ns for an untracked actor, %.1f ns for a tracked one\n", untracked, tracked);
+    }
+
+    // What the HitCounter natives do for a squad, minus Papyrus marshaling: one table call per actor for
+    // StartCounting, GetCount and a one-actor reset, against StartCountingAll, GetCounts and ResetCounts
+    void BenchmarkBatchNatives() {
+        constexpr std::size_t Squad = 64;
+        constexpr std::size_t Rounds = 20000;
+        const Actors actors(Squad);
+        std::vector<std::optional<std::int32_t>> counts(Squad);
+
+        std::chrono::duration<double, std::nano> scalar{0};
+        std::chrono::duration<double, std::nano> batch{0};
+        for (std::size_t round = 0; round < Rounds; ++round) {
+            HitCounterTable scalarTable;
+            auto begin = std::chrono::steady_clock::now();
+            for (std::size_t i = 0; i < Squad; ++i) {
+                scalarTable.Track(actors[i]);
+            }
+            for (std::size_t i = 0; i < Squad; ++i) {
+                counts[i] = scalarTable.GetCount(actors[i]);
+            }
+            for (std::size_t i = 0; i < Squad; ++i) {
+                scalarTable.ResetCounts(actors.Range(i, 1));
+            }
+            scalar += std::chrono::steady_clock::now() - begin;
+
+            HitCounterTable batchTable;
+            begin = std::chrono::steady_clock::now();
+            batchTable.Track(actors.All());
+            for (std::size_t i = 0; i < Squad; ++i) {
+                counts[i] = batchTable.GetCount(actors[i]);
+            }
+            batchTable.ResetCounts(actors.All());
+            batch += std::chrono::steady_clock::now() - begin;
+            CHECK(batchTable.GetTotals().tracked == Squad);
+        }
+        const auto calls = static_cast<double>(Rounds * Squad);
+        std::printf("Track, read and reset a %zu-actor squad: %.1f ns per actor one by one, %.1f ns batched\n", Squad,
+                    scalar.count() / calls, batch.count() / calls);
+    }
+
+    // Hook-rate increments on several threads while one thread keeps reading counts and rankings
+    void BenchmarkContended() {
+        constexpr std::size_t HitsPerThread = 2000000;
+        for (const std::size_t hitThreads : {1, 2, 4}) {
+            HitCounterTable table;
+            const Actors actors(256);
+            table.Track(actors.Range(0, 32));
+
+            std::atomic<bool> done{false};
+            std::size_t reads = 0;
+            std::thread reader([&] {
+                std::vector<std::pair<RE::Actor*, std::int32_t>> top;
+                while (!done.load(std::memory_order_acquire)) {
+                    (void)table.GetCount(actors[reads % 32]);
+                    top.clear();
+                    table.GetTop(4, top);
+                    ++reads;
+                }
+            });
+
+            const auto begin = std::chrono::steady_clock::now();
+            std::vector<std::thread> threads;
+            for (std::size_t thread = 0; thread < hitThreads; ++thread) {
+                threads.emplace_back([&, thread] {
+                    for (std::size_t i = 0; i < HitsPerThread; ++i) {
+                        table.Increment(actors[(i * 7 + thread) % 64], 1);  // Half tracked, half not
+                    }
+                });
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+            done.store(true, std::memory_order_release);
+            reader.join();
+
+            CHECK(table.GetTotals().hits == static_cast<std::int64_t>(hitThreads * HitsPerThread / 2));
+            std::printf("%zu hit thread(s) against a reader: %.1f M hits/s, %zu reads\n", hitThreads,
+                        static_cast<double>(hitThreads * HitsPerThread) / elapsed.count() / 1e6, reads);
+        }
+    }
+}
+
+int main() {
+    TestCounting();
+    TestTotals();
+    TestTop();
+    TestWindow();
+    TestWindowOutOfOrder();
+    TestStress();
+    BenchmarkHitPath();
+    BenchmarkContended();
+    BenchmarkBatchNatives();
+    return Test::Report("HitCounterTableTest");
+}
@@ -0,0 +1,110 @@
+#include "Core/HitEventQueue.h"
+
+#include "Check.h"
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace Sample;
+
+namespace {
+    constexpr std::uint32_t Threads = 4;
+
+    // The hook can fire on several threads at once: every hit pushed must reach exactly one batch, and the frames of
+    // each thread's hits must never go backwards
+    void TestConcurrentHooks() {
+        constexpr std::uint32_t PerThread = 50000;
+        auto* queue = HitEventQueue::GetSingleton();
+        const auto before = queue->GetStats();
+
+        std::vector<RE::Actor> targets;
+        for (std::uint32_t i = 0; i < Threads; ++i) {
+            targets.emplace_back(0xFF000800 + i);
+        }
+
+        std::atomic<bool> start{false};
+        std::vector<std::thread> threads;
+        for (std::uint32_t t = 0; t < Threads; ++t) {
+            threads.emplace_back([&, t] {
+                while (!start.load()) {
+                }
+                for (std::uint32_t i = 0; i < PerThread;) {
+                    if (queue->Push(&targets[t])) {
+                        ++i;
+                    } else {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+
+        std::vector<std::uint32_t> seen(Threads);
+        std::vector<std::uint32_t> lastFrame(Threads);
+        bool inOrder = true;
+        std::uint64_t dropped = 0;
+        start = true;
+        for (std::uint32_t total = 0; total < Threads * PerThread;) {
+            const auto batch = queue->Peek();
+            for (std::uint32_t i = 0; i < batch.count; ++i) {
+                const auto thread = batch[i].target - 0xFF000800;
+                if (thread >= Threads || batch[i].frame < lastFrame[thread]) {
+                    inOrder = false;
+                    continue;
+                }
+                ++seen[thread];
+                lastFrame[thread] = batch[i].frame;
+            }
+            total += batch.count;
+            dropped += batch.dropped;
+            queue->Release(batch);
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        CHECK(inOrder);
+        for (std::uint32_t t = 0; t < Threads; ++t) {
+            CHECK(seen[t] == PerThread);
+        }
+        const auto stats = queue->GetStats();
+        CHECK(stats.pushed - before.pushed == Threads * PerThread);
+        CHECK(stats.dropped - before.dropped == dropped);
+        CHECK(stats.highWater <= HitEventQueue::Capacity);
+        CHECK(queue->Peek().count == 0);
+    }
+
+    void TestOverflow() {
+        auto* queue = HitEventQueue::GetSingleton();
+        RE::Actor target(0x00000014);
+        CHECK(!queue->Push(nullptr));
+        for (std::size_t i = 0; i < HitEventQueue::Capacity; ++i) {
+            CHECK(queue->Push(&target));
+        }
+        CHECK(!queue->Push(&target));
+        CHECK(!queue->Push(&target));
+
+        const auto batch = queue->Peek();
+        CHECK(batch.count == HitEventQueue::Capacity);
+        CHECK(batch.dropped == 2);
+        CHECK(batch[0].target == 0x14 && batch[batch.count - 1].target == 0x14);
+        const auto frame = batch[0].frame;
+        CHECK(batch[batch.count - 1].frame == frame);
+        queue->Release(batch);
+
+        // The frame advances with every release, and overflow is reported once
+        CHECK(queue->Push(&target));
+        const auto next = queue->Peek();
+        CHECK(next.count == 1 && next.dropped == 0);
+        CHECK(next[0].frame == frame + 1);
+        queue->Release(next);
+        CHECK(queue->GetStats().highWater == HitEventQueue::Capacity);
+    }
+}
+
+int main() {
+    TestConcurrentHooks();
+    TestOverflow();
+    return Test::Report("HitEventQueueTest");
+}
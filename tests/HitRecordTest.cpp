@@ -0,0 +1,195 @@
+#include "Core/HitRecord.h"
+
+#include "Check.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace Sample;
+
+namespace {
+    bool Same(const SavedActor& left, const SavedActor& right) {
+        return left.formID == right.formID && left.tracked == right.tracked && left.count == right.count;
+    }
+
+    std::vector<SavedActor> RoundTrip(std::vector<SavedActor> actors, bool* parsed = nullptr) {
+        ByteWriter writer;
+        WriteHitsRecord(actors, writer);
+        ByteReader reader({writer.Data(), writer.Size()});
+        std::vector<SavedActor> loaded;
+        const bool ok = ParseHitsRecord(reader, loaded);
+        if (parsed) {
+            *parsed = ok && reader.Remaining() == 0;
+        }
+        return loaded;
+    }
+
+    void TestRoundTrip() {
+        const std::vector<SavedActor> actors{
+            {0xFF000800, true, std::nullopt},
+            {0x00000014, true, 12},
+            {0x0001A2B3, false, -3},
+            {0x0001A2B4, true, std::numeric_limits<std::int32_t>::max()},
+            {0x0001A2B5, false, std::numeric_limits<std::int32_t>::min()},
+            {0xFFFFFFFF, true, 0},
+        };
+        bool parsed = false;
+        const auto loaded = RoundTrip(actors, &parsed);
+        CHECK(parsed);
+        CHECK(loaded.size() == actors.size());
+
+        // Loaded in FormID order
+        auto sorted = actors;
+        std::sort(sorted.begin(), sorted.end(), [](const auto& l, const auto& r) { return l.formID < r.formID; });
+        CHECK(std::equal(loaded.begin(), loaded.end(), sorted.begin(), sorted.end(), Same));
+
+        const auto empty = RoundTrip({}, &parsed);
+        CHECK(parsed && empty.empty());
+    }
+
+    void TestCorruptRecords() {
+        std::vector<SavedActor> actors{{0x14, true, 5}, {0x15, true, 6}, {0x16, false, 7}};
+        ByteWriter writer;
+        WriteHitsRecord(actors, writer);
+
+        // A truncated record keeps the entries before the cut
+        ByteReader truncated({writer.Data(), writer.Size() - 1});
+        std::vector<SavedActor> loaded;
+        CHECK(!ParseHitsRecord(truncated, loaded));
+        CHECK(loaded.size() == 2);
+
+        // A count that does not fit in 32 bits is rejected, not wrapped
+        ByteWriter outOfRange;
+        outOfRange.WriteVarUInt(2);
+        outOfRange.WriteVarUInt(0x14);
+        outOfRange.Write<std::uint8_t>(3);
+        outOfRange.WriteVarInt(7);
+        outOfRange.WriteVarUInt(1);
+        outOfRange.Write<std::uint8_t>(3);
+        outOfRange.WriteVarInt(std::int64_t{1} << 32);
+        ByteReader reader({outOfRange.Data(), outOfRange.Size()});
+        loaded.clear();
+        CHECK(!ParseHitsRecord(reader, loaded));
+        CHECK(loaded.size() == 1 && loaded[0].count == 7);
+
+        ByteWriter negative;
+        negative.WriteVarUInt(1);
+        negative.WriteVarUInt(0x14);
+        negative.Write<std::uint8_t>(2);
+        negative.WriteVarInt(std::int64_t{std::numeric_limits<std::int32_t>::min()} - 1);
+        ByteReader negativeReader({negative.Data(), negative.Size()});
+        loaded.clear();
+        CHECK(!ParseHitsRecord(negativeReader, loaded));
+
+        // So is a FormID that runs past 32 bits
+        ByteWriter farID;
+        farID.WriteVarUInt(2);
+        farID.WriteVarUInt(0xFFFFFFFF);
+        farID.Write<std::uint8_t>(1);
+        farID.WriteVarUInt(1);
+        farID.Write<std::uint8_t>(1);
+        ByteReader farReader({farID.Data(), farID.Size()});
+        loaded.clear();
+        CHECK(!ParseHitsRecord(farReader, loaded));
+        CHECK(loaded.size() == 1);
+
+        // A huge claimed count reserves no more than the bytes left could hold
+        ByteWriter huge;
+        huge.WriteVarUInt(std::numeric_limits<std::uint64_t>::max());
+        ByteReader hugeReader({huge.Data(), huge.Size()});
+        loaded.clear();
+        CHECK(!ParseHitsRecord(hugeReader, loaded));
+        CHECK(loaded.empty());
+    }
+
+    // The records of older versions: a size_t count, then raw fields
+    void TestLegacyRecords() {
+        ByteWriter counts;
+        counts.Write<std::uint64_t>(2);
+        counts.Write<std::uint32_t>(0x14);
+        counts.Write<std::int32_t>(9);
+        counts.Write<std::uint32_t>(0xFF000800);
+        counts.Write<std::int32_t>(-2);
+        ByteReader countsReader({counts.Data(), counts.Size()});
+        std::vector<SavedActor> loaded;
+        CHECK(ParseLegacyHitCounts(countsReader, loaded));
+        CHECK(loaded.size() == 2);
+        CHECK(Same(loaded[0], {0x14, false, 9}));
+        CHECK(Same(loaded[1], {0xFF000800, false, -2}));
+
+        ByteWriter tracked;
+        tracked.Write<std::uint64_t>(3);
+        tracked.Write<std::uint32_t>(0x14);
+        tracked.Write<std::uint32_t>(0x15);
+        tracked.Write<std::uint32_t>(0x16);
+        ByteReader trackedReader({tracked.Data(), tracked.Size()});
+        loaded.clear();
+        CHECK(ParseLegacyTrackedActors(trackedReader, loaded));
+        CHECK(loaded.size() == 3);
+        CHECK(Same(loaded[2], {0x16, true, std::nullopt}));
+
+        // Claims more entries than it holds
+        ByteReader shortReader({tracked.Data(), tracked.Size() - 2});
+        loaded.clear();
+        CHECK(!ParseLegacyTrackedActors(shortReader, loaded));
+        CHECK(loaded.size() == 2);
+    }
+
+    // 100k actors spread over a few plugins, as a save with a busy tracking script might hold
+    void BenchmarkRoundTrip() {
+        constexpr std::size_t Actors = 100000;
+        std::mt19937 random(18);
+        std::vector<SavedActor> actors;
+        actors.reserve(Actors);
+        std::uint32_t formID = 0x00010000;
+        for (std::size_t i = 0; i < Actors; ++i) {
+            if (i % 20000 == 0) {
+                formID = static_cast<std::uint32_t>(i / 20000 + 1) << 24;
+            }
+            formID += 1 + random() % 64;
+            const bool hit = random() % 4 != 0;
+            actors.push_back({formID, random() % 2 == 0, hit ? std::optional{static_cast<std::int32_t>(random() % 500)}
+                                                             : std::nullopt});
+        }
+        std::shuffle(actors.begin(), actors.end(), random);
+
+        ByteWriter writer;
+        std::vector<SavedActor> loaded;
+        bool parsed = true;
+        const auto write = Test::MeasureNanos(20, [&] {
+            auto copy = actors;
+            writer.Clear();
+            WriteHitsRecord(copy, writer);
+        });
+        const auto read = Test::MeasureNanos(20, [&] {
+            loaded.clear();
+            ByteReader reader({writer.Data(), writer.Size()});
+            parsed = ParseHitsRecord(reader, loaded) && parsed;
+        });
+
+        std::sort(actors.begin(), actors.end(), [](const auto& l, const auto& r) { return l.formID < r.formID; });
+        CHECK(parsed);
+        CHECK(std::equal(loaded.begin(), loaded.end(), actors.begin(), actors.end(), Same));
+
+        // What the old HITC and TACT records took for the same actors
+        std::size_t legacyBytes = 2 * sizeof(std::uint64_t);
+        for (const auto& actor : actors) {
+            legacyBytes += actor.tracked ? sizeof(std::uint32_t) : 0;
+            legacyBytes += actor.count ? sizeof(std::uint32_t) + sizeof(std::int32_t) : 0;
+        }
+        std::printf("%zu actors: HITS record of %zu bytes (legacy records %zu bytes), encoded in %.2f ms, decoded in "
+                    "%.2f ms\n",
+                    Actors, writer.Size(), legacyBytes, write / 1e6, read / 1e6);
+    }
+}
+
+int main() {
+    TestRoundTrip();
+    TestCorruptRecords();
+    TestLegacyRecords();
+    BenchmarkRoundTrip();
+    return Test::Report("HitRecordTest");
+}
@@ -0,0 +1,198 @@
+#include "Core/LuaBatch.h"
+
+#include "Check.h"
+
+#include <RE/Skyrim.h>
+
+extern "C" {
+#include <lua.h>
+#include <lualib.h>
+#include <lauxlib.h>
+}
+
+#include <cstdio>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+using namespace Sample;
+
+namespace {
+    // Stands in for the engine: every actor's health, by FormID
+    std::unordered_map<RE::FormID, float> Health;
+
+    // Bindings shaped like the scalar and batch ones in LuaManager, over FormIDs instead of form handles
+
+    RE::Actor* ToActor(lua_State* L, int index) {
+        int isInteger = 0;
+        const auto formID = lua_tointegerx(L, index, &isInteger);
+        return isInteger ? RE::TESForm::LookupByID<RE::Actor>(static_cast<RE::FormID>(formID)) : nullptr;
+    }
+
+    int GetHealth(lua_State* L) {
+        auto* actor = ToActor(L, 1);
+        lua_pushnumber(L, actor ? Health[actor->GetFormID()] : 0.0f);
+        return 1;
+    }
+
+    int GetDistance(lua_State* L) {
+        auto* actor = ToActor(L, 1);
+        auto* other = ToActor(L, 2);
+        lua_pushnumber(L, actor && other ? actor->GetPosition().GetDistance(other->GetPosition()) : -1.0f);
+        return 1;
+    }
+
+    std::vector<RE::Actor*> Scratch;
+
+    int GetHealths(lua_State* L) {
+        const auto count = ReadBatchArray(L, 1, Scratch, ToActor);
+        PushBatchResults(L, count, [&](std::size_t i) {
+            if (!Scratch[i]) {
+                return false;
+            }
+            lua_pushnumber(L, Health[Scratch[i]->GetFormID()]);
+            return true;
+        });
+        return 1;
+    }
+
+    int GetDistances(lua_State* L) {
+        auto* origin = ToActor(L, 1);
+        const auto count = ReadBatchArray(L, 2, Scratch, ToActor);
+        const auto originPosition = origin ? origin->GetPosition() : RE::NiPoint3{};
+        PushBatchResults(L, count, [&](std::size_t i) {
+            if (!origin || !Scratch[i]) {
+                return false;
+            }
+            lua_pushnumber(L, originPosition.GetDistance(Scratch[i]->GetPosition()));
+            return true;
+        });
+        return 1;
+    }
+
+    struct World {
+        std::vector<std::unique_ptr<RE::Actor>> actors;
+
+        explicit World(std::uint32_t count) {
+            RE::TESForm::AllForms().clear();
+            Health.clear();
+            for (std::uint32_t i = 0; i < count; ++i) {
+                auto& actor = actors.emplace_back(std::make_unique<RE::Actor>(0xFF000800 + i));
+                actor->position = {static_cast<float>(i) * 100.0f, static_cast<float>(i % 7) * 50.0f, 0.0f};
+                RE::TESForm::AllForms()[actor->GetFormID()] = actor.get();
+                Health[actor->GetFormID()] = 100.0f - static_cast<float>(i % 50);
+            }
+        }
+
+        ~World() {
+            RE::TESForm::AllForms().clear();
+            Health.clear();
+        }
+    };
+
+    lua_State* NewState() {
+        lua_State* L = luaL_newstate();
+        luaL_openlibs(L);
+        lua_register(L, "GetHealth", GetHealth);
+        lua_register(L, "GetDistance", GetDistance);
+        lua_register(L, "GetHealths", GetHealths);
+        lua_register(L, "GetDistances", GetDistances);
+        return L;
+    }
+
+    bool Run(lua_State* L, const char* script) {
+        if (luaL_dostring(L, script) != LUA_OK) {
+            std::fprintf(stderr, "%s\n", lua_tostring(L, -1));
+            lua_pop(L, 1);
+            return false;
+        }
+        return true;
+    }
+
+    // The array { first, first + 1, ... } of count FormIDs as the global Actors
+    void SetActors(lua_State* L, RE::FormID first, std::size_t count) {
+        lua_createtable(L, static_cast<int>(count), 0);
+        for (std::size_t i = 0; i < count; ++i) {
+            lua_pushinteger(L, first + i);
+            lua_rawseti(L, -2, static_cast<lua_Integer>(i + 1));
+        }
+        lua_setglobal(L, "Actors");
+    }
+
+    void TestMatchesScalar() {
+        World world(64);
+        lua_State* L = NewState();
+        SetActors(L, 0xFF000800, 64);
+
+        // Every batch result agrees with the scalar call for the same element, including the ones that do not
+        // resolve: a FormID with no form, a string and a table
+        CHECK(Run(L, R"(
+            Actors[3] = 0x12345678
+            Actors[10] = "Lydia"
+            Actors[11] = {}
+            local healths = GetHealths(Actors)
+            local distances = GetDistances(Actors[1], Actors)
+            assert(#healths == #Actors and #distances == #Actors, "length")
+            for i, actor in ipairs(Actors) do
+                local resolves = GetDistance(actor, actor) >= 0
+                assert(healths[i] == (resolves and GetHealth(actor)), "health " .. i)
+                assert(distances[i] == (resolves and GetDistance(Actors[1], actor)), "distance " .. i)
+            end
+            assert(healths[3] == false and healths[10] == false and healths[11] == false)
+        )"));
+
+        // An origin that does not resolve leaves every distance false, and an empty array gives an empty result
+        CHECK(Run(L, R"(
+            for _, distance in ipairs(GetDistances(0, Actors)) do assert(distance == false) end
+            assert(#GetDistances(0, Actors) == #Actors)
+            assert(next(GetHealths({})) == nil)
+        )"));
+
+        CHECK(!Run(L, "GetHealths(42)"));
+        CHECK(lua_gettop(L) == 0);
+        lua_close(L);
+    }
+
+    // Per-element cost of a loop of scalar calls against one batch call, both from Lua
+    void BenchmarkBatch() {
+        World world(1000);
+        lua_State* L = NewState();
+        CHECK(Run(L, R"(
+            function Scalar()
+                local total = 0
+                for i = 1, #Actors do total = total + GetHealth(Actors[i]) end
+                return total
+            end
+            function Batch()
+                local total = 0
+                local healths = GetHealths(Actors)
+                for i = 1, #healths do total = total + healths[i] end
+                return total
+            end
+        )"));
+
+        for (const std::size_t count : {10, 100, 1000}) {
+            SetActors(L, 0xFF000800, count);
+            const auto iterations = 200000 / count;
+            double totals[2] = {};
+            const auto run = [&](const char* function, double& total) {
+                lua_getglobal(L, function);
+                lua_call(L, 0, 1);
+                total = lua_tonumber(L, -1);
+                lua_pop(L, 1);
+            };
+            const auto scalar = Test::MeasureNanos(iterations, [&] { run("Scalar", totals[0]); });
+            const auto batch = Test::MeasureNanos(iterations, [&] { run("Batch", totals[1]); });
+            CHECK(totals[0] == totals[1]);
+            std::printf("%4zu actors: scalar %.1f ns, batch %.1f ns per actor (%.1fx)\n", count, scalar / count,
+                        batch / count, scalar / batch);
+        }
+        lua_close(L);
+    }
+}
+
+int main() {
+    TestMatchesScalar();
+    BenchmarkBatch();
+    return Test::Report("LuaBatchTest");
+}
@@ -0,0 +1,247 @@
+#include "Core/LuaCallBridge.h"
+#include "Core/LuaForms.h"
+
+#include "Check.h"
+
+extern "C" {
+#include <lua.h>
+#include <lualib.h>
+#include <lauxlib.h>
+}
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+using namespace Sample;
+
+// Form handles reduced to a userdata holding the form pointer
+void Sample::PushFormHandle(lua_State* L, RE::TESForm* form) {
+    if (!form) {
+        lua_pushnil(L);
+        return;
+    }
+    *static_cast<RE::TESForm**>(lua_newuserdatauv(L, sizeof(RE::TESForm*), 0)) = form;
+}
+
+namespace {
+    int TargetID(lua_State* L) {
+        if (lua_type(L, 1) != LUA_TUSERDATA) {
+            lua_pushinteger(L, 0);
+            return 1;
+        }
+        lua_pushinteger(L, (*static_cast<RE::TESForm**>(lua_touserdata(L, 1)))->GetFormID());
+        return 1;
+    }
+
+    lua_State* NewState() {
+        lua_State* L = luaL_newstate();
+        luaL_openlibs(L);
+        lua_register(L, "TargetID", TargetID);
+        return L;
+    }
+
+    bool Run(lua_State* L, const char* script) {
+        if (luaL_dostring(L, script) != LUA_OK) {
+            std::fprintf(stderr, "%s\n", lua_tostring(L, -1));
+            lua_pop(L, 1);
+            return false;
+        }
+        return true;
+    }
+
+    void TestCall() {
+        lua_State* L = NewState();
+        LuaCallBridge bridge;
+        RE::TESForm target(0x14);
+        CHECK(Run(L, R"(
+            function Sum(target, a, b) return TargetID(target) + a + b end
+            function Yes() return true end
+            function Text() return "3" end
+            function Fail() error("boom") end
+            Quests = { Main = { OnStage = function(target, stage) return stage * 2 end } }
+        )"));
+
+        const float args[] = {1.5f, 2.0f};
+        CHECK(bridge.Call(L, "Sum", &target, args) == 0x14 + 3.5f);
+        CHECK(bridge.Call(L, "Sum", nullptr, args) == 3.5f);
+        CHECK(bridge.Call(L, "Yes", nullptr, {}) == 1.0f);
+        CHECK(bridge.Call(L, "Text", nullptr, {}) == 0.0f);
+        const float stage[] = {10.0f};
+        CHECK(bridge.Call(L, "Quests.Main.OnStage", nullptr, stage) == 20.0f);
+
+        CHECK(bridge.Call(L, "Fail", nullptr, {}) == 0.0f);
+        CHECK(bridge.Call(L, "Missing", nullptr, {}) == 0.0f);
+        CHECK(bridge.Call(L, "Quests.Missing.OnStage", nullptr, {}) == 0.0f);
+        CHECK(bridge.Call(L, "Sum.Nested", nullptr, {}) == 0.0f);
+        CHECK(bridge.GetStats().errors == 4);
+        CHECK(lua_gettop(L) == 0);
+
+        // Missing functions are not cached, so defining one later works
+        CHECK(Run(L, "function Missing() return 7 end"));
+        CHECK(bridge.Call(L, "Missing", nullptr, {}) == 7.0f);
+        lua_close(L);
+    }
+
+    void TestCache() {
+        lua_State* L = NewState();
+        LuaCallBridge bridge;
+        CHECK(Run(L, "function Value() return 1 end"));
+
+        CHECK(bridge.Call(L, "Value", nullptr, {}) == 1.0f);
+        CHECK(bridge.Call(L, "Value", nullptr, {}) == 1.0f);
+        CHECK(bridge.GetStats().resolves == 1 && bridge.GetStats().cacheHits == 1);
+
+        // A replaced function is only seen once the cache is cleared
+        CHECK(Run(L, "function Value() return 2 end"));
+        CHECK(bridge.Call(L, "Value", nullptr, {}) == 1.0f);
+        bridge.Clear(L);
+        CHECK(bridge.Size() == 0);
+        CHECK(bridge.Call(L, "Value", nullptr, {}) == 2.0f);
+        lua_close(L);
+    }
+
+    void TestCasing() {
+        lua_State* L = NewState();
+        LuaCallBridge bridge;
+        CHECK(Run(L, R"(
+            Quests = { OnStage = function() return 1 end }
+            Both = { run = function() return 2 end, RUN = function() return 3 end }
+        )"));
+
+        // Another script interned the name first, in its own casing, which is what arrives here
+        const RE::BSFixedString first("QUESTS.ONSTAGE");
+        const RE::BSFixedString name("Quests.OnStage");
+        CHECK(name.data() == first.data());
+        CHECK(bridge.Call(L, name, nullptr, {}) == 1.0f);
+        CHECK(bridge.Call(L, "quests.onstage", nullptr, {}) == 1.0f);
+        CHECK(bridge.GetStats().resolves == 1);
+
+        // An exact match wins; otherwise more than one match resolves nothing
+        CHECK(bridge.Call(L, "Both.run", nullptr, {}) == 2.0f);
+        CHECK(bridge.Call(L, "Both.RUN", nullptr, {}) == 2.0f);  // Same pool entry as Both.run
+        CHECK(bridge.Call(L, "both.Run", nullptr, {}) == 2.0f);
+        CHECK(bridge.Call(L, "Both.rUn", nullptr, {}) == 2.0f);
+        CHECK(bridge.Call(L, "Ambiguous.Run", nullptr, {}) == 0.0f);
+
+        CHECK(Run(L, "Ambiguous = { run = function() end, RUN = function() end }"));
+        CHECK(bridge.Call(L, "Ambiguous.Run", nullptr, {}) == 0.0f);
+        CHECK(lua_gettop(L) == 0);
+        lua_close(L);
+    }
+
+    void TestCallBatch() {
+        lua_State* L = NewState();
+        LuaCallBridge bridge;
+        CHECK(Run(L, "function Score(target, bonus) if not target then error('no target') end "
+                     "return TargetID(target) + bonus end"));
+
+        RE::TESForm first(1);
+        RE::TESForm second(2);
+        RE::TESForm* targets[] = {&first, nullptr, &second};
+        const float bonus[] = {0.5f};
+        std::vector<float> out;
+        bridge.CallBatch(L, "Score", targets, bonus, out);
+        CHECK((out == std::vector<float>{1.5f, 0.0f, 2.5f}));
+        CHECK(bridge.GetStats().errors == 1);
+
+        bridge.CallBatch(L, "Nothing", targets, bonus, out);
+        CHECK((out == std::vector<float>{0.0f, 0.0f, 0.0f}));
+        CHECK(lua_gettop(L) == 0);
+        lua_close(L);
+    }
+
+    struct Latency {
+        std::vector<double> nanos;
+
+        void Print(const char* name) {
+            std::sort(nanos.begin(), nanos.end());
+            const auto at = [&](double quantile) {
+                return nanos[static_cast<std::size_t>(quantile * static_cast<double>(nanos.size() - 1))];
+            };
+            std::printf("  %-34s p50 %6.2f us, p99 %6.2f us, max %7.2f us\n", name, at(0.5) / 1e3, at(0.99) / 1e3,
+                        nanos.back() / 1e3);
+        }
+    };
+
+    template <class F>
+    void Time(Latency& latency, F&& body) {
+        const auto start = std::chrono::steady_clock::now();
+        body();
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        latency.nanos.push_back(elapsed.count());
+    }
+
+    // Drives the bridge the way quest scripts do: a few dozen calls in each frame, spread over a handful of
+    // functions, with the rest of the frame's work evicting the caches in between
+    void BenchmarkPapyrusRate() {
+        constexpr int Frames = 600;  // Ten seconds at 60 frames per second
+        constexpr int CallsPerFrame = 40;
+        constexpr std::size_t SquadSize = 24;
+
+        lua_State* L = NewState();
+        LuaCallBridge bridge;
+        CHECK(Run(L, R"(
+            Quests = { Main = { OnStage = function(target, stage) return stage + 1 end } }
+            Combat = { Threat = function(target, distance, health) return health / (distance + 1) end }
+            function IsHostile(target) return TargetID(target) % 3 == 0 end
+            Tracked = {}
+            function Quests.Main.Track(target, amount)
+                Tracked[TargetID(target)] = (Tracked[TargetID(target)] or 0) + amount
+            end
+        )"));
+
+        const RE::BSFixedString names[] = {"Quests.Main.OnStage", "Combat.Threat", "IsHostile", "Quests.Main.Track"};
+        std::vector<RE::TESForm> forms;
+        for (std::uint32_t i = 0; i < SquadSize; ++i) {
+            forms.emplace_back(0xFF000800 + i);
+        }
+        std::vector<RE::TESForm*> squad;
+        for (auto& form : forms) {
+            squad.push_back(&form);
+        }
+
+        Latency firstCall;
+        Latency call;
+        Latency batch;
+        for (const auto& name : names) {
+            const float args[] = {1.0f, 2.0f};
+            Time(firstCall, [&] { bridge.Call(L, name, squad[0], args); });
+        }
+
+        std::vector<char> frameWork(8 << 20);
+        std::vector<float> out;
+        unsigned char noise = 0;
+        for (int frame = 0; frame < Frames; ++frame) {
+            for (auto& byte : frameWork) {
+                byte = static_cast<char>(byte + ++noise);
+            }
+            for (int i = 0; i < CallsPerFrame; ++i) {
+                const float args[] = {static_cast<float>(i), 50.0f};
+                auto* target = squad[static_cast<std::size_t>(i) % SquadSize];
+                Time(call, [&] { bridge.Call(L, names[i % 4], target, args); });
+            }
+            const float args[] = {512.0f, 80.0f};
+            Time(batch, [&] { bridge.CallBatch(L, names[1], squad, args, out); });
+        }
+        CHECK(bridge.GetStats().resolves == 4);
+        CHECK(bridge.GetStats().errors == 0);
+        CHECK(lua_gettop(L) == 0);
+
+        std::printf("LuaCallBridge latency over %d frames:\n", Frames);
+        firstCall.Print("first call (resolves the path)");
+        call.Print("CallLua, cached");
+        batch.Print("CallLuaBatch, 24 targets");
+        lua_close(L);
+    }
+}
+
+int main() {
+    TestCall();
+    TestCache();
+    TestCasing();
+    TestCallBatch();
+    BenchmarkPapyrusRate();
+    return Test::Report("LuaCallBridgeTest");
+}
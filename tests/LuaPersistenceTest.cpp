@@ -0,0 +1,284 @@
+#include "Core/LuaPersistence.h"
+#include "Core/LuaForms.h"
+
+#include "Check.h"
+
+extern "C" {
+#include <lua.h>
+#include <lualib.h>
+#include <lauxlib.h>
+}
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+using namespace Sample;
+
+// Form handles reduced to a userdata holding the form pointer; the persistence code only pushes and reads them
+void Sample::PushFormHandle(lua_State* L, RE::TESForm* form) {
+    if (!form) {
+        lua_pushnil(L);
+        return;
+    }
+    *static_cast<RE::TESForm**>(lua_newuserdatauv(L, sizeof(RE::TESForm*), 0)) = form;
+}
+
+RE::TESForm* Sample::ToForm(lua_State* L, int index) {
+    if (lua_type(L, index) != LUA_TUSERDATA || lua_rawlen(L, index) != sizeof(RE::TESForm*)) {
+        return nullptr;
+    }
+    return *static_cast<RE::TESForm**>(lua_touserdata(L, index));
+}
+
+namespace {
+    int PushForm(lua_State* L) {
+        PushFormHandle(L, RE::TESForm::LookupByID(static_cast<RE::FormID>(luaL_checkinteger(L, 1))));
+        return 1;
+    }
+
+    int FormID(lua_State* L) {
+        auto* form = ToForm(L, 1);
+        if (form) {
+            lua_pushinteger(L, form->GetFormID());
+        } else {
+            lua_pushnil(L);
+        }
+        return 1;
+    }
+
+    lua_State* NewState() {
+        lua_State* L = luaL_newstate();
+        luaL_openlibs(L);
+        lua_register(L, "Form", PushForm);
+        lua_register(L, "FormID", FormID);
+        return L;
+    }
+
+    bool Run(lua_State* L, const char* script) {
+        if (luaL_dostring(L, script) != LUA_OK) {
+            std::fprintf(stderr, "%s\n", lua_tostring(L, -1));
+            lua_pop(L, 1);
+            return false;
+        }
+        return true;
+    }
+
+    bool IsTrue(lua_State* L, const char* expression) {
+        const std::string script = std::string("return ") + expression;
+        if (!Run(L, script.c_str())) {
+            return false;
+        }
+        const bool result = lua_toboolean(L, -1);
+        lua_pop(L, 1);
+        return result;
+    }
+
+    void Register(lua_State* L, LuaPersistence& persistence, const char* global, bool dirtyTracking) {
+        lua_getglobal(L, global);
+        persistence.Register(L, global, -1, dirtyTracking);
+        lua_pop(L, 1);
+    }
+
+    bool NoRemap(RE::FormID saved, RE::FormID& current) {
+        current = saved;
+        return true;
+    }
+
+    void TestRoundTrip() {
+        RE::TESForm sword(0x00012EB7);
+        RE::TESForm mod(0x05000D62);
+        RE::TESForm::AllForms() = {{sword.GetFormID(), &sword}, {mod.GetFormID(), &mod}};
+
+        lua_State* L = NewState();
+        LuaPersistence persistence;
+        CHECK(Run(L, R"(
+            shared = { name = "shared" }
+            Data = {
+                10, -3, 2.5, "text", true,
+                name = "Lydia", level = 1 << 40, ratio = -0.125, alive = false,
+                nested = { deep = { deeper = { "x" } } },
+                a = shared, b = shared,
+                weapon = Form(0x00012EB7), modItem = Form(0x05000D62),
+                skipped = print, [print] = 1,
+            }
+            Data.self = Data
+        )"));
+        Register(L, persistence, "Data", false);
+
+        ByteWriter saved;
+        persistence.Save(L, saved);
+        CHECK(persistence.GetStats().skipped == 2);
+        lua_close(L);
+
+        // The mod's load order slot moved and the sword's plugin is gone
+        L = NewState();
+        LuaPersistence loaded;
+        CHECK(Run(L, "Data = { stale = true }"));
+        Register(L, loaded, "Data", false);
+        const auto remap = [](RE::FormID saved, RE::FormID& current) {
+            if (saved >> 24 == 0x05) {
+                current = (saved & 0x00FFFFFF) | 0x07000000;
+                return true;
+            }
+            return false;
+        };
+        RE::TESForm moved(0x07000D62);
+        RE::TESForm::AllForms() = {{moved.GetFormID(), &moved}};
+        CHECK(loaded.Load(L, {saved.Data(), saved.Size()}, remap));
+
+        CHECK(IsTrue(L, "Data.stale == nil and #Data == 5 and Data[1] == 10 and Data[3] == 2.5 and Data[5] == true"));
+        CHECK(IsTrue(L, "Data.name == 'Lydia' and Data.level == 1 << 40 and Data.ratio == -0.125"));
+        CHECK(IsTrue(L, "Data.alive == false and Data.nested.deep.deeper[1] == 'x'"));
+        CHECK(IsTrue(L, "Data.a == Data.b and Data.a.name == 'shared' and Data.self == Data"));
+        CHECK(IsTrue(L, "Data.weapon == nil and FormID(Data.modItem) == 0x07000D62"));
+        CHECK(IsTrue(L, "Data.skipped == nil"));
+        lua_close(L);
+        RE::TESForm::AllForms().clear();
+    }
+
+    void TestLoadBeforeRegister() {
+        lua_State* L = NewState();
+        LuaPersistence persistence;
+        CHECK(Run(L, "Quest = { stage = 20 }"));
+        Register(L, persistence, "Quest", true);
+        ByteWriter saved;
+        persistence.Save(L, saved);
+        lua_close(L);
+
+        L = NewState();
+        LuaPersistence loaded;
+        CHECK(loaded.Load(L, {saved.Data(), saved.Size()}, NoRemap));
+        CHECK(loaded.Size() == 1);
+
+        // A script registering later gets the loaded entries over its defaults
+        CHECK(Run(L, "Quest = { stage = 0, started = true }"));
+        Register(L, loaded, "Quest", true);
+        CHECK(IsTrue(L, "Quest.stage == 20 and Quest.started == true"));
+
+        loaded.Revert(L);
+        CHECK(IsTrue(L, "next(Quest) == nil"));
+        lua_close(L);
+    }
+
+    void TestDirtyTracking() {
+        lua_State* L = NewState();
+        LuaPersistence persistence;
+        CHECK(Run(L, "Tracked = { value = 1 } Always = { value = 1 }"));
+        Register(L, persistence, "Tracked", true);
+        Register(L, persistence, "Always", false);
+
+        ByteWriter first;
+        persistence.Save(L, first);
+        CHECK(persistence.GetStats().encodes == 2);
+
+        // Unmarked changes to a tracked root are not seen until MarkDirty
+        CHECK(Run(L, "Tracked.value = 2 Always.value = 2"));
+        ByteWriter second;
+        persistence.Save(L, second);
+        CHECK(persistence.GetStats().encodes == 3);
+        CHECK(persistence.GetStats().reuses == 1);
+
+        CHECK(persistence.MarkDirty("Tracked"));
+        CHECK(!persistence.MarkDirty("Missing"));
+        ByteWriter third;
+        persistence.Save(L, third);
+        CHECK(persistence.GetStats().encodes == 5);
+
+        LuaPersistence loaded;
+        CHECK(Run(L, "Tracked = {} Always = {}"));
+        Register(L, loaded, "Tracked", true);
+        Register(L, loaded, "Always", false);
+        CHECK(loaded.Load(L, {second.Data(), second.Size()}, NoRemap));
+        CHECK(IsTrue(L, "Tracked.value == 1 and Always.value == 2"));
+        CHECK(loaded.Load(L, {third.Data(), third.Size()}, NoRemap));
+        CHECK(IsTrue(L, "Tracked.value == 2"));
+        lua_close(L);
+    }
+
+    void TestCorruptRecord() {
+        lua_State* L = NewState();
+        LuaPersistence persistence;
+        CHECK(Run(L, "Data = { 1, 2, 3, name = 'x' }"));
+        Register(L, persistence, "Data", false);
+        ByteWriter saved;
+        persistence.Save(L, saved);
+
+        // Cut inside the table's encoding: the record parses, the table keeps what could be read
+        bool survived = true;
+        for (std::size_t size = 0; size < saved.Size(); ++size) {
+            persistence.Load(L, {saved.Data(), size}, NoRemap);
+            survived = survived && lua_gettop(L) == 0;
+        }
+        CHECK(survived);
+        lua_close(L);
+    }
+
+    // A save-heavy script: a per-actor table of records with shared strings, tens of thousands of entries
+    void BenchmarkSave() {
+        lua_State* L = NewState();
+        LuaPersistence persistence;
+        CHECK(Run(L, R"(
+            local factions = { "Whiterun", "Stormcloaks", "Imperials", "Companions", "ThievesGuild" }
+            Actors = {}
+            for i = 1, 60000 do
+                Actors[0xFF000000 + i] = {
+                    name = "npc" .. i,
+                    faction = factions[i % #factions + 1],
+                    hits = i % 97,
+                    health = i * 0.75,
+                    hostile = i % 3 == 0,
+                    position = { i * 1.5, i * -2.25, 128.0 },
+                    history = { i, i + 1, i + 2, i + 3 },
+                }
+            end
+        )"));
+        Register(L, persistence, "Actors", false);
+
+        constexpr int Runs = 5;
+        std::uint64_t saveMicros = 0;
+        ByteWriter saved;
+        for (int run = 0; run < Runs; ++run) {
+            saved.Clear();
+            persistence.Save(L, saved);
+            saveMicros += persistence.GetStats().lastSaveMicros;
+        }
+
+        LuaPersistence loaded;
+        std::uint64_t loadMicros = 0;
+        for (int run = 0; run < Runs; ++run) {
+            CHECK(loaded.Load(L, {saved.Data(), saved.Size()}, NoRemap));
+            loadMicros += loaded.GetStats().lastLoadMicros;
+        }
+
+        // The same table with dirty tracking and nothing marked: the previous encoding is written again
+        LuaPersistence tracked;
+        lua_getglobal(L, "Actors");
+        tracked.Register(L, "Actors", -1, true);
+        lua_pop(L, 1);
+        ByteWriter first;
+        tracked.Save(L, first);
+        std::uint64_t reuseMicros = 0;
+        for (int run = 0; run < Runs; ++run) {
+            ByteWriter again;
+            tracked.Save(L, again);
+            reuseMicros += tracked.GetStats().lastSaveMicros;
+            CHECK(again.Size() == first.Size());
+        }
+
+        std::printf("60000 records, %.2f MB: save %.2f ms, load %.2f ms, dirty-tracked save of an unchanged table "
+                    "%.3f ms\n",
+                    static_cast<double>(saved.Size()) / (1024.0 * 1024.0), saveMicros / 1000.0 / Runs,
+                    loadMicros / 1000.0 / Runs, reuseMicros / 1000.0 / Runs);
+        lua_close(L);
+    }
+}
+
+int main() {
+    TestRoundTrip();
+    TestLoadBeforeRegister();
+    TestDirtyTracking();
+    TestCorruptRecord();
+    BenchmarkSave();
+    return Test::Report("LuaPersistenceTest");
+}
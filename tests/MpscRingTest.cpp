@@ -0,0 +1,182 @@
+#include "Core/MpscRing.h"
+
+#include "Check.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace Sample;
+
+namespace {
+    struct Item {
+        std::uint32_t producer;
+        std::uint32_t sequence;
+    };
+
+    constexpr std::uint32_t Producers = 8;
+
+    void TestSingleThread() {
+        MpscRing<Item, 8> ring;
+        CHECK(ring.Front() == nullptr);
+
+        // Several laps, so every cell is reused
+        std::uint32_t next = 0;
+        std::uint32_t expected = 0;
+        bool inOrder = true;
+        for (int lap = 0; lap < 5; ++lap) {
+            for (int i = 0; i < 6; ++i) {
+                CHECK(ring.TryPush([&](Item& item) { item = {0, next++}; }));
+            }
+            while (const auto* item = ring.Front()) {
+                inOrder = inOrder && item->sequence == expected++;
+                ring.Pop();
+            }
+        }
+        CHECK(inOrder);
+        CHECK(expected == next);
+
+        // A full ring turns pushes away without touching the queued values
+        for (std::uint32_t i = 0; i < 8; ++i) {
+            CHECK(ring.TryPush([i](Item& item) { item = {1, i}; }));
+        }
+        CHECK(!ring.TryPush([](Item& item) { item = {2, 0}; }));
+        CHECK(!ring.TryPush([](Item& item) { item = {2, 1}; }));
+        CHECK(ring.Size() == 8);
+        CHECK(ring.Dropped() == 2);
+        CHECK(ring.HighWater() == 8);
+        CHECK(ring.Pushed() == next + 8);
+
+        // Everything queued can be read in place before any of it is released
+        for (std::uint32_t i = 0; i < 8; ++i) {
+            const auto* item = ring.Peek(i);
+            CHECK(item && item->producer == 1 && item->sequence == i);
+        }
+        CHECK(ring.Peek(8) == nullptr);
+        ring.Pop();
+        CHECK(ring.Peek(6) && ring.Peek(6)->sequence == 7);
+        CHECK(ring.Peek(7) == nullptr);
+        CHECK(ring.TryPush([](Item& item) { item = {1, 8}; }));
+        CHECK(ring.Peek(7) && ring.Peek(7)->sequence == 8);
+        for (std::uint32_t i = 1; i < 9; ++i) {
+            const auto* item = ring.Front();
+            CHECK(item && item->producer == 1 && item->sequence == i);
+            ring.Pop();
+        }
+        CHECK(ring.Front() == nullptr);
+        CHECK(ring.Size() == 0);
+    }
+
+    // Producers retry until every item is in, while the consumer drains: every item must arrive exactly once, and in
+    // the order its producer pushed it
+    void TestStress() {
+        constexpr std::uint32_t PerProducer = 200000;
+        MpscRing<Item, 1024> ring;
+        std::atomic<bool> start{false};
+        std::vector<std::uint64_t> retries(Producers);
+        std::vector<std::thread> threads;
+        for (std::uint32_t producer = 0; producer < Producers; ++producer) {
+            threads.emplace_back([&, producer] {
+                while (!start.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                }
+                for (std::uint32_t sequence = 0; sequence < PerProducer; ++sequence) {
+                    while (!ring.TryPush([=](Item& item) { item = {producer, sequence}; })) {
+                        ++retries[producer];
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+
+        std::vector<std::uint32_t> next(Producers, 0);
+        std::uint64_t received = 0;
+        bool inOrder = true;
+        const auto begin = std::chrono::steady_clock::now();
+        start.store(true, std::memory_order_release);
+        while (received < std::uint64_t{Producers} * PerProducer) {
+            const auto* item = ring.Front();
+            if (!item) {
+                std::this_thread::yield();
+                continue;
+            }
+            // An item out of order is either lost (a gap) or duplicated (a repeat)
+            inOrder = inOrder && item->producer < Producers && item->sequence == next[item->producer];
+            ++next[item->producer];
+            ++received;
+            ring.Pop();
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        std::uint64_t totalRetries = 0;
+        for (const auto count : retries) {
+            totalRetries += count;
+        }
+        CHECK(inOrder);
+        CHECK(std::all_of(next.begin(), next.end(), [](std::uint32_t count) { return count == PerProducer; }));
+        CHECK(ring.Front() == nullptr);
+        CHECK(ring.Pushed() == received);
+        CHECK(ring.Dropped() == totalRetries);
+        std::printf("%u producers, %llu items through a 1024-cell ring in %.2f s (%.1f M/s, %llu pushes found it full)\n",
+                    Producers, static_cast<unsigned long long>(received), elapsed.count(),
+                    static_cast<double>(received) / elapsed.count() / 1e6,
+                    static_cast<unsigned long long>(totalRetries));
+    }
+
+    // Producers push without retrying into a ring nobody drains: exactly Capacity pushes succeed, every other push
+    // is counted as dropped, and what was accepted still comes out in per-producer order
+    void TestDropsWhenFull() {
+        constexpr std::uint32_t PerProducer = 2000;
+        MpscRing<Item, 4096> ring;
+        std::atomic<bool> start{false};
+        std::vector<std::uint32_t> accepted(Producers, 0);
+        std::vector<std::thread> threads;
+        for (std::uint32_t producer = 0; producer < Producers; ++producer) {
+            threads.emplace_back([&, producer] {
+                while (!start.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                }
+                for (std::uint32_t sequence = 0; sequence < PerProducer; ++sequence) {
+                    if (ring.TryPush([=](Item& item) { item = {producer, sequence}; })) {
+                        ++accepted[producer];
+                    }
+                }
+            });
+        }
+        start.store(true, std::memory_order_release);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        constexpr std::uint64_t Attempts = std::uint64_t{Producers} * PerProducer;
+        CHECK(ring.Pushed() == ring.Capacity);
+        CHECK(ring.Dropped() == Attempts - ring.Capacity);
+        CHECK(ring.Size() == ring.Capacity);
+        CHECK(ring.HighWater() == ring.Capacity);
+
+        std::vector<std::int64_t> last(Producers, -1);
+        std::vector<std::uint32_t> seen(Producers, 0);
+        bool inOrder = true;
+        while (const auto* item = ring.Front()) {
+            inOrder = inOrder && item->sequence > last[item->producer];
+            last[item->producer] = item->sequence;
+            ++seen[item->producer];
+            ring.Pop();
+        }
+        CHECK(inOrder);
+        CHECK(seen == accepted);
+    }
+}
+
+int main() {
+    TestSingleThread();
+    TestStress();
+    TestDropsWhenFull();
+    return Test::Report("MpscRingTest");
+}
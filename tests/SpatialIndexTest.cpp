@@ -0,0 +1,317 @@
+#include "Core/SpatialIndex.h"
+
+#include "Check.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace Sample;
+
+namespace {
+    using Hit = SpatialIndex::Hit;
+    using Query = SpatialIndex::Query;
+
+    constexpr float Unlimited = std::numeric_limits<float>::max();
+
+    /**
+     * A synthetic world: references scattered over a square of a worldspace, a few in an interior, drawn from a
+     * handful of base objects. One in ten is an actor. A clustered world puts half of them in a town-sized circle.
+     */
+    struct World {
+        RE::TESWorldSpace tamriel{0x0000003C};
+        RE::TESObjectCELL interior{0x000165A7};
+        std::vector<std::unique_ptr<RE::TESBoundObject>> bases;
+        std::vector<std::unique_ptr<RE::TESObjectREFR>> refs;
+        std::mt19937 random;
+        float extent;
+
+        World(std::size_t count, float extent, bool clustered, std::uint32_t seed) : random(seed), extent(extent) {
+            for (std::uint32_t i = 0; i < 16; ++i) {
+                bases.push_back(std::make_unique<RE::TESBoundObject>(0x00012E00 + i));
+            }
+            std::uniform_real_distribution<float> coordinate(-extent / 2, extent / 2);
+            std::uniform_real_distribution<float> height(-500.0f, 500.0f);
+            std::normal_distribution<float> town(0.0f, 1500.0f);
+            auto& loaded = RE::TES::GetSingleton()->references;
+            loaded.clear();
+            for (std::uint32_t i = 0; i < count; ++i) {
+                const auto formID = 0xFF000800 + i;
+                std::unique_ptr<RE::TESObjectREFR> ref;
+                if (i % 10 == 0) {
+                    ref = std::make_unique<RE::Actor>(formID);
+                } else {
+                    ref = std::make_unique<RE::TESObjectREFR>(formID);
+                }
+                ref->base = bases[random() % bases.size()].get();
+                if (i % 20 == 1) {
+                    ref->parentCell = &interior;
+                } else {
+                    ref->worldspace = &tamriel;
+                }
+                const bool inTown = clustered && i % 2 == 0;
+                ref->position = inTown ? RE::NiPoint3{town(random), town(random), height(random)}
+                                       : RE::NiPoint3{coordinate(random), coordinate(random), height(random)};
+                RE::TESForm::AllForms()[formID] = ref.get();
+                loaded.push_back(ref.get());
+                refs.push_back(std::move(ref));
+            }
+            SpatialIndex::GetSingleton()->Rebuild();
+        }
+
+        ~World() {
+            SpatialIndex::GetSingleton()->Clear();
+            RE::TES::GetSingleton()->references.clear();
+            RE::TESForm::AllForms().clear();
+        }
+
+        RE::TESObjectREFR* Pick() { return refs[random() % refs.size()].get(); }
+
+        // A query the way scripts make them: around a point of the world or a reference, of any base or one of them
+        Query RandomQuery() {
+            Query query;
+            std::uniform_real_distribution<float> coordinate(-extent * 0.6f, extent * 0.6f);
+            const float radii[] = {0.0f, 500.0f, 2048.0f, 5000.0f, 20000.0f, Unlimited};
+            if (random() % 2 == 0) {
+                query = SpatialIndex::QueryAround(Pick(), radii[random() % std::size(radii)]);
+            } else {
+                query.space = random() % 10 == 0 ? interior.GetFormID() : tamriel.GetFormID();
+                query.origin = {coordinate(random), coordinate(random), 0.0f};
+                query.radius = radii[random() % std::size(radii)];
+            }
+            if (random() % 2 == 0) {
+                query.baseID = bases[random() % bases.size()]->GetFormID();
+            }
+            return query;
+        }
+    };
+
+    // The count closest loaded references matching the query, closest first: what a query costs without the index
+    std::vector<Hit> BruteForce(const Query& query, std::size_t count = std::numeric_limits<std::size_t>::max()) {
+        std::vector<Hit> hits;
+        RE::TES::GetSingleton()->ForEachReference([&](RE::TESObjectREFR& ref) {
+            if (!ref.IsDisabled() && SpatialIndex::GetSpace(&ref) == query.space && ref.GetFormID() != query.exclude &&
+                (!query.baseID || ref.GetBaseObject()->GetFormID() == query.baseID)) {
+                const float distance = ref.GetPosition().GetDistance(query.origin);
+                if (distance <= query.radius) {
+                    hits.push_back({ref.GetFormID(), distance});
+                }
+            }
+            return RE::BSContainer::ForEachResult::kContinue;
+        });
+        const auto end = hits.begin() + static_cast<std::ptrdiff_t>(std::min(count, hits.size()));
+        std::partial_sort(hits.begin(), end, hits.end(), [](const Hit& left, const Hit& right) {
+            return left.distance < right.distance || (left.distance == right.distance && left.formID < right.formID);
+        });
+        hits.erase(end, hits.end());
+        return hits;
+    }
+
+    bool SameDistances(const std::vector<Hit>& hits, const std::vector<Hit>& expected, std::size_t count) {
+        if (hits.size() != std::min(count, expected.size())) {
+            return false;
+        }
+        for (std::size_t i = 0; i < hits.size(); ++i) {
+            if (hits[i].distance != expected[i].distance) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool SameReferences(std::vector<Hit> hits, std::vector<Hit> expected) {
+        const auto byFormID = [](const Hit& left, const Hit& right) { return left.formID < right.formID; };
+        std::sort(hits.begin(), hits.end(), byFormID);
+        std::sort(expected.begin(), expected.end(), byFormID);
+        return std::equal(hits.begin(), hits.end(), expected.begin(), expected.end(),
+                          [](const Hit& left, const Hit& right) { return left.formID == right.formID; });
+    }
+
+    // Checks every kind of query against brute force; ties may be broken either way, so only distances are compared
+    // where the order matters
+    std::size_t CountMismatches(World& world, std::size_t queries) {
+        const auto* index = SpatialIndex::GetSingleton();
+        std::size_t mismatches = 0;
+        std::vector<Hit> hits;
+        for (std::size_t i = 0; i < queries; ++i) {
+            const auto query = world.RandomQuery();
+            const auto expected = BruteForce(query);
+
+            const auto closest = index->FindClosest(query);
+            bool same = expected.empty() ? !closest : closest && closest->distance == expected.front().distance;
+
+            hits.clear();
+            index->FindInRadius(query, hits);
+            same = same && SameDistances(hits, expected, expected.size()) && SameReferences(hits, expected);
+
+            const std::size_t count = 1 + world.random() % 20;
+            hits.clear();
+            index->FindNearest(query, count, hits);
+            same = same && SameDistances(hits, expected, count);
+
+            mismatches += same ? 0 : 1;
+        }
+        return mismatches;
+    }
+
+    void TestAgainstBruteForce() {
+        {
+            World world(20000, 60000.0f, false, 11);
+            CHECK(SpatialIndex::GetSingleton()->GetStats().references == 20000);
+            CHECK(SpatialIndex::GetSingleton()->GetStats().mobile == 2000);
+            CHECK(CountMismatches(world, 2000) == 0);
+        }
+        {
+            World world(20000, 60000.0f, true, 12);
+            CHECK(CountMismatches(world, 2000) == 0);
+        }
+    }
+
+    // The index follows the game's events and the per-frame refresh, and still agrees with brute force afterwards
+    void TestUpdates() {
+        World world(5000, 40000.0f, false, 13);
+        auto* index = SpatialIndex::GetSingleton();
+        auto* events = RE::ScriptEventSourceHolder::GetSingleton();
+        auto& loaded = RE::TES::GetSingleton()->references;
+        index->InitializeEvents();
+
+        std::uniform_real_distribution<float> coordinate(-20000.0f, 20000.0f);
+        for (int step = 0; step < 2000; ++step) {
+            auto* ref = world.Pick();
+            const bool isLoaded = std::find(loaded.begin(), loaded.end(), ref) != loaded.end();
+            switch (world.random() % 4) {
+                case 0: {
+                    // Moved by a script: the game reports a move attach
+                    ref->position = {coordinate(world.random), coordinate(world.random), 0.0f};
+                    const RE::TESMoveAttachDetachEvent event{ref, true};
+                    events->SendEvent(&event);
+                    if (!isLoaded) {
+                        loaded.push_back(ref);
+                    }
+                    break;
+                }
+                case 1: {
+                    // Its cell detached
+                    const RE::TESCellAttachDetachEvent event{ref, false};
+                    events->SendEvent(&event);
+                    std::erase(loaded, ref);
+                    break;
+                }
+                case 2: {
+                    // Deleted
+                    const RE::TESFormDeleteEvent event{ref->GetFormID()};
+                    events->SendEvent(&event);
+                    std::erase(loaded, ref);
+                    break;
+                }
+                default: {
+                    // Placed at runtime, or its 3D loaded again
+                    const RE::TESObjectLoadedEvent event{ref->GetFormID(), true};
+                    events->SendEvent(&event);
+                    if (!isLoaded) {
+                        loaded.push_back(ref);
+                    }
+                    break;
+                }
+            }
+        }
+        CHECK(index->GetStats().references == loaded.size());
+
+        // Actors walk on their own; a full round of refreshes picks up where every one of them went
+        for (auto& ref : world.refs) {
+            if (ref->As<RE::Actor>()) {
+                ref->position.x += 3000.0f;
+            }
+        }
+        const auto rounds = index->GetStats().mobile / SpatialIndex::RefreshPerFrame + 1;
+        for (std::size_t i = 0; i < rounds; ++i) {
+            index->Refresh();
+        }
+        CHECK(index->GetStats().relocated > 0);
+        CHECK(CountMismatches(world, 2000) == 0);
+
+        // Disabled references are not indexed, and emptying the world leaves nothing to find
+        auto* disabled = loaded.front();
+        const auto references = index->GetStats().references;
+        index->Remove(disabled->GetFormID());
+        disabled->disabled = true;
+        index->Add(disabled);
+        CHECK(index->GetStats().references == references - 1);
+        for (auto& ref : world.refs) {
+            index->Remove(ref->GetFormID());
+        }
+        Query everywhere;
+        everywhere.space = world.tamriel.GetFormID();
+        everywhere.radius = Unlimited;
+        CHECK(!index->FindClosest(everywhere));
+        CHECK(index->GetStats().cells == 0);
+    }
+
+    template <class F>
+    double NanosPerQuery(const std::vector<Query>& queries, F&& run) {
+        std::size_t next = 0;
+        return Test::MeasureNanos(queries.size(), [&] { run(queries[next++]); });
+    }
+
+    // A world as dense as the loaded grid gets in a city: 50000 references over 7 by 7 cells. Queries start from
+    // references in the world, as FindClosestReference and the Lua queries do from the player.
+    void BenchmarkQueries() {
+        for (const bool clustered : {false, true}) {
+            World world(50000, 7 * 4096.0f, clustered, 14);
+            const auto* index = SpatialIndex::GetSingleton();
+
+            std::vector<Query> closest;
+            std::vector<Query> nearest;
+            std::vector<Query> radius;
+            for (int i = 0; i < 2000; ++i) {
+                auto* origin = world.Pick();
+                closest.push_back(
+                    SpatialIndex::QueryAround(origin, 8192.0f, world.bases[world.random() % 16]->GetFormID()));
+                nearest.push_back(SpatialIndex::QueryAround(origin, Unlimited));
+                radius.push_back(SpatialIndex::QueryAround(origin, 2048.0f));
+            }
+
+            std::size_t sink = 0;
+            std::vector<Hit> hits;
+            const double closestIndexed = NanosPerQuery(closest, [&](const Query& query) {
+                sink += index->FindClosest(query).has_value();
+            });
+            const double nearestIndexed = NanosPerQuery(nearest, [&](const Query& query) {
+                hits.clear();
+                index->FindNearest(query, 10, hits);
+                sink += hits.size();
+            });
+            const double radiusIndexed = NanosPerQuery(radius, [&](const Query& query) {
+                hits.clear();
+                index->FindInRadius(query, hits);
+                sink += hits.size();
+            });
+            const auto scan = [&](std::size_t count) {
+                return [&sink, count](const Query& query) { sink += BruteForce(query, count).size(); };
+            };
+            const double closestScanned = NanosPerQuery(closest, scan(1));
+            const double nearestScanned = NanosPerQuery(nearest, scan(10));
+            const double radiusScanned = NanosPerQuery(radius, scan(std::numeric_limits<std::size_t>::max()));
+            CHECK(sink > 0);
+
+            std::printf("50000 references, %s, indexed against scanning every reference:\n"
+                        "  closest of a type within 8192  %8.2f us  %8.2f us  (%.1fx)\n"
+                        "  10 nearest                     %8.2f us  %8.2f us  (%.1fx)\n"
+                        "  all within 2048                %8.2f us  %8.2f us  (%.1fx)\n",
+                        clustered ? "half in one town" : "uniform", closestIndexed / 1e3, closestScanned / 1e3,
+                        closestScanned / closestIndexed, nearestIndexed / 1e3, nearestScanned / 1e3,
+                        nearestScanned / nearestIndexed, radiusIndexed / 1e3, radiusScanned / 1e3,
+                        radiusScanned / radiusIndexed);
+        }
+    }
+}
+
+int main() {
+    TestAgainstBruteForce();
+    TestUpdates();
+    BenchmarkQueries();
+    return Test::Report("SpatialIndexTest");
+}
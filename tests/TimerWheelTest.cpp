@@ -0,0 +1,195 @@
+#include "Core/TimerWheel.h"
+
+#include "Check.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace Sample;
+
+namespace {
+    // Ticks per frame at 1 ms resolution and 60 frames per second
+    constexpr std::uint64_t TicksPerFrame = 16;
+
+    void TestOneShotAndRepeating() {
+        TimerWheel wheel;
+        std::vector<std::pair<std::uint32_t, std::uint64_t>> fired;
+        const auto record = [&](TimerWheel::TimerId, std::uint32_t payload, bool) {
+            fired.emplace_back(payload, wheel.Now());
+        };
+
+        wheel.Schedule(0, 0, 1);  // Rounded up to the next tick
+        wheel.Schedule(5, 0, 2);
+        wheel.Schedule(3, 3, 3);
+        CHECK(wheel.Size() == 3);
+
+        wheel.Advance(10, record);
+        const std::vector<std::pair<std::uint32_t, std::uint64_t>> expected{{1, 1}, {3, 3}, {2, 5}, {3, 6}, {3, 9}};
+        CHECK(fired == expected);
+        CHECK(wheel.Size() == 1);
+    }
+
+    void TestCancel() {
+        TimerWheel wheel;
+        const auto id = wheel.Schedule(10, 0, 42);
+        std::uint32_t payload = 0;
+        CHECK(wheel.Cancel(id, &payload));
+        CHECK(payload == 42);
+        CHECK(!wheel.Cancel(id));
+        CHECK(wheel.Size() == 0);
+
+        // The node is reused, but the stale ID must not cancel the new timer
+        const auto reused = wheel.Schedule(10, 0, 7);
+        CHECK(!wheel.Cancel(id));
+        CHECK(wheel.Cancel(reused));
+    }
+
+    void TestLongDelaysCascade() {
+        TimerWheel wheel;
+        const std::uint64_t delays[] = {255, 256, 257, 65535, 65536, 70000, 16777216};
+        for (const auto delay : delays) {
+            wheel.Schedule(delay, 0, static_cast<std::uint32_t>(delay));
+        }
+        std::vector<std::uint64_t> firedAt;
+        bool onTime = true;
+        wheel.Advance(16777216, [&](TimerWheel::TimerId, std::uint32_t payload, bool) {
+            onTime = onTime && payload == static_cast<std::uint32_t>(wheel.Now());
+            firedAt.push_back(wheel.Now());
+        });
+        CHECK(onTime);
+        CHECK(firedAt.size() == std::size(delays));
+        CHECK(wheel.Size() == 0);
+    }
+
+    void TestCallbackReschedules() {
+        TimerWheel wheel;
+        const auto self = wheel.Schedule(2, 2, 1);
+        std::vector<std::pair<std::uint32_t, std::uint64_t>> fired;
+        wheel.Advance(10, [&](TimerWheel::TimerId id, std::uint32_t payload, bool repeating) {
+            fired.emplace_back(payload, wheel.Now());
+            if (payload != 1) {
+                return;
+            }
+            CHECK(repeating);
+            // Cancelling the timer that is firing stops it after this call
+            if (wheel.Now() == 4) {
+                CHECK(wheel.Cancel(id));
+            }
+            // A zero delay from a callback fires on the next tick, not this one
+            wheel.Schedule(0, 0, 2);
+        });
+        const std::vector<std::pair<std::uint32_t, std::uint64_t>> expected{{1, 2}, {2, 3}, {1, 4}, {2, 5}};
+        CHECK(fired == expected);
+        CHECK(!wheel.Cancel(self));
+        CHECK(wheel.Size() == 0);
+    }
+
+    // Random schedule, cancel and advance operations checked against a sorted map of due ticks
+    void TestAgainstModel() {
+        std::mt19937_64 random(1234);
+        TimerWheel wheel;
+        std::multimap<std::uint64_t, std::uint32_t> model;  // Due tick -> payload, one-shot timers only
+        std::vector<std::pair<TimerWheel::TimerId, std::uint64_t>> live;
+        std::uint32_t nextPayload = 0;
+        bool matches = true;
+
+        for (int op = 0; op < 20000; ++op) {
+            const auto choice = random() % 10;
+            if (choice < 5) {
+                const std::uint64_t delay = 1 + random() % (random() % 4 == 0 ? 300000 : 2000);
+                const auto payload = nextPayload++;
+                live.emplace_back(wheel.Schedule(delay, 0, payload), payload);
+                model.emplace(wheel.Now() + delay, payload);
+            } else if (choice < 7 && !live.empty()) {
+                const auto index = random() % live.size();
+                const auto [id, payload] = live[index];
+                live[index] = live.back();
+                live.pop_back();
+                const auto found = std::find_if(model.begin(), model.end(),
+                                                [payload](const auto& entry) { return entry.second == payload; });
+                // The timer may already have fired, in which case the wheel must reject the ID
+                CHECK(wheel.Cancel(id) == (found != model.end()));
+                if (found != model.end()) {
+                    model.erase(found);
+                }
+            } else {
+                const std::uint64_t ticks = random() % 64;
+                std::vector<std::uint32_t> fired;
+                wheel.Advance(ticks, [&](TimerWheel::TimerId, std::uint32_t payload, bool) { fired.push_back(payload); });
+
+                std::vector<std::uint32_t> due;
+                while (!model.empty() && model.begin()->first <= wheel.Now()) {
+                    due.push_back(model.begin()->second);
+                    model.erase(model.begin());
+                }
+                std::sort(fired.begin(), fired.end());
+                std::sort(due.begin(), due.end());
+                matches = matches && fired == due;
+            }
+            matches = matches && wheel.Size() == model.size();
+        }
+        CHECK(matches);
+    }
+
+    // Mean cost of one 16-tick frame with the given number of timers pending but not due
+    double MeasureIdleFrame(std::size_t pending) {
+        std::mt19937_64 random(99);
+        double best = 1e30;
+        for (int run = 0; run < 3; ++run) {
+            TimerWheel wheel;
+            for (std::size_t i = 0; i < pending; ++i) {
+                // Between about 17 minutes and 4.6 hours away, so none fires while measuring
+                wheel.Schedule((std::uint64_t{1} << 20) + random() % (std::uint64_t{1} << 24), 0,
+                               static_cast<std::uint32_t>(i));
+            }
+            std::size_t fired = 0;
+            const auto perFrame = Test::MeasureNanos(20000, [&] {
+                wheel.Advance(TicksPerFrame, [&](TimerWheel::TimerId, std::uint32_t, bool) { ++fired; });
+            });
+            CHECK(fired == 0);
+            best = std::min(best, perFrame);
+        }
+        return best;
+    }
+
+    void BenchmarkPendingTimers() {
+        const auto few = MeasureIdleFrame(10);
+        const auto many = MeasureIdleFrame(10000);
+        std::printf("Advance one frame: %.1f ns with 10 timers pending, %.1f ns with 10000\n", few, many);
+        // Pending timers are only touched when their slot comes up, so the frame cost must not grow with them
+        CHECK(many < few * 3.0 + 200.0);
+    }
+
+    // 10k timers with delays of up to a minute, each re-armed as it fires: the steady state of a busy script
+    void BenchmarkChurn() {
+        std::mt19937_64 random(7);
+        TimerWheel wheel;
+        for (std::uint32_t i = 0; i < 10000; ++i) {
+            wheel.Schedule(1 + random() % 60000, 0, i);
+        }
+        std::size_t fired = 0;
+        const auto perFrame = Test::MeasureNanos(60 * 60, [&] {
+            wheel.Advance(TicksPerFrame, [&](TimerWheel::TimerId, std::uint32_t payload, bool) {
+                ++fired;
+                wheel.Schedule(1 + random() % 60000, 0, payload);
+            });
+        });
+        std::printf("Advance one frame with 10000 timers re-armed as they fire: %.1f ns (%zu fired in 60 s)\n",
+                    perFrame, fired);
+        CHECK(wheel.Size() == 10000);
+    }
+}
+
+int main() {
+    TestOneShotAndRepeating();
+    TestCancel();
+    TestLongDelaysCascade();
+    TestCallbackReschedules();
+    TestAgainstModel();
+    BenchmarkPendingTimers();
+    BenchmarkChurn();
+    return Test::Report("TimerWheelTest");
+}
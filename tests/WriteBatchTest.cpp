@@ -0,0 +1,193 @@
+#include "Core/WriteBatch.h"
+
+#include "Check.h"
+
+#include <cstdio>
+#include <vector>
+
+using namespace Sample;
+
+namespace {
+    using Op = WriteBatch::Op;
+
+    // Stands in for the engine: records every write that reaches it
+    struct Engine {
+        std::vector<WriteBatch::Write> applied;
+        bool accept = true;
+
+        WriteBatch::Applier Applier() {
+            return [this](const WriteBatch::Write& write) {
+                applied.push_back(write);
+                return accept;
+            };
+        }
+    };
+
+    bool Is(const WriteBatch::Write& write, Op op, RE::FormID target, std::uint32_t key) {
+        return write.op == op && write.target == target && write.key == key;
+    }
+
+    std::uint32_t Key(RE::ActorValue av) { return static_cast<std::uint32_t>(av); }
+
+    RE::Actor lydia(0x000A2C94);
+    RE::Actor faendal(0x0001348A);
+    RE::TESForm sword(0x00012EB7);
+    RE::TESForm shield(0x00012EB6);
+    RE::TESWeather rain(0x000C8220);
+    RE::TESWeather clear(0x0012F89F);
+
+    void TestImmediate() {
+        Engine engine;
+        WriteBatch batch(engine.Applier());
+        CHECK(batch.SetActorValue(&lydia, RE::ActorValue::kHealth, 50.0f));
+        CHECK(batch.EquipItem(&lydia, &sword, false, true));
+        CHECK(engine.applied.size() == 2);
+        CHECK(batch.Size() == 0);
+
+        // A write the engine rejects is reported at once
+        engine.accept = false;
+        CHECK(!batch.UnequipItem(&lydia, &sword, true));
+        CHECK(batch.GetStats().issued == 3);
+        CHECK(batch.GetStats().applied == 2);
+    }
+
+    void TestLastWriterWins() {
+        Engine engine;
+        WriteBatch batch(engine.Applier());
+        batch.SetDeferred(true);
+        for (int i = 1; i <= 5; ++i) {
+            CHECK(batch.SetActorValue(&lydia, RE::ActorValue::kHealth, 10.0f * i));
+        }
+        batch.SetActorValue(&lydia, RE::ActorValue::kStamina, 7.0f);
+        batch.SetActorValue(&faendal, RE::ActorValue::kHealth, 3.0f);
+        batch.ForceWeather(&rain);
+        batch.ForceWeather(&clear);
+        CHECK(engine.applied.empty());
+        CHECK(batch.Size() == 4);
+
+        batch.Flush();
+        CHECK(engine.applied.size() == 4);
+        CHECK(Is(engine.applied[0], Op::kActorValue, lydia.GetFormID(), Key(RE::ActorValue::kHealth)));
+        CHECK(engine.applied[0].value == 50.0f);
+        CHECK(engine.applied[3].op == Op::kWeather && engine.applied[3].target == clear.GetFormID());
+
+        const auto& stats = batch.GetStats();
+        CHECK(stats.issued == 9 && stats.applied == 4 && stats.coalesced == 5 && stats.flushes == 1);
+        CHECK(batch.Size() == 0);
+    }
+
+    void TestEquipCancellation() {
+        Engine engine;
+        WriteBatch batch(engine.Applier());
+        batch.SetDeferred(true);
+
+        // Toggled gear costs nothing, in either order
+        batch.EquipItem(&lydia, &sword, false, true);
+        batch.UnequipItem(&lydia, &sword, true);
+        batch.UnequipItem(&faendal, &shield, true);
+        batch.EquipItem(&faendal, &shield, false, true);
+        CHECK(batch.Size() == 0);
+
+        // An odd number of toggles leaves the last one, and equips of different items stay apart
+        batch.EquipItem(&lydia, &sword, false, true);
+        batch.UnequipItem(&lydia, &sword, true);
+        batch.EquipItem(&lydia, &sword, true, false);
+        batch.EquipItem(&lydia, &shield, false, true);
+        batch.EquipItem(&lydia, &shield, false, false);
+        batch.Flush();
+
+        CHECK(engine.applied.size() == 2);
+        CHECK(Is(engine.applied[0], Op::kEquip, lydia.GetFormID(), sword.GetFormID()));
+        CHECK(engine.applied[0].preventRemoval && !engine.applied[0].silent);
+        CHECK(Is(engine.applied[1], Op::kEquip, lydia.GetFormID(), shield.GetFormID()));
+        CHECK(!engine.applied[1].silent);
+        CHECK(batch.GetStats().cancelled == 3);
+        CHECK(batch.GetStats().coalesced == 1);
+    }
+
+    void TestFlushOrder() {
+        Engine engine;
+        WriteBatch batch(engine.Applier());
+        batch.SetDeferred(true);
+
+        // Applied in the order each key was first written, whatever order the later writes came in
+        batch.SetActorValue(&lydia, RE::ActorValue::kHealth, 1.0f);
+        batch.EquipItem(&faendal, &sword, false, true);
+        batch.ForceWeather(&rain);
+        batch.SetActorValue(&faendal, RE::ActorValue::kMagicka, 2.0f);
+        batch.ForceWeather(&clear);
+        batch.SetActorValue(&lydia, RE::ActorValue::kHealth, 3.0f);
+
+        // A cancelled pair keeps its place without being applied; a key written again after it goes to the end
+        batch.UnequipItem(&faendal, &sword, true);
+        batch.UnequipItem(&faendal, &sword, true);
+
+        // Leaving deferred mode flushes
+        batch.SetDeferred(false);
+        CHECK(!batch.IsDeferred());
+        CHECK(engine.applied.size() == 4);
+        CHECK(Is(engine.applied[0], Op::kActorValue, lydia.GetFormID(), Key(RE::ActorValue::kHealth)));
+        CHECK(engine.applied[0].value == 3.0f);
+        CHECK(engine.applied[1].op == Op::kWeather && engine.applied[1].target == clear.GetFormID());
+        CHECK(Is(engine.applied[2], Op::kActorValue, faendal.GetFormID(), Key(RE::ActorValue::kMagicka)));
+        CHECK(Is(engine.applied[3], Op::kUnequip, faendal.GetFormID(), sword.GetFormID()));
+    }
+
+    void TestClearAndRejected() {
+        Engine engine;
+        WriteBatch batch(engine.Applier());
+        batch.SetDeferred(true);
+        batch.SetActorValue(&lydia, RE::ActorValue::kHealth, 1.0f);
+        batch.Clear();
+        batch.Flush();
+        CHECK(engine.applied.empty());
+        CHECK(batch.GetStats().flushes == 0);
+
+        // Recorded writes report success; a rejection at the flush only shows in the counters
+        engine.accept = false;
+        CHECK(batch.SetActorValue(&lydia, RE::ActorValue::kHealth, 1.0f));
+        batch.Flush();
+        CHECK(engine.applied.size() == 1);
+        CHECK(batch.GetStats().applied == 0);
+    }
+
+    // A combat script's frame: 64 actors, each getting five health writes and one toggled weapon
+    void BenchmarkFrame() {
+        constexpr std::size_t Actors = 64;
+        std::vector<RE::Actor> actors;
+        for (std::uint32_t i = 0; i < Actors; ++i) {
+            actors.emplace_back(0xFF000800 + i);
+        }
+
+        Engine engine;
+        WriteBatch batch(engine.Applier());
+        batch.SetDeferred(true);
+        const auto nanos = Test::MeasureNanos(2000, [&] {
+            for (auto& actor : actors) {
+                for (int i = 0; i < 5; ++i) {
+                    batch.SetActorValue(&actor, RE::ActorValue::kHealth, static_cast<float>(i));
+                }
+                batch.UnequipItem(&actor, &sword, true);
+                batch.EquipItem(&actor, &sword, false, true);
+            }
+            batch.Flush();
+            engine.applied.clear();
+        });
+
+        const auto& stats = batch.GetStats();
+        CHECK(stats.issued == 2000 * Actors * 7);
+        CHECK(stats.applied == 2000 * Actors);
+        std::printf("%zu actors, %zu writes per frame: %zu reach the engine, %.1f ns per write issued\n", Actors,
+                    Actors * 7, Actors, nanos / (Actors * 7));
+    }
+}
+
+int main() {
+    TestImmediate();
+    TestLastWriterWins();
+    TestEquipCancellation();
+    TestFlushOrder();
+    TestClearAndRejected();
+    BenchmarkFrame();
+    return Test::Report("WriteBatchTest");
+}
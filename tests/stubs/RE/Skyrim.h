@@ -0,0 +1,378 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+// Stand-in for the few CommonLibSSE declarations the host-tested units use. Enumerator values follow the game's.
+namespace RE {
+    using FormID = std::uint32_t;
+
+    /**
+     * Forms are looked up in <code>AllForms</code>, which tests fill with the forms they create.
+     */
+    class TESForm {
+    public:
+        explicit TESForm(FormID formID) noexcept : _formID(formID) {}
+        virtual ~TESForm() = default;
+
+        [[nodiscard]] FormID GetFormID() const noexcept { return _formID; }
+
+        template <class T>
+        [[nodiscard]] T* As() noexcept {
+            return dynamic_cast<T*>(this);
+        }
+
+        template <class T>
+        [[nodiscard]] const T* As() const noexcept {
+            return dynamic_cast<const T*>(this);
+        }
+
+        static TESForm* LookupByID(FormID formID) {
+            const auto found = AllForms().find(formID);
+            return found != AllForms().end() ? found->second : nullptr;
+        }
+
+        template <class T>
+        static T* LookupByID(FormID formID) {
+            auto* form = LookupByID(formID);
+            return form ? form->As<T>() : nullptr;
+        }
+
+        static std::unordered_map<FormID, TESForm*>& AllForms() {
+            static std::unordered_map<FormID, TESForm*> forms;
+            return forms;
+        }
+
+    private:
+        FormID _formID;
+    };
+
+    struct NiPoint3 {
+        float x = 0.0f;
+        float y = 0.0f;
+        float z = 0.0f;
+
+        [[nodiscard]] float GetDistance(const NiPoint3& other) const noexcept {
+            const float dx = x - other.x;
+            const float dy = y - other.y;
+            const float dz = z - other.z;
+            return std::sqrt(dx * dx + dy * dy + dz * dz);
+        }
+    };
+
+    class TESBoundObject : public TESForm {
+    public:
+        using TESForm::TESForm;
+    };
+
+    class TESWorldSpace : public TESForm {
+    public:
+        using TESForm::TESForm;
+    };
+
+    class TESObjectCELL : public TESForm {
+    public:
+        using TESForm::TESForm;
+    };
+
+    /**
+     * A placed reference. Tests set its fields directly; a reference with no worldspace is in the interior
+     * <code>parentCell</code>.
+     */
+    class TESObjectREFR : public TESForm {
+    public:
+        explicit TESObjectREFR(FormID formID) noexcept : TESForm(formID) {}
+
+        [[nodiscard]] TESBoundObject* GetBaseObject() const noexcept { return base; }
+        [[nodiscard]] TESWorldSpace* GetWorldspace() const noexcept { return worldspace; }
+        [[nodiscard]] TESObjectCELL* GetParentCell() const noexcept { return parentCell; }
+        [[nodiscard]] NiPoint3 GetPosition() const noexcept { return position; }
+        [[nodiscard]] bool IsDisabled() const noexcept { return disabled; }
+
+        TESBoundObject* base = nullptr;
+        TESWorldSpace* worldspace = nullptr;
+        TESObjectCELL* parentCell = nullptr;
+        NiPoint3 position;
+        bool disabled = false;
+    };
+
+    class Actor : public TESObjectREFR {
+    public:
+        explicit Actor(FormID formID) noexcept : TESObjectREFR(formID) {}
+    };
+
+    class TESWeather : public TESForm {
+    public:
+        using TESForm::TESForm;
+    };
+
+    namespace BSContainer {
+        enum class ForEachResult { kContinue, kStop };
+    }
+
+    /**
+     * Walks <code>references</code>, which tests fill with the references in the "loaded cells".
+     */
+    class TES {
+    public:
+        static TES* GetSingleton() {
+            static TES tes;
+            return &tes;
+        }
+
+        template <class F>
+        void ForEachReference(F&& callback) {
+            for (auto* ref : references) {
+                if (callback(*ref) == BSContainer::ForEachResult::kStop) {
+                    return;
+                }
+            }
+        }
+
+        std::vector<TESObjectREFR*> references;
+    };
+
+    template <class T>
+    class NiPointer {
+    public:
+        NiPointer(T* pointer = nullptr) noexcept : _pointer(pointer) {}
+
+        [[nodiscard]] T* get() const noexcept { return _pointer; }
+        T* operator->() const noexcept { return _pointer; }
+        explicit operator bool() const noexcept { return _pointer != nullptr; }
+
+    private:
+        T* _pointer;
+    };
+
+    enum class BSEventNotifyControl { kContinue, kStop };
+
+    template <class Event>
+    class BSTEventSource;
+
+    template <class Event>
+    class BSTEventSink {
+    public:
+        virtual ~BSTEventSink() = default;
+        virtual BSEventNotifyControl ProcessEvent(const Event* event, BSTEventSource<Event>* source) = 0;
+    };
+
+    /**
+     * Delivers events to its sinks synchronously, when tests call <code>SendEvent</code>.
+     */
+    template <class Event>
+    class BSTEventSource {
+    public:
+        void AddEventSink(BSTEventSink<Event>* sink) { _sinks.push_back(sink); }
+
+        void SendEvent(const Event* event) {
+            for (auto* sink : _sinks) {
+                if (sink->ProcessEvent(event, this) == BSEventNotifyControl::kStop) {
+                    return;
+                }
+            }
+        }
+
+    private:
+        std::vector<BSTEventSink<Event>*> _sinks;
+    };
+
+    struct TESCellAttachDetachEvent {
+        NiPointer<TESObjectREFR> reference;
+        bool attached = false;
+    };
+
+    struct TESObjectLoadedEvent {
+        FormID formID = 0;
+        bool loaded = false;
+    };
+
+    struct TESMoveAttachDetachEvent {
+        NiPointer<TESObjectREFR> movedRef;
+        bool isCellAttached = false;
+    };
+
+    struct TESFormDeleteEvent {
+        FormID formID = 0;
+    };
+
+    class ScriptEventSourceHolder : public BSTEventSource<TESCellAttachDetachEvent>,
+                                    public BSTEventSource<TESObjectLoadedEvent>,
+                                    public BSTEventSource<TESMoveAttachDetachEvent>,
+                                    public BSTEventSource<TESFormDeleteEvent> {
+    public:
+        static ScriptEventSourceHolder* GetSingleton() {
+            static ScriptEventSourceHolder holder;
+            return &holder;
+        }
+
+        template <class Event>
+        void AddEventSink(BSTEventSink<Event>* sink) {
+            BSTEventSource<Event>::AddEventSink(sink);
+        }
+
+        template <class Event>
+        void SendEvent(const Event* event) {
+            BSTEventSource<Event>::SendEvent(event);
+        }
+    };
+
+    /**
+     * Strings interned in a pool that ignores case: every casing of a string shares the entry, and so the address and
+     * casing, of whichever was interned first.
+     */
+    class BSFixedString {
+    public:
+        BSFixedString() = default;
+        BSFixedString(const char* value) : _data(Intern(value)) {}
+
+        [[nodiscard]] const char* data() const noexcept { return _data; }
+        [[nodiscard]] const char* c_str() const noexcept { return _data; }
+
+    private:
+        static const char* Intern(std::string_view value) {
+            static std::unordered_map<std::string, std::string> pool;
+            std::string key(value);
+            for (auto& c : key) {
+                c = c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+            }
+            return pool.try_emplace(std::move(key), value).first->second.c_str();
+        }
+
+        const char* _data = "";
+    };
+
+    enum class ActorValue : std::uint32_t {
+        kNone = static_cast<std::uint32_t>(-1),
+        kAggression = 0,
+        kConfidence = 1,
+        kEnergy = 2,
+        kMorality = 3,
+        kMood = 4,
+        kAssistance = 5,
+        kOneHanded = 6,
+        kTwoHanded = 7,
+        kArchery = 8,
+        kBlock = 9,
+        kSmithing = 10,
+        kHeavyArmor = 11,
+        kLightArmor = 12,
+        kPickpocket = 13,
+        kLockpicking = 14,
+        kSneak = 15,
+        kAlchemy = 16,
+        kSpeech = 17,
+        kAlteration = 18,
+        kConjuration = 19,
+        kDestruction = 20,
+        kIllusion = 21,
+        kRestoration = 22,
+        kEnchanting = 23,
+        kHealth = 24,
+        kMagicka = 25,
+        kStamina = 26,
+        kHealRate = 27,
+        kMagickaRate = 28,
+        kStaminaRate = 29,
+        kSpeedMult = 30,
+        kInventoryWeight = 31,
+        kCarryWeight = 32,
+        kCriticalChance = 33,
+        kMeleeDamage = 34,
+        kUnarmedDamage = 35,
+        kMass = 36,
+        kVoicePoints = 37,
+        kVoiceRate = 38,
+        kDamageResist = 39,
+        kPoisonResist = 40,
+        kResistFire = 41,
+        kResistShock = 42,
+        kResistFrost = 43,
+        kResistMagic = 44,
+        kResistDisease = 45,
+        kParalysis = 54,
+        kInvisibility = 55,
+        kNightEye = 56,
+        kTotal = 164
+    };
+
+    /**
+     * Resolves names the way the game does: a case-insensitive comparison against every actor value in turn. Values
+     * without an enumerator above get placeholder names, so a miss costs the same full scan as in game.
+     */
+    class ActorValueList {
+    public:
+        static ActorValueList* GetSingleton() {
+            static ActorValueList list;
+            return &list;
+        }
+
+        ActorValue LookupActorValueByName(std::string_view name) const {
+            for (std::size_t i = 0; i < std::size(_names); ++i) {
+                if (EqualsIgnoreCase(_names[i], name)) {
+                    return static_cast<ActorValue>(i);
+                }
+            }
+            return ActorValue::kNone;
+        }
+
+    private:
+        ActorValueList() {
+            constexpr std::pair<const char*, ActorValue> known[] = {
+                {"Aggression", ActorValue::kAggression},       {"Confidence", ActorValue::kConfidence},
+                {"Energy", ActorValue::kEnergy},               {"Morality", ActorValue::kMorality},
+                {"Mood", ActorValue::kMood},                   {"Assistance", ActorValue::kAssistance},
+                {"OneHanded", ActorValue::kOneHanded},         {"TwoHanded", ActorValue::kTwoHanded},
+                {"Marksman", ActorValue::kArchery},            {"Block", ActorValue::kBlock},
+                {"Smithing", ActorValue::kSmithing},           {"HeavyArmor", ActorValue::kHeavyArmor},
+                {"LightArmor", ActorValue::kLightArmor},       {"Pickpocket", ActorValue::kPickpocket},
+                {"Lockpicking", ActorValue::kLockpicking},     {"Sneak", ActorValue::kSneak},
+                {"Alchemy", ActorValue::kAlchemy},             {"Speechcraft", ActorValue::kSpeech},
+                {"Alteration", ActorValue::kAlteration},       {"Conjuration", ActorValue::kConjuration},
+                {"Destruction", ActorValue::kDestruction},     {"Illusion", ActorValue::kIllusion},
+                {"Restoration", ActorValue::kRestoration},     {"Enchanting", ActorValue::kEnchanting},
+                {"Health", ActorValue::kHealth},               {"Magicka", ActorValue::kMagicka},
+                {"Stamina", ActorValue::kStamina},             {"HealRate", ActorValue::kHealRate},
+                {"MagickaRate", ActorValue::kMagickaRate},     {"StaminaRate", ActorValue::kStaminaRate},
+                {"SpeedMult", ActorValue::kSpeedMult},         {"InventoryWeight", ActorValue::kInventoryWeight},
+                {"CarryWeight", ActorValue::kCarryWeight},     {"CritChance", ActorValue::kCriticalChance},
+                {"MeleeDamage", ActorValue::kMeleeDamage},     {"UnarmedDamage", ActorValue::kUnarmedDamage},
+                {"Mass", ActorValue::kMass},                   {"VoicePoints", ActorValue::kVoicePoints},
+                {"VoiceRate", ActorValue::kVoiceRate},         {"DamageResist", ActorValue::kDamageResist},
+                {"PoisonResist", ActorValue::kPoisonResist},   {"FireResist", ActorValue::kResistFire},
+                {"ElectricResist", ActorValue::kResistShock},  {"FrostResist", ActorValue::kResistFrost},
+                {"MagicResist", ActorValue::kResistMagic},     {"DiseaseResist", ActorValue::kResistDisease},
+                {"Paralysis", ActorValue::kParalysis},         {"Invisibility", ActorValue::kInvisibility},
+                {"NightEye", ActorValue::kNightEye},
+            };
+            for (std::size_t i = 0; i < std::size(_names); ++i) {
+                _names[i] = "ActorValue" + std::to_string(i);
+            }
+            for (const auto& [name, value] : known) {
+                _names[static_cast<std::size_t>(value)] = name;
+            }
+        }
+
+        static bool EqualsIgnoreCase(std::string_view left, std::string_view right) noexcept {
+            if (left.size() != right.size()) {
+                return false;
+            }
+            for (std::size_t i = 0; i < left.size(); ++i) {
+                const auto lower = [](char c) { return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c; };
+                if (lower(left[i]) != lower(right[i])) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        std::string _names[static_cast<std::size_t>(ActorValue::kTotal)];
+    };
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+// Stand-in for the SKSE logging API, so units that only log can be built into the host tests. Messages are dropped.
+namespace SKSE::log {
+    template <class... Args>
+    void trace(Args&&...) noexcept {}
+
+    template <class... Args>
+    void debug(Args&&...) noexcept {}
+
+    template <class... Args>
+    void info(Args&&...) noexcept {}
+
+    template <class... Args>
+    void warn(Args&&...) noexcept {}
+
+    template <class... Args>
+    void error(Args&&...) noexcept {}
+
+    template <class... Args>
+    void critical(Args&&...) noexcept {}
+}